@@ -7,6 +7,8 @@
 #include "include/font_6x3.h"
 #include "include/compositor.h"
 #include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 
 
 #define C_SM 0xFFFFFFFF
@@ -26,14 +28,38 @@ bool enabled = true;
 
 Color background;
 Color *buffer;
-renderTask_t *head = NULL;
+
+//The render list, in drawing order
+static renderTask_t *tasks = NULL;
+static int taskCount = 0;
+static int taskCapacity = 0;
+
+//Background with the static tasks at the start of the list drawn on it, as they only have to be
+//drawn once. baseTasks is the amount of tasks in it, -1 when it has to be drawn again.
+static Color *base = NULL;
+static int baseTasks = -1;
+//Whether the image has to be composited again when nothing in it moves
+static bool dirty = true;
+
+//Where compositor_setPixel draws: the framebuffer, the base image or the layer of a text, which
+//covers LAYER_ROWS rows starting at targetY
+#define LAYER_ROWS 8
+static Color *target;
+static int targetY = 0;
+static bool targetLayer = false;
+
+static SemaphoreHandle_t lock = NULL;
+#define LOCK() if (lock) xSemaphoreTake(lock, portMAX_DELAY)
+#define UNLOCK() if (lock) xSemaphoreGive(lock)
+
+#define FRAME_PIXELS (CONFIG_HUB75_WIDTH*CONFIG_HUB75_HEIGHT)
 
 #define N_FONTS 2
 int font_index = 0;
 void (*font_render_char[])(uint8_t charId, Color color, int *x, int y, int endX, int *skip) = {&renderChar_7x5, &renderChar_6x3};
 int (*font_char_width[])(uint8_t charId) = {&getCharWidth_7x5, &getCharWidth_6x3};
 
-void addTask(renderTask_t *node);
+static void addTask(renderTask_t *node);
 void renderImage(uint8_t *image, int x, int y, int sizeX, int sizeY);
 void renderCharCol(uint8_t ch, Color color, int x, int y);
 void renderText(char *text, Color color, int x, int y, int sizeX, int skip, bool firstshow);
@@ -50,63 +76,80 @@ Color genColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
 
 void compositor_init() {
         background.value = 0;
+        if (!lock) lock = xSemaphoreCreateMutex();
+}
+
+static void freeLayers() {
+	for(int i = 0; i < taskCount; i++) {
+		free(tasks[i].layer);
+		tasks[i].layer = NULL;
+	}
+	baseTasks = -1;
+	dirty = true;
 }
 
 /*
 Clears the render list. Keeps the background
  */
 void compositor_clear() {
-        renderTask_t *node = head;
-        renderTask_t *next;
-        while(node != NULL) {
-                next = node->next;
-                if(node->id == 0) {
-                        free(node->payload);
-                } else if(node->id == 1) {
-                        free(node->payload);
-                } else if(node->id == 2) {
-                        scrollText_t *t = (scrollText_t *) node->payload;
-                        free(t->text);
-                        free(node->payload);
-                } else if(node->id == 3) {
-                        animation_t *gif = (animation_t *) node->payload;
-                        free(gif->gif);
-                        free(node->payload);
-                }
-                free(node);
-                node = next;
-        }
-        head = NULL;
+	LOCK();
+	freeLayers();
+	for(int i = 0; i < taskCount; i++) {
+		renderTask_t *node = &tasks[i];
+		if(node->id == 2) {
+			scrollText_t *t = (scrollText_t *) node->payload;
+			free(t->text);
+		} else if(node->id == 3) {
+			animation_t *gif = (animation_t *) node->payload;
+			free(gif->gif);
+		}
+		free(node->payload);
+	}
+	taskCount = 0;
+	UNLOCK();
 }
 
 /*
 * Sets the background color of the display.
 */
 void compositor_setBackground(Color color) {
-        background = color;
+	LOCK();
+	background = color;
+	baseTasks = -1;
+	dirty = true;
+	UNLOCK();
 }
 
-void addTask(renderTask_t *node) {
-        if(head == NULL) {
-                head = node;
-        } else {
-                renderTask_t *pos = head;
-                while(pos->next != NULL) pos = pos->next;
-                pos->next = node;
-        }
+//Appends a copy of the task to the render list
+static void addTask(renderTask_t *node) {
+	LOCK();
+	if(taskCount == taskCapacity) {
+		int capacity = taskCapacity ? taskCapacity * 2 : 8;
+		renderTask_t *grown = realloc(tasks, capacity * sizeof(renderTask_t));
+		if(!grown) {
+			UNLOCK();
+			ESP_LOGE("compositor", "Out of memory, task not added");
+			return;
+		}
+		tasks = grown;
+		taskCapacity = capacity;
+	}
+	node->layer = NULL;
+	tasks[taskCount++] = *node;
+	dirty = true;
+	UNLOCK();
 }
 
 void compositor_addText(char *text, Color color, int x, int y) {
         char *text_store = malloc(strlen(text)+1);
         strcpy(text_store, text);
-        renderTask_t *node = (renderTask_t *) malloc(sizeof(renderTask_t));
-        node->payload = text_store;
-        node->color = color;
-        node->x = x;
-        node->y = y;
-        node->next = NULL;
-        node->id = 0;
-        addTask(node);
+        renderTask_t node = {0};
+        node.payload = text_store;
+        node.color = color;
+        node.x = x;
+        node.y = y;
+        node.id = 0;
+        addTask(&node);
 }
 
 /*
@@ -125,15 +168,14 @@ void compositor_addScrollText(char *text, Color color, int x, int y, int sizeX)
 	scroll->speed = 1;
 	scroll->skip = -10;
 	scroll->firstshow = true;
-	renderTask_t *node = (renderTask_t *) malloc(sizeof(renderTask_t));
-	node->payload = scroll;
-	node->id = 2;
-	node->x = x;
-	node->y = y;
-	node->sizeX = sizeX;
-	node->color = color;
-	node->next = NULL;
-	addTask(node);
+	renderTask_t node = {0};
+	node.payload = scroll;
+	node.id = 2;
+	node.x = x;
+	node.y = y;
+	node.sizeX = sizeX;
+	node.color = color;
+	addTask(&node);
 }
 
 /*
@@ -144,15 +186,14 @@ void compositor_addScrollText(char *text, Color color, int x, int y, int sizeX)
 * width, length is width and length of the image
 */
 void compositor_addImage(uint8_t *image, int x, int y, int width, int length) {
-	renderTask_t *node = (renderTask_t *) malloc(sizeof(renderTask_t));
-	node->payload = image;
-	node->x = x;
-	node->y = y;
-	node->sizeX = width;
-	node->sizeY = length;
-	node->next = NULL;
-	node->id = 1;
-	addTask(node);
+	renderTask_t node = {0};
+	node.payload = image;
+	node.x = x;
+	node.y = y;
+	node.sizeX = width;
+	node.sizeY = length;
+	node.id = 1;
+	addTask(&node);
 }
 
 /*
@@ -168,23 +209,34 @@ void compositor_addAnimation(uint8_t *image, int x, int y, int width, int length
 	gif->gif = image;
 	gif->showFrame = 0;
 	gif->numberFrames = numFrames;
-	renderTask_t *node = (renderTask_t *) malloc(sizeof(renderTask_t));
-	node->payload = gif;
-	node->x = x;
-	node->y = y;
-	node->sizeX = width;
-	node->sizeY = length;
-	node->next = NULL;
-	node->id = 3;
-	addTask(node);
+	renderTask_t node = {0};
+	node.payload = gif;
+	node.x = x;
+	node.y = y;
+	node.sizeX = width;
+	node.sizeY = length;
+	node.id = 3;
+	addTask(&node);
+}
+
+//Draws a color with premultiplied alpha over a pixel
+static inline void blend(Color *dst, Color color) {
+	int inv = 256-color.RGB[0];
+	dst->RGB[1] = color.RGB[1] + ((dst->RGB[1]*inv)>>8);
+	dst->RGB[2] = color.RGB[2] + ((dst->RGB[2]*inv)>>8);
+	dst->RGB[3] = color.RGB[3] + ((dst->RGB[3]*inv)>>8);
 }
 
 void compositor_setPixel(int x, int y, Color color) {
-	if (!buffer) return;
-	Color *target = &buffer[y*CONFIG_HUB75_WIDTH+x];
-	target->RGB[1] = color.RGB[1] + (255-color.RGB[0])*target->RGB[1]/255;
-	target->RGB[2] = color.RGB[2] + (255-color.RGB[0])*target->RGB[2]/255;
-	target->RGB[3] = color.RGB[3] + (255-color.RGB[0])*target->RGB[3]/255;
+	if (!target) return;
+	if (targetLayer) {
+		//Text does not overlap itself, so the layer just keeps the color and its alpha
+		y -= targetY;
+		if (y < 0 || y >= LAYER_ROWS) return;
+		target[y*CONFIG_HUB75_WIDTH+x] = color;
+		return;
+	}
+	blend(&target[y*CONFIG_HUB75_WIDTH+x], color);
 }
 
 void renderImage(uint8_t *image, int x, int y, int sizeX, int sizeY) {
@@ -194,7 +246,8 @@ void renderImage(uint8_t *image, int x, int y, int sizeX, int sizeY) {
 		for(int px=0; px<sizeX; px++) {
 			xreal = x + px;
 			if(yreal >= 0 && yreal < CONFIG_HUB75_HEIGHT && xreal >= 0 && xreal < CONFIG_HUB75_WIDTH) {
-				compositor_setPixel(xreal, yreal, *((Color *)&image[(py*sizeX+px)*4]));
+				Color c = *((Color *)&image[(py*sizeX+px)*4]);
+				if (c.value) blend(&target[yreal*CONFIG_HUB75_WIDTH+xreal], c);
 			}
 		}
 	}
@@ -235,7 +288,10 @@ unsigned int compositor_getTextWidth(char *text) {
 
 void compositor_setFont(int index) {
 	if(index < 0 || index >= N_FONTS) return;
+	LOCK();
 	font_index = index;
+	freeLayers();
+	UNLOCK();
 }
 
 
@@ -246,55 +302,113 @@ void display_crash() {
 	blue.value = 0x1070AA00;
 	Color white;
 	white.value = 0xFFFFFFFF;
-	for(int x=0; x<CONFIG_HUB75_WIDTH; x++) {
-		for(int y=0; y<CONFIG_HUB75_HEIGHT; y++) {
-			buffer[y*CONFIG_HUB75_WIDTH+x] = blue;
-		}
-	}
+	target = buffer;
+	targetLayer = false;
+	for(int i=0; i<FRAME_PIXELS; i++) buffer[i] = blue;
 	renderImage((uint8_t *) smiley, 24, 0, 8, 8);   
 	renderText("FML", white, 0, 0, -1, 0, false);     
 }
 
+static bool isStatic(renderTask_t *node) {
+	return node->id == 0 || node->id == 1;
+}
+
+//Draws text into a layer of its own, so that it can be copied instead of drawn next time
+static void renderLayer(renderTask_t *node) {
+	node->layer = calloc(LAYER_ROWS*CONFIG_HUB75_WIDTH, sizeof(Color));
+	if (!node->layer) return;
+	Color *frame = target;
+	target = node->layer;
+	targetY = node->y;
+	targetLayer = true;
+	renderText((char *)node->payload, node->color, node->x, node->y, -1, 0, false);
+	target = frame;
+	targetLayer = false;
+}
+
+static void renderTask(renderTask_t *node, bool useLayer) {
+	if(node->id == 0) { //Render text
+		if (useLayer && !node->layer) renderLayer(node);
+		if (!useLayer || !node->layer) {
+			renderText((char *)node->payload, node->color, node->x, node->y, -1, 0, false);
+			return;
+		}
+		for(int row=0; row<LAYER_ROWS; row++) {
+			int y = node->y + row;
+			if (y < 0 || y >= CONFIG_HUB75_HEIGHT) continue;
+			Color *src = &node->layer[row*CONFIG_HUB75_WIDTH];
+			Color *dst = &target[y*CONFIG_HUB75_WIDTH];
+			for(int x=0; x<CONFIG_HUB75_WIDTH; x++) {
+				if (src[x].value) blend(&dst[x], src[x]);
+			}
+		}
+	} else if(node->id == 1) {  //Render image
+		renderImage((uint8_t *)node->payload, node->x, node->y, node->sizeX, node->sizeY);
+	} else if(node->id == 2) {  //Render scrolling text
+		scrollText_t *scroll = (scrollText_t *) node->payload;
+		renderText(scroll->text, node->color, node->x, node->y, node->sizeX, scroll->skip, scroll->firstshow);
+		scroll->skip++;
+		if(scroll->skip == strlen(scroll->text)*6+6) 
+		{
+			scroll->skip = -node->sizeX;
+			scroll->firstshow = false;
+		}
+	} else if(node->id == 3) {//Render animation
+		animation_t *gif = (animation_t *) node->payload;
+		int index = node->sizeX*node->sizeY*4*gif->showFrame;
+		renderImage(&(gif->gif[index]), node->x, node->y, node->sizeX, node->sizeY);
+		gif->showFrame++;
+		if(gif->showFrame == gif->numberFrames) gif->showFrame = 0;
+	}
+}
+
+//Draws the background and the static tasks at the start of the list
+static void renderBase(Color *frame, int count) {
+	target = frame;
+	for(int i=0; i<FRAME_PIXELS; i++) frame[i] = background;
+	for(int i=0; i<count; i++) renderTask(&tasks[i], false);
+}
+
 void composite() {
 	if (!buffer) return;
-	//Setting the background color
-	for(int x=0; x<CONFIG_HUB75_WIDTH; x++) {
-			for(int y=0; y<CONFIG_HUB75_HEIGHT; y++) {
-					buffer[y*CONFIG_HUB75_WIDTH+x] = background;
-			}
+	LOCK();
+	int prefix = 0;
+	while(prefix < taskCount && isStatic(&tasks[prefix])) prefix++;
+	//Nothing changed and nothing moves, the framebuffer still holds the image
+	if (!dirty && prefix == taskCount) {
+		UNLOCK();
+		return;
 	}
-	renderTask_t *node = head;
-	while(node != NULL) {
-		if(node->id == 0) { //Render text
-			renderText((char *)node->payload, node->color, node->x, node->y, -1, 0, false);
-		} else if(node->id == 1) {  //Render image
-			renderImage((uint8_t *)node->payload, node->x, node->y, node->sizeX, node->sizeY);
-		} else if(node->id == 2) {  //Render scrolling text
-			scrollText_t *scroll = (scrollText_t *) node->payload;
-			renderText(scroll->text, node->color, node->x, node->y, node->sizeX, scroll->skip, scroll->firstshow);
-			scroll->skip++;
-			if(scroll->skip == strlen(scroll->text)*6+6) 
-			{
-				scroll->skip = -node->sizeX;
-				scroll->firstshow = false;
-			}
-		} else if(node->id == 3) {//Render animation
-			animation_t *gif = (animation_t *) node->payload;
-			int index = node->sizeX*node->sizeY*4*gif->showFrame;
-			renderImage(&(gif->gif[index]), node->x, node->y, node->sizeX, node->sizeY);
-			gif->showFrame++;
-			if(gif->showFrame == gif->numberFrames) gif->showFrame = 0;
+
+	if (!base) base = malloc(FRAME_PIXELS*sizeof(Color));
+	if (base) {
+		if (baseTasks != prefix) {
+			renderBase(base, prefix);
+			baseTasks = prefix;
 		}
-		node = node->next;
+		memcpy(buffer, base, FRAME_PIXELS*sizeof(Color));
+	} else {
+		renderBase(buffer, prefix);
 	}
+
+	target = buffer;
+	for(int i=prefix; i<taskCount; i++) renderTask(&tasks[i], true);
+	dirty = false;
+	UNLOCK();
 }
 
 void compositor_setBuffer(Color* framebuffer) {
+	LOCK();
 	buffer = framebuffer;
+	dirty = true;
+	UNLOCK();
 }
 
 void compositor_enable() {
+	LOCK();
 	enabled = true;
+	dirty = true; //The framebuffer may have been drawn on in the meantime
+	UNLOCK();
 }
 
 void compositor_disable() {
@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "esp_heap_caps.h"
@@ -26,11 +27,48 @@
 //This is the bit depth, per RGB subpixel, of the data that is sent to the display.
 //The effective bit depth (in computer pixel terms) is less because of the PWM correction. With
 //a bitplane count of 7, you should be able to reproduce an 16-bit image more or less faithfully, though.
-//Currently set to 6 to improve scrolling text.
+//Defaults to 6 to improve scrolling text. At most 8, as that is the resolution of the PWM table.
+#ifdef CONFIG_HUB75_BITPLANES
+#define BITPLANE_CNT CONFIG_HUB75_BITPLANES
+#else
 #define BITPLANE_CNT 6
+#endif
+
+//Rows that are addressed by the row select lines: a 1/8, 1/16 or 1/32 scan panel
+#if defined(CONFIG_HUB75_SCAN_32)
+#define SCAN_ROWS 32
+#elif defined(CONFIG_HUB75_SCAN_16)
+#define SCAN_ROWS 16
+#else
+#define SCAN_ROWS 8
+#endif
 
-//64*32 RGB leds, 2 pixels per 16-bit value...
-#define BITPLANE_SZ (8*32)
+//Panels taller than the scan take the lower half of the image in over a second set of RGB lines
+#define HALVES (CONFIG_HUB75_HEIGHT/SCAN_ROWS)
+#if HALVES < 1 || HALVES > 2 || CONFIG_HUB75_HEIGHT % SCAN_ROWS
+#error "HUB75 height must be once or twice the amount of scanned rows"
+#endif
+
+//Pixels shifted out per row, which is the width of all chained panels together
+#define ROW_SZ CONFIG_HUB75_WIDTH
+
+//The second RGB half and the D and E row select lines only fit in a 16-bit bus.
+//FIFO_SWAP corrects for the DMA sending the 16-bit halves of every 32-bit word in swapped order.
+#if HALVES == 2 || SCAN_ROWS > 8
+typedef uint16_t hub75_word_t;
+#define BUS_BITS I2S_PARALLEL_BITS_16
+#define FIFO_SWAP 1
+#else
+typedef uint8_t hub75_word_t;
+#define BUS_BITS I2S_PARALLEL_BITS_8
+#define FIFO_SWAP 2
+#endif
+#if ROW_SZ % (2*FIFO_SWAP)
+#error "HUB75 width does not fill whole 32-bit DMA words"
+#endif
+
+#define BITPLANE_SZ (SCAN_ROWS*ROW_SZ*sizeof(hub75_word_t))
+#define ALL_ROWS ((uint32_t)((1ULL<<SCAN_ROWS)-1))
 
 //Upper half RGB
 #define BIT_R1 (1<<0)   //connected to GPIO2 here
@@ -44,56 +82,139 @@
 #define BIT_LAT (1<<6) //connected to GPIO26 here
 #define BIT_OE (1<<7)  //connected to GPIO25 here
 
+//Lower half RGB and extra row select lines, 16-bit bus only
+#define BIT_R2 (1<<8)
+#define BIT_G2 (1<<9)
+#define BIT_B2 (1<<10)
+#define BIT_D (1<<11)
+#define BIT_E (1<<12)
+
+static const int rowSelectBits[5]={BIT_A, BIT_B, BIT_C, BIT_D, BIT_E};
+
 int brightness=CONFIG_HUB75_DEFAULT_BRIGHTNESS;
 int framerate=20;
 Color *hub75_framebuffer = NULL;
 
 bool driver_hub75_active;
 i2s_parallel_buffer_desc_t bufdesc[2][1<<BITPLANE_CNT];
-uint8_t *bitplane[2][BITPLANE_CNT];
+hub75_word_t *bitplane[2][BITPLANE_CNT];
 int backbuf_id=0; //which buffer is the backbuffer, as in, which one is not active so we can write to it
+
+//Bits of all planes for an 8-bit subpixel value: byte n holds the bit for plane n in bit 0
+static uint64_t planeLut[256];
+//Latch and output enable bits of every word in a row for the current brightness, and the line
+//select bits of every row
+static hub75_word_t ctrlWords[ROW_SZ];
+static hub75_word_t lineBits[SCAN_ROWS];
+static int ctrlBrightness=-1;
+//The image the bitplanes were last rendered from, and the scanned rows of each buffer that show it
+static Color *shownFrame;
+static bool shownBlank=false;
+static uint32_t rowsValid[2];
+
 #define min(a,b) ((a)<(b)?(a):(b))
 #define max(a,b) ((a)>(b)?(a):(b))
 #ifndef NULL
         #define NULL 0
 #endif
 
+static void buildPlaneLut()
+{
+	for (int val=0; val<256; val++) {
+		int pwm=valToPwm(val);
+		uint64_t bits=0;
+		for (int plane=0; plane<BITPLANE_CNT; plane++) {
+			if (pwm&(1<<(8-BITPLANE_CNT+plane))) bits|=(uint64_t)1<<(plane*8);
+		}
+		planeLut[val]=bits;
+	}
+}
+
+static void buildControlWords()
+{
+	int bright=brightness; //May be changed by another task while we are busy
+	for (unsigned int y=0; y<SCAN_ROWS; y++) {
+		int lbits=0;         //Line bits of the *previous* line, which is the one we're displaying now
+		for (int i=0; (1<<i)<SCAN_ROWS; i++) {
+			if ((y-1)&(1<<i)) lbits|=rowSelectBits[i];
+		}
+		lineBits[y]=lbits;
+	}
+	for (int fx=0; fx<ROW_SZ; fx++) {
+		int x = fx^FIFO_SWAP;   //Apply correction. this fixes dma byte stream order
+		int v = 0;
+		//Do not show image while the line bits are changing
+		//Don't display for the first cycle to remove line bleed
+		//Brightness is in 32ths of the row, whatever the width of the panel
+		if (x<1 || x>=bright*ROW_SZ/32) v|= BIT_OE;
+		if (x==ROW_SZ-1) v|= BIT_LAT;         //latch on last bit...
+		ctrlWords[fx]=v;
+	}
+	ctrlBrightness=bright;
+}
+
+static inline uint64_t pixelBits(Color c)
+{
+	return planeLut[c.RGB[3]] | (planeLut[c.RGB[2]]<<1) | (planeLut[c.RGB[1]]<<2);
+}
+
+//Encodes one scanned row of the image into all bitplanes of the back buffer
+static void renderRow(int y)
+{
+	hub75_word_t *p[BITPLANE_CNT];
+	for (int plane=0; plane<BITPLANE_CNT; plane++) p[plane]=bitplane[backbuf_id][plane] + y * ROW_SZ;
+	const Color *upper=&shownFrame[y*ROW_SZ];
+	hub75_word_t lbits=lineBits[y];
+	for (int fx=0; fx<ROW_SZ; fx++) {
+		int xreal = ROW_SZ-1-(fx^FIFO_SWAP);
+		uint64_t bits = pixelBits(upper[xreal]);
+#if HALVES == 2
+		bits |= pixelBits(upper[SCAN_ROWS*ROW_SZ+xreal])<<3;
+#endif
+		hub75_word_t ctrl = ctrlWords[fx] | lbits;
+		for (int plane=0; plane<BITPLANE_CNT; plane++) {
+			int rgb = (bits>>(plane*8))&0x3F;
+#if HALVES == 2
+			rgb = (rgb&7)|((rgb&0x38)<<5);  //lower half RGB to bits 8-10
+#endif
+			p[plane][fx] = ctrl | rgb;
+		}
+	}
+}
+
 void render16()
 {
-		for (unsigned int y=0; y<8; y++) {
-			int lbits=0;         //Precalculate line bits of the *previous* line, which is the one we're displaying now
-			if ((y-1)&1) lbits|=BIT_A;
-			if ((y-1)&2) lbits|=BIT_B;
-			if ((y-1)&4) lbits|=BIT_C;
-            //Fill bitplanes with the data for the current image
-            for (int plane=0; plane<BITPLANE_CNT; plane++) {
-                int mask=(1<<(8-BITPLANE_CNT+plane));         //bitmask for pixel data in input for this bitplane
-                uint8_t *p=bitplane[backbuf_id][plane] + y * 32;         //bitplane location to write to
-			for (int fx=0; fx<32; fx++) {
-				int x = fx^2;   //Apply correction. this fixes dma byte stream order
-				int v = lbits;
-				//Do not show image while the line bits are changing
-				//Don't display for the first cycle to remove line bleed
-				if (x<1 || x>=brightness) v|= BIT_OE;
-				if (x==31) v|= BIT_LAT;         //latch on last bit...
-				Color c1;
-				int yreal = y;
-				int xreal = 31-x;
-				if (hub75_framebuffer) {
-					c1 = hub75_framebuffer[yreal*CONFIG_HUB75_WIDTH+xreal];
-				} else {
-					c1.value = 0; //If no framebuffer available display is off.
-				}
-
-				if (valToPwm(c1.RGB[3]) & mask) v|= BIT_R1;
-				if (valToPwm(c1.RGB[2]) & mask) v|= BIT_G1;
-				if (valToPwm(c1.RGB[1]) & mask) v|= BIT_B1;
-
-				//Save the calculated value to the bitplane memory
-				*p++=v;
-			}
+	if (brightness!=ctrlBrightness) {
+		buildControlWords();
+		rowsValid[0]=rowsValid[1]=0;
+	}
+
+	//Find the rows that changed since the last frame
+	if (!hub75_framebuffer) {
+		//If no framebuffer available display is off.
+		if (!shownBlank) {
+			memset(shownFrame, 0, CONFIG_HUB75_HEIGHT*ROW_SZ*sizeof(Color));
+			rowsValid[0]=rowsValid[1]=0;
+			shownBlank=true;
+		}
+	} else {
+		shownBlank=false;
+		for (int y=0; y<CONFIG_HUB75_HEIGHT; y++) {
+			Color *shown = &shownFrame[y*ROW_SZ];
+			const Color *row = &hub75_framebuffer[y*CONFIG_HUB75_WIDTH];
+			if (!memcmp(shown, row, ROW_SZ*sizeof(Color))) continue;
+			memcpy(shown, row, ROW_SZ*sizeof(Color));
+			rowsValid[0]&=~(1UL<<(y%SCAN_ROWS));
+			rowsValid[1]&=~(1UL<<(y%SCAN_ROWS));
 		}
 	}
+	//The buffer on display is still up to date
+	if (rowsValid[backbuf_id^1]==ALL_ROWS) return;
+
+	for (int y=0; y<SCAN_ROWS; y++) {
+		if (!(rowsValid[backbuf_id]&(1UL<<y))) renderRow(y);
+	}
+	rowsValid[backbuf_id]=ALL_ROWS;
 
 	//Show our work!
 	i2sparallel_flipBuffer(backbuf_id);
@@ -129,10 +250,16 @@ esp_err_t driver_hub75_init(void)
 	hub75_framebuffer = malloc(HUB75_BUFFER_SIZE);
 	memset(hub75_framebuffer, 0, HUB75_BUFFER_SIZE);
 	#endif
-	
+
+	buildPlaneLut();
+	shownFrame = calloc(CONFIG_HUB75_HEIGHT*ROW_SZ, sizeof(Color));
+	if (!shownFrame) {
+		ESP_LOGE(TAG, "Can't allocate frame memory");
+		return ESP_FAIL;
+	}
 	for (int i=0; i<BITPLANE_CNT; i++) {
 		for (int j=0; j<2; j++) {
-			bitplane[j][i] = (uint8_t *) heap_caps_calloc(BITPLANE_SZ, sizeof(uint8_t), MALLOC_CAP_DMA);
+			bitplane[j][i] = (hub75_word_t *) heap_caps_calloc(BITPLANE_SZ, sizeof(uint8_t), MALLOC_CAP_DMA);
 			if (!bitplane[j][i]) {
 				ESP_LOGE(TAG, "Can't allocate bitplane memory");
 				return ESP_FAIL;
@@ -164,7 +291,11 @@ esp_err_t driver_hub75_init(void)
 	bufdesc[1][((1<<BITPLANE_CNT)-1)].memory=NULL;
 
 	//Setup I2S
-	i2sparallel_init(bufdesc[0], bufdesc[1]);
+	esp_err_t res = i2sparallel_init(BUS_BITS, bufdesc[0], bufdesc[1]);
+	if (res != ESP_OK) {
+		ESP_LOGE(TAG, "Can't set up I2S");
+		return res;
+	}
 
 	compositor_init();
 	#ifndef CONFIG_DRIVER_FRAMEBUFFER_ENABLE
@@ -195,7 +326,7 @@ void driver_hub75_set_brightness(int brightness_val)
 
 void driver_hub75_set_framerate(int framerate_val)
 {
-	framerate = min(max(1, framerate_val), 30);
+	framerate = min(max(1, framerate_val), configTICK_RATE_HZ);
 }
 
 void driver_hub75_switch_buffer(uint8_t* buffer)
@@ -19,8 +19,8 @@ void renderChar_6x3(uint8_t charId, Color color, int *x, int y, int endX, int *s
         }
 
         for (int row = 0; row < 6; row++) {
-            int8_t targetRow = y + row;
-            int8_t targetCol = *x + col;
+            int targetRow = y + row;
+            int targetCol = *x + col;
 
             if (targetCol >= CONFIG_HUB75_WIDTH || targetRow >= CONFIG_HUB75_HEIGHT || targetCol < 0 || targetRow < 0) {
                 continue;
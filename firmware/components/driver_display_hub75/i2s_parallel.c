@@ -48,10 +48,15 @@ int gpio_bus[32] = {CONFIG_PIN_NUM_HUB75_R0,
                     CONFIG_PIN_NUM_HUB75_B,
                     CONFIG_PIN_NUM_HUB75_C,
                     CONFIG_PIN_NUM_HUB75_LAT,
-                    CONFIG_PIN_NUM_HUB75_OE, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1};
+                    CONFIG_PIN_NUM_HUB75_OE,
+                    CONFIG_PIN_NUM_HUB75_R1,
+                    CONFIG_PIN_NUM_HUB75_G1,
+                    CONFIG_PIN_NUM_HUB75_B1,
+                    CONFIG_PIN_NUM_HUB75_D,
+                    CONFIG_PIN_NUM_HUB75_E, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1};
 int gpio_clk = CONFIG_PIN_NUM_HUB75_CLK;
 int clkspeed_hz = CONFIG_HUB75_CLOCK_SPEED;
-i2s_parallel_cfg_bits_t bits = I2S_PARALLEL_BITS_8;
+static i2s_parallel_cfg_bits_t bits = I2S_PARALLEL_BITS_8;
 
 #define DMA_MAX (4096-4)
 
@@ -112,7 +117,8 @@ static int i2snum() {
     return (&hw==&I2S0)?0:1;
 }
 
-void i2sparallel_init(i2s_parallel_buffer_desc_t *bufa, i2s_parallel_buffer_desc_t *bufb) {
+esp_err_t i2sparallel_init(i2s_parallel_cfg_bits_t bus_bits, i2s_parallel_buffer_desc_t *bufa, i2s_parallel_buffer_desc_t *bufb) {
+    bits=bus_bits;
     //Figure out which signal numbers to use for routing
     int sig_data_base, sig_clk;
     if (&hw==&I2S0) {
@@ -192,12 +198,21 @@ void i2sparallel_init(i2s_parallel_buffer_desc_t *bufa, i2s_parallel_buffer_desc
     hw.timing.val=0;
 
     //Allocate DMA descriptors
-    i2s_state[i2snum()]=(i2s_parallel_state_t *) malloc(sizeof(i2s_parallel_state_t));
-    i2s_parallel_state_t *st=i2s_state[i2snum()];
+    i2s_parallel_state_t *st=(i2s_parallel_state_t *) malloc(sizeof(i2s_parallel_state_t));
+    i2s_state[i2snum()]=NULL;
+    if (!st) return ESP_ERR_NO_MEM;
     st->desccount_a=calc_needed_dma_descs_for(bufa);
     st->desccount_b=calc_needed_dma_descs_for(bufb);
     st->dmadesc_a=(volatile lldesc_t *) heap_caps_malloc(st->desccount_a*sizeof(lldesc_t), MALLOC_CAP_DMA);
     st->dmadesc_b=(volatile lldesc_t *) heap_caps_malloc(st->desccount_b*sizeof(lldesc_t), MALLOC_CAP_DMA);
+    if (!st->dmadesc_a || !st->dmadesc_b) {
+        printf("i2sparallel_init: can't allocate %d DMA descriptors\n", st->desccount_a+st->desccount_b);
+        heap_caps_free((void *)st->dmadesc_a);
+        heap_caps_free((void *)st->dmadesc_b);
+        free(st);
+        return ESP_ERR_NO_MEM;
+    }
+    i2s_state[i2snum()]=st;
 
     //and fill them
     fill_dma_desc(st->dmadesc_a, bufa);
@@ -214,6 +229,7 @@ void i2sparallel_init(i2s_parallel_buffer_desc_t *bufa, i2s_parallel_buffer_desc
     hw.out_link.addr=((uint32_t)(&st->dmadesc_a[0]));
     hw.out_link.start=1;
     hw.conf.tx_start=1;
+    return ESP_OK;
 }
 
 
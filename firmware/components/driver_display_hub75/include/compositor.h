@@ -6,8 +6,8 @@
 #include "color.h"
 
 typedef struct renderTask {
-    struct renderTask *next;
     void *payload;
+    Color *layer; /* Pre-rendered text, or NULL */
     int id;
     int x;
     int y;
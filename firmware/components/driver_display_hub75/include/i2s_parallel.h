@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <esp_err.h>
 
 typedef enum {
     I2S_PARALLEL_BITS_8=8,
@@ -15,7 +16,7 @@ typedef struct i2s_parallel_buffer_desc {
     size_t size;
 } i2s_parallel_buffer_desc_t;
 
-void i2sparallel_init(i2s_parallel_buffer_desc_t *bufa, i2s_parallel_buffer_desc_t *bufb);
+esp_err_t i2sparallel_init(i2s_parallel_cfg_bits_t bits, i2s_parallel_buffer_desc_t *bufa, i2s_parallel_buffer_desc_t *bufb);
 void i2sparallel_flipBuffer(int bufid);
 
 #endif
@@ -23,9 +23,13 @@
 
 #ifdef CONFIG_DRIVER_ST7789V_ENABLE
 
+#define ST7789V_TRANSFER_BUFFERS 2
+
 static const char *TAG = "st7789v";
 
-uint8_t *internalBuffer; //Internal transfer buffer for doing partial updates
+uint8_t *internalBuffer[ST7789V_TRANSFER_BUFFERS]; //Internal transfer buffers for doing partial updates, one is filled while the other is sent
+static spi_transaction_t pixelTransactions[ST7789V_TRANSFER_BUFFERS];
+static const uint8_t pixelDcLevel = true;
 
 static spi_device_handle_t spi_bus = NULL;
 
@@ -65,6 +69,22 @@ esp_err_t driver_st7789v_receive(uint8_t *data, int len, const uint8_t dc_level)
 	return spi_device_transmit(spi_bus, &t);
 }
 
+esp_err_t driver_st7789v_queue_pixels(uint8_t index, int len)
+{ //Queue sending one of the transfer buffers without waiting for the transfer to complete
+	spi_transaction_t* t = &pixelTransactions[index];
+	memset(t, 0, sizeof(spi_transaction_t));
+	t->length    = len * 8;  // transaction length is in bits
+	t->tx_buffer = internalBuffer[index];
+	t->user      = (void *) &pixelDcLevel;
+	return spi_device_queue_trans(spi_bus, t, portMAX_DELAY);
+}
+
+esp_err_t driver_st7789v_wait_pixels()
+{ //Wait for the oldest queued transfer to complete
+	spi_transaction_t* t;
+	return spi_device_get_trans_result(spi_bus, &t, portMAX_DELAY);
+}
+
 esp_err_t driver_st7789v_write_initData(const uint8_t * data)
 {
 	uint8_t cmd, len;
@@ -171,9 +191,11 @@ esp_err_t driver_st7789v_init(void)
 	res = driver_st7789v_set_backlight(false);
 	if (res != ESP_OK) return res;
 
-	//Allocate partial update buffer
-	internalBuffer = heap_caps_malloc(CONFIG_DRIVER_VSPI_MAX_TRANSFERSIZE, MALLOC_CAP_8BIT);
-	if (!internalBuffer) return ESP_FAIL;
+	//Allocate partial update buffers
+	for (uint8_t i = 0; i < ST7789V_TRANSFER_BUFFERS; i++) {
+		internalBuffer[i] = heap_caps_malloc(CONFIG_DRIVER_VSPI_MAX_TRANSFERSIZE, MALLOC_CAP_DMA | MALLOC_CAP_8BIT);
+		if (!internalBuffer[i]) return ESP_FAIL;
+	}
 	
 	//Initialize reset GPIO pin
 	#if CONFIG_PIN_NUM_ST7789V_RESET >= 0
@@ -189,7 +211,7 @@ esp_err_t driver_st7789v_init(void)
 		.clock_speed_hz = 4 * 1000 * 1000,
 		.mode           = 0,  // SPI mode 0
 		.spics_io_num   = CONFIG_PIN_NUM_ST7789V_CS,
-		.queue_size     = 1,
+		.queue_size     = ST7789V_TRANSFER_BUFFERS,
 		.flags          = (SPI_DEVICE_HALFDUPLEX | SPI_DEVICE_3WIRE),//SPI_DEVICE_HALFDUPLEX,
 		.pre_cb         = driver_st7789v_spi_pre_transfer_callback, // Specify pre-transfer callback to handle D/C line
 	};
@@ -260,61 +282,57 @@ esp_err_t driver_st7789v_write_partial(const uint8_t *frameBuffer, uint16_t x0,
 	uint16_t h = y1-y0+1;
 	
 	printf("Driver ST7789V write @ %d, %d with width %d and height %d\n", x0, y0, w, h);
-#if CONFIG_DRIVER_ST7789V_8C
-	while (w > 0) {
+	//Rows are packed into the transfer buffers, which are filled and sent alternately
+	bool pending[ST7789V_TRANSFER_BUFFERS] = {false};
+	uint8_t current = 0;
+	while ((w > 0) && (res == ESP_OK)) {
 		uint16_t transactionWidth = w;
 		if (transactionWidth*2 > CONFIG_DRIVER_VSPI_MAX_TRANSFERSIZE) {
 			transactionWidth = CONFIG_DRIVER_VSPI_MAX_TRANSFERSIZE/2;
 		}
+		uint16_t transactionLines = CONFIG_DRIVER_VSPI_MAX_TRANSFERSIZE/(transactionWidth*2);
 		res = driver_st7789v_set_addr_window(x0+ST7789V_OFFSET_X, y0+ST7789V_OFFSET_Y, transactionWidth, h);
 		if (res != ESP_OK) return res;
-		for (uint16_t currentLine = 0; currentLine < h; currentLine++) {
-			for (uint16_t i = 0; i<transactionWidth; i++) {
-				uint8_t color8 = frameBuffer[x0+i+(y0+currentLine)*ST7789V_WIDTH];
-				uint8_t r = color8 & 0x07;
-				uint8_t g = (color8>>3) & 0x07;
-				uint8_t b = color8 >> 6;
-				internalBuffer[i*2+0] = g | (r << 5);
-				internalBuffer[i*2+1] = (b << 3);
+		for (uint16_t currentLine = 0; (currentLine < h) && (res == ESP_OK); currentLine += transactionLines) {
+			uint16_t lines = h - currentLine;
+			if (lines > transactionLines) lines = transactionLines;
+			if (pending[current]) {
+				res = driver_st7789v_wait_pixels(); //Wait until the buffer has been sent before filling it again
+				pending[current] = false;
+				if (res != ESP_OK) break;
 			}
-			res = driver_st7789v_send(internalBuffer, transactionWidth*2, true);
-			if (res != ESP_OK) return res;
-		}
-		w -= transactionWidth;
-		x0 += transactionWidth;
-	}
+			uint8_t* buffer = internalBuffer[current];
+			for (uint16_t line = 0; line < lines; line++) {
+#if CONFIG_DRIVER_ST7789V_8C
+				const uint8_t* row = &frameBuffer[x0+(y0+currentLine+line)*ST7789V_WIDTH];
+				for (uint16_t i = 0; i<transactionWidth; i++) {
+					uint8_t color8 = row[i];
+					uint8_t r = color8 & 0x07;
+					uint8_t g = (color8>>3) & 0x07;
+					uint8_t b = color8 >> 6;
+					buffer[i*2+0] = g | (r << 5);
+					buffer[i*2+1] = (b << 3);
+				}
 #else
-	//Old code
-	/*while (h > 0) {
-		uint16_t lines = h;
-		if (lines > 1) lines = 1;
-		esp_err_t res = driver_st7789v_set_addr_window(ST7789V_OFFSET_X, y0+ST7789V_OFFSET_Y, ST7789V_WIDTH, lines);
-		if (res != ESP_OK) break;
-		res = driver_st7789v_send(frameBuffer+(y0*ST7789V_WIDTH)*2, ST7789V_WIDTH*lines*2, true);
-		if (res != ESP_OK) break;
-		y0 += lines;
-		h -= lines;
-	}*/
-	//New (untested) code
-	while (w > 0) {
-		uint16_t transactionWidth = w;
-		if (transactionWidth*2 > CONFIG_DRIVER_VSPI_MAX_TRANSFERSIZE) {
-			transactionWidth = CONFIG_DRIVER_VSPI_MAX_TRANSFERSIZE/2;
+				memcpy(buffer, &frameBuffer[(x0+(y0+currentLine+line)*ST7789V_WIDTH)*2], transactionWidth*2);
+#endif
+				buffer += transactionWidth*2;
+			}
+			res = driver_st7789v_queue_pixels(current, transactionWidth*lines*2);
+			if (res != ESP_OK) break;
+			pending[current] = true;
+			current = (current + 1) % ST7789V_TRANSFER_BUFFERS;
 		}
-		res = driver_st7789v_set_addr_window(x0+ST7789V_OFFSET_X, y0+ST7789V_OFFSET_Y, transactionWidth, h);
-		if (res != ESP_OK) return res;
-		for (uint16_t currentLine = 0; currentLine < h; currentLine++) {
-			for (uint16_t i = 0; i<transactionWidth; i++) {
-				internalBuffer[i*2+0] = frameBuffer[((x0+i)+(y0+currentLine)*ST7789V_WIDTH)*2+0];
-				internalBuffer[i*2+1] = frameBuffer[((x0+i)+(y0+currentLine)*ST7789V_WIDTH)*2+1];
+		for (uint8_t i = 0; i < ST7789V_TRANSFER_BUFFERS; i++) { //The address window can only be changed once all pixels have been sent
+			if (pending[i]) {
+				esp_err_t waitRes = driver_st7789v_wait_pixels();
+				if (res == ESP_OK) res = waitRes;
+				pending[i] = false;
 			}
-			res = driver_st7789v_send(internalBuffer, transactionWidth*2, true);
-			if (res != ESP_OK) return res;
 		}
 		w -= transactionWidth;
 		x0 += transactionWidth;
 	}
-#endif
 	return res;
 }
 
@@ -7,6 +7,13 @@
 #include "sdkconfig.h"
 #include "include/driver_framebuffer_internal.h"
 
+#ifdef CONFIG_DRIVER_FRAMEBUFFER_ASYNC_FLUSH
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#endif
+
 #define TAG "fb"
 
 #ifdef CONFIG_DRIVER_FRAMEBUFFER_ENABLE
@@ -18,6 +25,19 @@ uint8_t* framebuffer2;
 
 uint8_t* framebuffer;
 
+typedef struct {
+	uint8_t* buffer;
+	uint32_t eink_flags;
+	bool greyscale;
+	uint8_t regionCount;
+	int16_t regions[DIRTY_REGIONS_MAX][4]; //x0, y0, x1 and y1 of each area that has to be sent
+} FlushJob;
+
+#ifdef CONFIG_DRIVER_FRAMEBUFFER_ASYNC_FLUSH
+QueueHandle_t flushQueue = NULL;     //Frames waiting to be sent by the flush task
+SemaphoreHandle_t flushDone = NULL;  //Available when the flush task is idle
+#endif
+
 /* Color space conversions */
 
 inline uint16_t convert24to16(uint32_t in) //RGB24 to 565
@@ -57,6 +77,181 @@ inline bool convert8to1(uint8_t in) //8-bit greyscale to black&white
 	return in >= 128;
 }
 
+/* Native pixel layout */
+
+#if defined(FB_TYPE_1BPP)
+static inline void _getPosition1bpp(int16_t width, int16_t height, int16_t x, int16_t y, uint32_t* position, uint8_t* bit)
+{
+	#if defined(FB_1BPP_VERT)
+		// A byte consists of 8 vertical pixels,
+		// each byte is placed next to each other horizontally
+		*position = ( (y / 8) * width) + x;
+		*bit      = y % 8;
+	#elif defined(FB_1BPP_VERT2)
+		// TODO: description
+		*position = (y/8) + (x*height/8);
+		*bit      = y % 8;
+	#elif defined(FB_1BPP_OHS)
+		// TODO: description
+		*position = ((width-x-1) + y * width) / 8;
+		*bit      = x % 8;
+	#else
+		// TODO: description
+		*position = (y * (width/8)) + (x / 8);
+		*bit      = x % 8;
+	#endif
+}
+#endif
+
+#ifdef BYTES_PER_PIXEL
+static inline void _convertNative(uint32_t value, uint8_t* pixel)
+{ //Convert an RGB24 color to the byte representation of a pixel in the buffer
+	#if defined(FB_TYPE_8BPP)
+		pixel[0] = convert24to8(value);
+	#elif defined(FB_TYPE_8CBPP)
+		pixel[0] = convert24to8C(value);
+	#elif defined(FB_TYPE_16BPP)
+		value = convert24to16(value);
+		pixel[0] = (value>>8)&0xFF;
+		pixel[1] = value&0xFF;
+	#elif defined(FB_TYPE_24BPP)
+		pixel[0] = (value>>16)&0xFF;
+		pixel[1] = (value>>8)&0xFF;
+		pixel[2] = value&0xFF;
+	#elif defined(FB_TYPE_32BPP)
+		pixel[0] = (value>>24)&0xFF;
+		pixel[1] = value&0xFF;
+		pixel[2] = (value>>8)&0xFF;
+		pixel[3] = (value>>16)&0xFF;
+	#endif
+}
+#endif
+
+bool _fillNative(uint8_t* buffer, int16_t width, int16_t height, int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint32_t value)
+{ //Fill the area (x0, y0) to (x1, y1) in buffer coordinates, the area must be within the bounds of the buffer
+	bool changed = false;
+	#if defined(FB_TYPE_1BPP)
+		bool set = convert8to1(convert24to8(value));
+		uint8_t c = set ? 0xFF : 0x00;
+		for (int16_t y = y0; y <= y1; y++) {
+			int16_t x = x0;
+			#if !defined(FB_1BPP_VERT) && !defined(FB_1BPP_VERT2) && !defined(FB_1BPP_OHS)
+				//Horizontal layout: write the whole bytes in the middle of the span at once
+				for (; (x <= x1) && (x % 8); x++) {
+					uint32_t position; uint8_t bit;
+					_getPosition1bpp(width, height, x, y, &position, &bit);
+					if (((buffer[position] >> bit) & 0x01) != set) changed = true;
+					if (set) buffer[position] |= 1UL << bit; else buffer[position] &= ~(1UL << bit);
+				}
+				if (x1 - x + 1 >= 8) {
+					uint16_t bytes = (x1 - x + 1) / 8;
+					uint8_t* start = &buffer[(y * (width/8)) + (x / 8)];
+					for (uint16_t i = 0; (i < bytes) && (!changed); i++) if (start[i] != c) changed = true;
+					memset(start, c, bytes);
+					x += bytes * 8;
+				}
+			#endif
+			for (; x <= x1; x++) {
+				uint32_t position; uint8_t bit;
+				_getPosition1bpp(width, height, x, y, &position, &bit);
+				if (((buffer[position] >> bit) & 0x01) != set) changed = true;
+				if (set) buffer[position] |= 1UL << bit; else buffer[position] &= ~(1UL << bit);
+			}
+		}
+	#elif defined(FB_TYPE_12BPP)
+		uint8_t r = (value >> 20) &0x0F;
+		uint8_t g = (value >> 12) &0x0F;
+		uint8_t b = (value >> 04) &0x0F;
+		changed = true;
+		for (int16_t y = y0; y <= y1; y++) {
+			for (int16_t x = x0; x <= x1; x++) {
+				uint32_t positionBits = (x+(y*width))*12;
+				uint32_t positionByte = positionBits/8;
+				if (positionBits % 8) {
+					buffer[positionByte+0] = (buffer[positionByte+0]&0xF0) | r;
+					buffer[positionByte+1] = (g<<4) | b;
+				} else {
+					buffer[positionByte+0] = (r<<4) | g;
+					buffer[positionByte+1] = (b<<4) | (buffer[positionByte+1]&0x0F);
+				}
+			}
+		}
+	#elif defined(BYTES_PER_PIXEL)
+		//Write the first row pixel by pixel, then copy it to the other rows
+		uint8_t pixel[BYTES_PER_PIXEL];
+		_convertNative(value, pixel);
+		const uint8_t bpp = BYTES_PER_PIXEL;
+		uint32_t total = (x1 - x0 + 1) * bpp;
+		uint8_t* first = &buffer[((y0 * width) + x0) * bpp];
+		for (uint32_t i = 0; (i < total) && (!changed); i += bpp) if (memcmp(&first[i], pixel, bpp)) changed = true;
+		bool uniform = true;
+		for (uint8_t i = 1; i < bpp; i++) if (pixel[i] != pixel[0]) uniform = false;
+		if (uniform) {
+			memset(first, pixel[0], total); //All bytes of the pixel are equal (black, white, grey)
+		} else {
+			memcpy(first, pixel, bpp);
+			uint32_t done = bpp;
+			while (done < total) { //Double the initialised part of the row until the row is complete
+				uint32_t chunk = (done < total - done) ? done : total - done;
+				memcpy(first + done, first, chunk);
+				done += chunk;
+			}
+		}
+		for (int16_t y = y0 + 1; y <= y1; y++) {
+			uint8_t* row = &buffer[((y * width) + x0) * bpp];
+			if ((!changed) && memcmp(row, first, total)) changed = true;
+			memcpy(row, first, total);
+		}
+	#else
+		#error "No framebuffer type configured."
+	#endif
+	return changed;
+}
+
+void _flush_job(FlushJob* job)
+{ //Send the dirty regions of a buffer to the display
+	#ifdef FB_FLUSH_GS
+	if (job->greyscale) {
+		FB_FLUSH_GS(job->buffer, job->eink_flags);
+		return;
+	}
+	#endif
+	for (uint8_t region = 0; region < job->regionCount; region++) {
+		int16_t* area = job->regions[region];
+		FB_FLUSH(job->buffer,job->eink_flags,area[0],area[1],area[2],area[3]);
+	}
+}
+
+#ifdef CONFIG_DRIVER_FRAMEBUFFER_ASYNC_FLUSH
+void _flush_task(void* arg)
+{ //Sends frames to the display while the next frame is being drawn in the other buffer
+	FlushJob job;
+	while (true) {
+		if (xQueueReceive(flushQueue, &job, portMAX_DELAY) != pdTRUE) continue;
+		_flush_job(&job);
+		xSemaphoreGive(flushDone);
+	}
+}
+#endif
+
+#ifdef CONFIG_DRIVER_FRAMEBUFFER_DOUBLE_BUFFERED
+void _sync_buffers(uint8_t* target, const uint8_t* source, FlushJob* job)
+{ //Copy the areas that changed during the last frame into the buffer that will be drawn next
+	#ifdef BYTES_PER_PIXEL
+		for (uint8_t region = 0; region < job->regionCount; region++) {
+			int16_t* area = job->regions[region];
+			uint32_t length = (area[2] - area[0] + 1) * BYTES_PER_PIXEL;
+			for (int16_t y = area[1]; y <= area[3]; y++) {
+				uint32_t offset = (y * FB_WIDTH + area[0]) * BYTES_PER_PIXEL;
+				memcpy(&target[offset], &source[offset], length);
+			}
+		}
+	#else
+		memcpy(target, source, FB_SIZE); //Packed pixels, rows are not byte aligned for every layout
+	#endif
+}
+#endif
+
 esp_err_t driver_framebuffer_init()
 {
 	static bool driver_framebuffer_init_done = false;
@@ -79,6 +274,13 @@ esp_err_t driver_framebuffer_init()
 		#endif
 		if (!framebuffer2) return ESP_FAIL;
 		framebuffer = framebuffer1;
+		#ifdef CONFIG_DRIVER_FRAMEBUFFER_ASYNC_FLUSH
+			flushQueue = xQueueCreate(1, sizeof(FlushJob));
+			flushDone = xSemaphoreCreateBinary();
+			if ((!flushQueue) || (!flushDone)) return ESP_FAIL;
+			xSemaphoreGive(flushDone);
+			if (xTaskCreate(&_flush_task, "framebuffer flush", 4096, NULL, 10, NULL) != pdPASS) return ESP_FAIL;
+		#endif
 	#else
 		ESP_LOGI(TAG, "Allocating %u bytes for the framebuffer", FB_SIZE);
 		#ifdef CONFIG_DRIVER_FRAMEBUFFER_SPIRAM
@@ -204,24 +406,8 @@ void driver_framebuffer_setPixel(Window* window, int16_t x, int16_t y, uint32_t
 	bool changed = false;
 	#if defined(FB_TYPE_1BPP)
 		value = convert8to1(convert24to8(value));
-		#if defined(FB_1BPP_VERT)
-			// A byte consists of 8 vertical pixels,
-			// each byte is placed next to each other horizontally
-			uint32_t position = ( (y / 8) * width) + x;
-			uint8_t  bit      = y % 8;
-		#elif defined(FB_1BPP_VERT2)
-			// TODO: description
-			uint32_t position = (y/8) + (x*height/8);
-			uint8_t  bit      = y % 8;
-		#elif defined(FB_1BPP_OHS)
-			// TODO: description
-			uint32_t position = ((width-x-1) + y * width) / 8;
-			uint8_t  bit      = x % 8;
-		#else
-			// TODO: description
-			uint32_t position = (y * (width/8)) + (x / 8);
-			uint8_t  bit      = x % 8;
-		#endif
+		uint32_t position; uint8_t bit;
+		_getPosition1bpp(width, height, x, y, &position, &bit);
 
 		uint8_t oldVal = buffer[position];
 		if (value) {
@@ -304,25 +490,8 @@ uint32_t driver_framebuffer_getPixel(Window* window, int16_t x, int16_t y)
 	if (!driver_framebuffer_orientation_apply(window, &x, &y)) return 0;
 
 	#if defined(FB_TYPE_1BPP)
-		#ifndef FB_1BPP_VERT
-			#if defined(FB_1BPP_OHS)
-			#warning "USING OHS!!"
-				uint32_t position = ((width-x-1) + y * width) / 8;
-				uint8_t  bit      = x % 8;
-			#elif defined(FB_1BPP_VERT2)
-				#warning "USING VERT2!"
-				uint32_t position = (y/8) + (x*height/8);
-				uint8_t  bit      = y % 8;
-			#else
-			#warning "USING HORI!"
-				uint32_t position = (y * (width/8)) + (x / 8);
-				uint8_t  bit      = x % 8;
-			#endif
-		#else
-			#warning "USING VERT!"
-			uint32_t position = ( (y / 8) * width) + x;
-			uint8_t  bit      = y % 8;
-		#endif
+		uint32_t position; uint8_t bit;
+		_getPosition1bpp(width, height, x, y, &position, &bit);
 		if ((buffer[position] >> bit) & 0x01) {
 			return 0xFFFFFF;
 		} else {
@@ -375,17 +544,249 @@ uint32_t driver_framebuffer_getPixel(Window* window, int16_t x, int16_t y)
 	#endif
 }
 
+void driver_framebuffer_setPixels(Window* window, int16_t x, int16_t y, const uint32_t* values, uint16_t count)
+{
+	int16_t width, height;
+	driver_framebuffer_get_orientation_size(window, &width, &height);
+	if ((y < 0) || (y >= height)) return;
+	int32_t x0 = x, x1 = (int32_t) x + count - 1;
+	if (x0 < 0) x0 = 0;
+	if (x1 >= width) x1 = width - 1;
+	if (x1 < x0) return;
+	values += x0 - x;
+	#ifdef BYTES_PER_PIXEL
+		uint8_t* buffer; int16_t bufferWidth, bufferHeight;
+		if (!_getFrameContext(window, &buffer, &bufferWidth, &bufferHeight)) return;
+		//The row maps to a straight line in the buffer, find its start and the distance between two pixels
+		int16_t sx0 = x0, sy0 = y, sx1 = x1, sy1 = y;
+		driver_framebuffer_orientation_apply(window, &sx0, &sy0);
+		driver_framebuffer_orientation_apply(window, &sx1, &sy1);
+		int32_t step = 0;
+		if (x1 > x0) step = ((sy1 - sy0) * bufferWidth + (sx1 - sx0)) / (x1 - x0);
+		uint8_t* pixel = &buffer[((sy0 * bufferWidth) + sx0) * BYTES_PER_PIXEL];
+		bool changed = false;
+		for (int32_t i = 0; i <= x1 - x0; i++) {
+			uint8_t native[BYTES_PER_PIXEL];
+			_convertNative(values[i], native);
+			if (memcmp(pixel, native, BYTES_PER_PIXEL)) {
+				memcpy(pixel, native, BYTES_PER_PIXEL);
+				changed = true;
+			}
+			pixel += step * BYTES_PER_PIXEL;
+		}
+		if ((!window) && changed) {
+			driver_framebuffer_set_dirty_area(sx0 < sx1 ? sx0 : sx1, sy0 < sy1 ? sy0 : sy1, sx0 < sx1 ? sx1 : sx0, sy0 < sy1 ? sy1 : sy0, false);
+		}
+	#else
+		for (int32_t i = 0; i <= x1 - x0; i++) driver_framebuffer_setPixel(window, x0 + i, y, values[i]);
+	#endif
+}
+
+#ifdef BYTES_PER_PIXEL
+void driver_framebuffer_setPixelsNative(Window* window, int16_t x, int16_t y, const uint8_t* pixels, uint16_t count)
+{
+	int16_t width, height;
+	driver_framebuffer_get_orientation_size(window, &width, &height);
+	if ((y < 0) || (y >= height)) return;
+	int32_t x0 = x, x1 = (int32_t) x + count - 1;
+	if (x0 < 0) x0 = 0;
+	if (x1 >= width) x1 = width - 1;
+	if (x1 < x0) return;
+	pixels += (x0 - x) * BYTES_PER_PIXEL;
+	uint8_t* buffer; int16_t bufferWidth, bufferHeight;
+	if (!_getFrameContext(window, &buffer, &bufferWidth, &bufferHeight)) return;
+	int16_t sx0 = x0, sy0 = y, sx1 = x1, sy1 = y;
+	driver_framebuffer_orientation_apply(window, &sx0, &sy0);
+	driver_framebuffer_orientation_apply(window, &sx1, &sy1);
+	int32_t step = 0;
+	if (x1 > x0) step = ((sy1 - sy0) * bufferWidth + (sx1 - sx0)) / (x1 - x0);
+	uint8_t* pixel = &buffer[((sy0 * bufferWidth) + sx0) * BYTES_PER_PIXEL];
+	uint32_t length = (x1 - x0 + 1) * BYTES_PER_PIXEL;
+	bool changed = false;
+	if (step == 1) {
+		//Not rotated, the row is a single block of memory
+		changed = memcmp(pixel, pixels, length) != 0;
+		if (changed) memcpy(pixel, pixels, length);
+	} else {
+		for (uint32_t i = 0; i < length; i += BYTES_PER_PIXEL) {
+			if (memcmp(pixel, &pixels[i], BYTES_PER_PIXEL)) {
+				memcpy(pixel, &pixels[i], BYTES_PER_PIXEL);
+				changed = true;
+			}
+			pixel += step * BYTES_PER_PIXEL;
+		}
+	}
+	if ((!window) && changed) {
+		driver_framebuffer_set_dirty_area(sx0 < sx1 ? sx0 : sx1, sy0 < sy1 ? sy0 : sy1, sx0 < sx1 ? sx1 : sx0, sy0 < sy1 ? sy1 : sy0, false);
+	}
+}
+#endif
+
+static inline uint8_t _blend(uint8_t background, uint8_t foreground, uint8_t alpha)
+{ //Mix two values of a color channel, works for channels of any bit width
+	return (background * (255 - alpha) + foreground * alpha + 127) / 255;
+}
+
+void driver_framebuffer_blendPixel(Window* window, int16_t x, int16_t y, uint32_t value, uint8_t alpha)
+{
+	if (alpha == 0) return;
+	if (alpha == 255) {
+		driver_framebuffer_setPixel(window, x, y, value);
+		return;
+	}
+	#if defined(FB_TYPE_1BPP) || defined(FB_TYPE_12BPP)
+		//No intermediate levels available (or no native blending implemented), round to the nearest color
+		if (alpha >= 128) driver_framebuffer_setPixel(window, x, y, value);
+	#else
+		uint8_t* buffer; int16_t width, height;
+		if (!_getFrameContext(window, &buffer, &width, &height)) return;
+		if (!driver_framebuffer_orientation_apply(window, &x, &y)) return;
+		uint8_t* pixel = &buffer[((y * width) + x) * BYTES_PER_PIXEL];
+		uint8_t native[BYTES_PER_PIXEL];
+		_convertNative(value, native);
+		bool changed = false;
+		#if defined(FB_TYPE_16BPP)
+			//Blend the 5-6-5 bit fields separately
+			uint16_t bg = (pixel[0] << 8) | pixel[1];
+			uint16_t fg = (native[0] << 8) | native[1];
+			uint16_t out = (_blend(bg >> 11, fg >> 11, alpha) << 11)
+			             | (_blend((bg >> 5) & 0x3F, (fg >> 5) & 0x3F, alpha) << 5)
+			             | _blend(bg & 0x1F, fg & 0x1F, alpha);
+			native[0] = out >> 8;
+			native[1] = out & 0xFF;
+		#elif defined(FB_TYPE_8CBPP)
+			//Blend the 3-3-2 bit fields separately
+			native[0] = _blend(pixel[0] & 0x07, native[0] & 0x07, alpha)
+			          | (_blend((pixel[0] >> 3) & 0x07, (native[0] >> 3) & 0x07, alpha) << 3)
+			          | (_blend(pixel[0] >> 6, native[0] >> 6, alpha) << 6);
+		#else
+			//Every byte is a channel
+			for (uint8_t i = 0; i < BYTES_PER_PIXEL; i++) native[i] = _blend(pixel[i], native[i], alpha);
+		#endif
+		for (uint8_t i = 0; i < BYTES_PER_PIXEL; i++) {
+			if (pixel[i] != native[i]) changed = true;
+			pixel[i] = native[i];
+		}
+		if ((!window) && changed) driver_framebuffer_set_dirty_area(x,y,x,y,false);
+	#endif
+}
+
+void driver_framebuffer_fill_rect(Window* window, int16_t x, int16_t y, uint16_t w, uint16_t h, uint32_t value)
+{
+	uint8_t* buffer; int16_t width, height;
+	if (!_getFrameContext(window, &buffer, &width, &height)) return;
+	
+	//Clip the rectangle from the users perspective
+	int16_t screenWidth, screenHeight;
+	driver_framebuffer_get_orientation_size(window, &screenWidth, &screenHeight);
+	int32_t cx0 = x, cy0 = y, cx1 = (int32_t) x + w - 1, cy1 = (int32_t) y + h - 1;
+	if (cx0 < 0) cx0 = 0;
+	if (cy0 < 0) cy0 = 0;
+	if (cx1 > screenWidth  - 1) cx1 = screenWidth  - 1;
+	if (cy1 > screenHeight - 1) cy1 = screenHeight - 1;
+	if ((cx0 > cx1) || (cy0 > cy1)) return;
+	
+	//Rotating by a multiple of 90 degrees keeps the rectangle a rectangle, so only the corners need to be translated
+	int16_t x0 = cx0, y0 = cy0, x1 = cx1, y1 = cy1;
+	driver_framebuffer_orientation_apply(window, &x0, &y0);
+	driver_framebuffer_orientation_apply(window, &x1, &y1);
+	if (x0 > x1) { int16_t t = x0; x0 = x1; x1 = t; }
+	if (y0 > y1) { int16_t t = y0; y0 = y1; y1 = t; }
+	
+	bool changed = _fillNative(buffer, width, height, x0, y0, x1, y1, value);
+	if ((!window) && changed) driver_framebuffer_set_dirty_area(x0, y0, x1, y1, false);
+}
+
+void driver_framebuffer_hspan(Window* window, int16_t x, int16_t y, uint16_t w, uint32_t value)
+{
+	driver_framebuffer_fill_rect(window, x, y, w, 1, value);
+}
+
+void driver_framebuffer_vspan(Window* window, int16_t x, int16_t y, uint16_t h, uint32_t value)
+{
+	driver_framebuffer_fill_rect(window, x, y, 1, h, value);
+}
+
+#ifdef BYTES_PER_PIXEL
+bool _blitNative(Window* source, Window* target, int16_t sx0, int16_t sy0, int16_t sx1, int16_t sy1, int16_t tx0, int16_t ty0, int16_t tx1, int16_t ty1)
+{ //Copy rows of native pixels, the mapping from the source buffer to the target buffer is a translation because both share the same orientation
+	uint8_t *sourceBuffer, *targetBuffer;
+	int16_t sourceWidth, sourceHeight, targetWidth, targetHeight;
+	if (!_getFrameContext(source, &sourceBuffer, &sourceWidth, &sourceHeight)) return false;
+	if (!_getFrameContext(target, &targetBuffer, &targetWidth, &targetHeight)) return false;
+	
+	driver_framebuffer_orientation_apply(source, &sx0, &sy0);
+	driver_framebuffer_orientation_apply(source, &sx1, &sy1);
+	driver_framebuffer_orientation_apply(target, &tx0, &ty0);
+	driver_framebuffer_orientation_apply(target, &tx1, &ty1);
+	if (sx0 > sx1) { int16_t t = sx0; sx0 = sx1; sx1 = t; }
+	if (sy0 > sy1) { int16_t t = sy0; sy0 = sy1; sy1 = t; }
+	if (tx0 > tx1) { int16_t t = tx0; tx0 = tx1; tx1 = t; }
+	if (ty0 > ty1) { int16_t t = ty0; ty0 = ty1; ty1 = t; }
+	
+	uint8_t key[BYTES_PER_PIXEL];
+	_convertNative(source->transparentColor, key);
+	
+	bool changed = false;
+	uint32_t count = sx1 - sx0 + 1;
+	for (int16_t row = 0; row <= sy1 - sy0; row++) {
+		const uint8_t* src = &sourceBuffer[(((sy0 + row) * sourceWidth) + sx0) * BYTES_PER_PIXEL];
+		uint8_t*       dst = &targetBuffer[(((ty0 + row) * targetWidth) + tx0) * BYTES_PER_PIXEL];
+		if (!source->enableTransparentColor) {
+			if ((!changed) && memcmp(dst, src, count * BYTES_PER_PIXEL)) changed = true;
+			memcpy(dst, src, count * BYTES_PER_PIXEL);
+			continue;
+		}
+		//Skip the transparent pixels and copy each run of opaque pixels at once
+		uint32_t i = 0;
+		while (i < count) {
+			while ((i < count) && (memcmp(&src[i * BYTES_PER_PIXEL], key, BYTES_PER_PIXEL) == 0)) i++;
+			uint32_t start = i;
+			while ((i < count) && (memcmp(&src[i * BYTES_PER_PIXEL], key, BYTES_PER_PIXEL) != 0)) i++;
+			if (i > start) {
+				uint32_t offset = start * BYTES_PER_PIXEL, length = (i - start) * BYTES_PER_PIXEL;
+				if ((!changed) && memcmp(&dst[offset], &src[offset], length)) changed = true;
+				memcpy(&dst[offset], &src[offset], length);
+			}
+		}
+	}
+	
+	if ((!target) && changed) driver_framebuffer_set_dirty_area(tx0, ty0, tx1, ty1, false);
+	return true;
+}
+#endif
+
 void driver_framebuffer_blit(Window* source, Window* target)
 {
-	if (source->vOffset >= source->height) return; //The vertical offset is larger than the height of the window
-	if (source->hOffset >= source->width)  return; //The horizontal offset is larger than the width of the window
-	for (uint16_t wy = source->vOffset; wy < source->drawHeight; wy++) {
-		for (uint16_t wx = source->hOffset; wx < source->drawWidth; wx++) {
-			if (wy >= source->height) continue; //Out-of-bounds
-			if (wx >= source->width) continue;  //Out-of-bounds
-			uint32_t color = driver_framebuffer_getPixel(source, wx, wy); //Read the pixel from the window framebuffer
+	//Clip the drawing area to the window and to the target
+	int16_t sourceWidth, sourceHeight, targetWidth, targetHeight;
+	driver_framebuffer_get_orientation_size(source, &sourceWidth, &sourceHeight);
+	driver_framebuffer_get_orientation_size(target, &targetWidth, &targetHeight);
+	int32_t x0 = (source->hOffset > 0) ? source->hOffset : 0;
+	int32_t y0 = (source->vOffset > 0) ? source->vOffset : 0;
+	int32_t x1 = ((source->drawWidth  < sourceWidth)  ? source->drawWidth  : sourceWidth)  - 1;
+	int32_t y1 = ((source->drawHeight < sourceHeight) ? source->drawHeight : sourceHeight) - 1;
+	if (source->x + x0 < 0) x0 = -source->x;
+	if (source->y + y0 < 0) y0 = -source->y;
+	if (source->x + x1 > targetWidth  - 1) x1 = targetWidth  - 1 - source->x;
+	if (source->y + y1 > targetHeight - 1) y1 = targetHeight - 1 - source->y;
+	if ((x0 > x1) || (y0 > y1)) return;
+	
+	#ifdef BYTES_PER_PIXEL
+	if (driver_framebuffer_get_orientation(source) == driver_framebuffer_get_orientation(target)) {
+		if (_blitNative(source, target, x0, y0, x1, y1, source->x + x0, source->y + y0, source->x + x1, source->y + y1)) return;
+	}
+	#endif
+	
+	for (int16_t wy = y0; wy <= y1; wy++) {
+		int16_t wx = x0;
+		while (wx <= x1) {
+			//Collect a run of pixels with the same color and write it to the target as a single span
+			int16_t start = wx;
+			uint32_t color = driver_framebuffer_getPixel(source, wx++, wy); //Read the pixel from the window framebuffer
+			while ((wx <= x1) && (driver_framebuffer_getPixel(source, wx, wy) == color)) wx++;
 			if (source->enableTransparentColor && source->transparentColor == color) continue; //Transparent
-			driver_framebuffer_setPixel(target, source->x + wx, source->y + wy, color); //Write the pixel to the global framebuffer
+			driver_framebuffer_hspan(target, source->x + start, source->y + wy, wx - start, color); //Write the run to the global framebuffer
 		}
 	}
 }
@@ -444,56 +845,46 @@ bool driver_framebuffer_flush(uint32_t flags)
 #error "NO LUT BIT"
 	#endif
 		
-	#ifdef FB_FLUSH_GS
-	if (flags & FB_FLAG_LUT_GREYSCALE) {
-		FB_FLUSH_GS(framebuffer, eink_flags);
-	} else {
+	FlushJob job = {
+		.buffer = framebuffer,
+		.eink_flags = eink_flags,
+		.greyscale = (flags & FB_FLAG_LUT_GREYSCALE) != 0,
+		.regionCount = 1,
+	};
+	#ifdef FB_FLUSH_REGIONS
+		job.regionCount = driver_framebuffer_get_dirty_region_count();
+		for (uint8_t region = 0; region < job.regionCount; region++) {
+			int16_t* area = job.regions[region];
+			driver_framebuffer_get_dirty_region(region, &area[0], &area[1], &area[2], &area[3]);
+		}
+	#else
+		driver_framebuffer_get_dirty_area(&job.regions[0][0], &job.regions[0][1], &job.regions[0][2], &job.regions[0][3]);
 	#endif
-		int16_t dirty_x0, dirty_y0, dirty_x1, dirty_y1;
-		driver_framebuffer_get_dirty_area(&dirty_x0, &dirty_y0, &dirty_x1, &dirty_y1);
-		FB_FLUSH(framebuffer,eink_flags,dirty_x0,dirty_y0,dirty_x1,dirty_y1);
-	#ifdef FB_FLUSH_GS
-	}
+	
+	#ifdef CONFIG_DRIVER_FRAMEBUFFER_ASYNC_FLUSH
+		xSemaphoreTake(flushDone, portMAX_DELAY); //The previous frame has to be sent before its buffer is drawn in again
+		xQueueSend(flushQueue, &job, portMAX_DELAY);
+	#else
+		_flush_job(&job);
 	#endif
 	
 	#ifdef CONFIG_DRIVER_FRAMEBUFFER_DOUBLE_BUFFERED
-	if (framebuffer==framebuffer1) {
-		framebuffer = framebuffer2;
-		memcpy(framebuffer, framebuffer1, FB_SIZE);
-	} else {
-		framebuffer = framebuffer1;
-		memcpy(framebuffer, framebuffer2, FB_SIZE);
-	}
+	framebuffer = (framebuffer == framebuffer1) ? framebuffer2 : framebuffer1;
+	_sync_buffers(framebuffer, job.buffer, &job);
 	#endif
 
 	driver_framebuffer_set_dirty_area(FB_WIDTH-1, FB_HEIGHT-1, 0, 0, true); //Not dirty.
 	return true;
 }
 
-esp_err_t driver_framebuffer_png(Window* window, int16_t x, int16_t y, lib_reader_read_t reader, void* reader_p)
+esp_err_t driver_framebuffer_png_draw(Window* window, int16_t x, int16_t y, struct lib_png_reader* pr)
 {
-	if (!framebuffer) {
-		ESP_LOGE(TAG, "png without alloc!");
-		return ESP_FAIL;
-	}
-	struct lib_png_reader *pr = lib_png_new(reader, reader_p);
-	if (pr == NULL) {
-		printf("Out of memory.\n");
-		return ESP_FAIL;
-	}
-	
 	int res = lib_png_read_header(pr);
 	if (res < 0) {
-		lib_png_destroy(pr);
 		printf("Can not read header.\n");
 		return ESP_FAIL;
 	}
 	
-	int width = pr->ihdr.width;
-	int height = pr->ihdr.height;
-	//int bit_depth = pr->ihdr.bit_depth;
-	//int color_type = pr->ihdr.color_type;
-	
 	//driver_framebuffer_set_dirty_area(x, y, x + width - 1, y + height - 1, false);
 	
 	uint32_t dst_min_x = x < 0 ? -x : 0;
@@ -506,8 +897,6 @@ esp_err_t driver_framebuffer_png(Window* window, int16_t x, int16_t y, lib_reade
 	
 	res = lib_png_load_image(window, pr, x, y, dst_min_x, dst_min_y, screenWidth - x, screenHeight - y, screenWidth);
 
-	lib_png_destroy(pr);
-
 	if (res < 0) {
 		printf("Failed to load image.\n");
 		return ESP_FAIL;
@@ -516,6 +905,23 @@ esp_err_t driver_framebuffer_png(Window* window, int16_t x, int16_t y, lib_reade
 	return ESP_OK;
 }
 
+esp_err_t driver_framebuffer_png(Window* window, int16_t x, int16_t y, lib_reader_read_t reader, void* reader_p)
+{
+	if (!framebuffer) {
+		ESP_LOGE(TAG, "png without alloc!");
+		return ESP_FAIL;
+	}
+	struct lib_png_reader *pr = lib_png_new(reader, reader_p);
+	if (pr == NULL) {
+		printf("Out of memory.\n");
+		return ESP_FAIL;
+	}
+	
+	esp_err_t res = driver_framebuffer_png_draw(window, x, y, pr);
+	lib_png_destroy(pr);
+	return res;
+}
+
 uint16_t driver_framebuffer_getWidth(Window* window)
 {
 	int16_t width, height;
@@ -1,8 +1,14 @@
 /*
  * The functions in this file serve as a simple way of
- * storing which area of the framebuffer needs to be
+ * storing which areas of the framebuffer need to be
  * sent to the display during the next flush
  * 
+ * Up to CONFIG_DRIVER_FRAMEBUFFER_DIRTY_REGIONS separate rectangles
+ * are tracked. A new area is merged into an existing region when
+ * that wastes little bandwidth, otherwise it gets a region of its own.
+ * When all regions are in use the two regions that grow the least when
+ * combined are merged.
+ * 
  * (This only applies to the main framebuffer and not to the compositor frames!)
  */
 
@@ -10,43 +16,156 @@
 
 #ifdef CONFIG_DRIVER_FRAMEBUFFER_ENABLE
 
+#define DIRTY_MERGE_SLACK 64 //Amount of clean pixels worth sending to save one extra transfer
+
+typedef struct {
+	int16_t x0, y0; // Top-left corner of the "dirty" area
+	int16_t x1, y1; // Bottom-right corner of the "dirty" area
+} DirtyRegion;
+
 /* Variables */
-int16_t dirty_x0 = 0,          dirty_y0 = 0;           // Top-left corner of the "dirty" area
-int16_t dirty_x1 = FB_WIDTH-1, dirty_y1 = FB_HEIGHT-1; // Bottom-right corner of the "dirty" area
+DirtyRegion dirtyRegions[DIRTY_REGIONS_MAX + 1] = {{0, 0, FB_WIDTH-1, FB_HEIGHT-1}};
+uint8_t dirtyRegionCount = 1;
+uint8_t dirtyRegionLast = 0; //The region that was extended most recently
+
+/* Private functions */
+static inline int32_t _region_area(int16_t x0, int16_t y0, int16_t x1, int16_t y1)
+{
+	return (int32_t) (x1 - x0 + 1) * (y1 - y0 + 1);
+}
+
+int32_t _region_merge_cost(DirtyRegion* a, DirtyRegion* b)
+{ //The amount of clean pixels that would be sent when merging the two regions
+	int16_t x0 = (a->x0 < b->x0) ? a->x0 : b->x0;
+	int16_t y0 = (a->y0 < b->y0) ? a->y0 : b->y0;
+	int16_t x1 = (a->x1 > b->x1) ? a->x1 : b->x1;
+	int16_t y1 = (a->y1 > b->y1) ? a->y1 : b->y1;
+	return _region_area(x0, y0, x1, y1) - _region_area(a->x0, a->y0, a->x1, a->y1) - _region_area(b->x0, b->y0, b->x1, b->y1);
+}
+
+void _region_merge(uint8_t target, uint8_t source)
+{ //Grow the target region to include the source region and remove the source region
+	DirtyRegion* a = &dirtyRegions[target];
+	DirtyRegion* b = &dirtyRegions[source];
+	if (b->x0 < a->x0) a->x0 = b->x0;
+	if (b->y0 < a->y0) a->y0 = b->y0;
+	if (b->x1 > a->x1) a->x1 = b->x1;
+	if (b->y1 > a->y1) a->y1 = b->y1;
+	dirtyRegionCount--;
+	dirtyRegions[source] = dirtyRegions[dirtyRegionCount];
+	if (target == dirtyRegionCount) target = source;
+	dirtyRegionLast = target;
+}
+
+void _region_add(DirtyRegion* region)
+{
+	//Store the area as a region of its own, this temporarily allows one region more than the maximum
+	uint8_t index = dirtyRegionCount++;
+	dirtyRegions[index] = *region;
+	
+	//Merge regions for as long as that is cheap or needed to stay within the maximum
+	while (dirtyRegionCount > 1) {
+		int32_t bestCost = INT32_MAX;
+		uint8_t bestOther = 0;
+		for (uint8_t i = 0; i < dirtyRegionCount; i++) {
+			if (i == index) continue;
+			int32_t cost = _region_merge_cost(&dirtyRegions[index], &dirtyRegions[i]);
+			if (cost < bestCost) {
+				bestCost = cost;
+				bestOther = i;
+			}
+		}
+		if (bestCost > DIRTY_MERGE_SLACK) break;
+		_region_merge(bestOther, index);
+		index = dirtyRegionLast;
+	}
+	dirtyRegionLast = index;
+	
+	if (dirtyRegionCount > DIRTY_REGIONS_MAX) {
+		//Too many regions, merge the pair of regions that wastes the least bandwidth
+		int32_t bestCost = INT32_MAX;
+		uint8_t bestA = 0, bestB = 1;
+		for (uint8_t a = 0; a < dirtyRegionCount; a++) {
+			for (uint8_t b = a + 1; b < dirtyRegionCount; b++) {
+				int32_t cost = _region_merge_cost(&dirtyRegions[a], &dirtyRegions[b]);
+				if (cost < bestCost) {
+					bestCost = cost;
+					bestA = a;
+					bestB = b;
+				}
+			}
+		}
+		_region_merge(bestA, bestB);
+	}
+}
 
 /* Public functions */
 bool driver_framebuffer_is_dirty()
 {
-	return (dirty_x1 >= dirty_x0) || (dirty_y1 >= dirty_y0);
+	return dirtyRegionCount > 0;
 }
 
 void driver_framebuffer_set_dirty_area(int16_t x0, int16_t y0, int16_t x1, int16_t y1, bool force)
 {
+	if (x0 < 0) x0 = 0;
+	if (y0 < 0) y0 = 0;
+	if (x1 > FB_WIDTH-1)  x1 = FB_WIDTH  - 1;
+	if (y1 > FB_HEIGHT-1) y1 = FB_HEIGHT - 1;
+	
 	if (force) {
-		//Just set the dirty area
-		dirty_x0 = x0;
-		dirty_y0 = y0;
-		dirty_x1 = x1;
-		dirty_y1 = y1;
-	} else {
-		//Only increase the dirty area
-		if (x0 < dirty_x0) dirty_x0 = x0;
-		if (y0 < dirty_y0) dirty_y0 = y0;
-		if (x1 > dirty_x1) dirty_x1 = x1;
-		if (y1 > dirty_y1) dirty_y1 = y1;
+		//Just set the dirty area, an empty area marks the framebuffer as clean
+		dirtyRegionCount = 0;
+		dirtyRegionLast = 0;
+	}
+	
+	if ((x0 > x1) || (y0 > y1)) return; //Empty area
+	
+	if (dirtyRegionCount > 0) {
+		//Fast path for consecutive drawing operations in the same area
+		DirtyRegion* last = &dirtyRegions[dirtyRegionLast];
+		if ((x0 >= last->x0) && (y0 >= last->y0) && (x1 <= last->x1) && (y1 <= last->y1)) return;
 	}
-	if (dirty_x0 > FB_WIDTH-1)  dirty_x0 = FB_WIDTH  - 1;
-	if (dirty_y0 > FB_HEIGHT-1) dirty_y0 = FB_HEIGHT - 1;
-	if (dirty_x1 > FB_WIDTH-1)  dirty_x1 = FB_WIDTH  - 1;
-	if (dirty_y1 > FB_HEIGHT-1) dirty_y1 = FB_HEIGHT - 1;
+	
+	DirtyRegion region = {x0, y0, x1, y1};
+	_region_add(&region);
 }
 
 void driver_framebuffer_get_dirty_area(int16_t* x0, int16_t* y0, int16_t* x1, int16_t* y1)
 {
-	*x0 = dirty_x0;
-	*y0 = dirty_y0;
-	*x1 = dirty_x1;
-	*y1 = dirty_y1;
+	if (dirtyRegionCount == 0) {
+		*x0 = FB_WIDTH-1;
+		*y0 = FB_HEIGHT-1;
+		*x1 = 0;
+		*y1 = 0;
+		return;
+	}
+	*x0 = dirtyRegions[0].x0;
+	*y0 = dirtyRegions[0].y0;
+	*x1 = dirtyRegions[0].x1;
+	*y1 = dirtyRegions[0].y1;
+	for (uint8_t i = 1; i < dirtyRegionCount; i++) {
+		if (dirtyRegions[i].x0 < *x0) *x0 = dirtyRegions[i].x0;
+		if (dirtyRegions[i].y0 < *y0) *y0 = dirtyRegions[i].y0;
+		if (dirtyRegions[i].x1 > *x1) *x1 = dirtyRegions[i].x1;
+		if (dirtyRegions[i].y1 > *y1) *y1 = dirtyRegions[i].y1;
+	}
+}
+
+uint8_t driver_framebuffer_get_dirty_region_count()
+{
+	return dirtyRegionCount;
+}
+
+void driver_framebuffer_get_dirty_region(uint8_t index, int16_t* x0, int16_t* y0, int16_t* x1, int16_t* y1)
+{
+	if (index >= dirtyRegionCount) {
+		driver_framebuffer_get_dirty_area(x0, y0, x1, y1);
+		return;
+	}
+	*x0 = dirtyRegions[index].x0;
+	*y0 = dirtyRegions[index].y0;
+	*x1 = dirtyRegions[index].x1;
+	*y1 = dirtyRegions[index].y1;
 }
 
 #endif /* CONFIG_DRIVER_FRAMEBUFFER_ENABLE */
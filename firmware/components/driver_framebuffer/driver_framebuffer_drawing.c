@@ -46,6 +46,16 @@ POSSIBILITY OF SUCH DAMAGE.
 
 void driver_framebuffer_line(Window* window, int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint32_t color)
 {
+	//Horizontal and vertical lines are drawn as a single span
+	if (y0 == y1) {
+		driver_framebuffer_hspan(window, (x0 < x1) ? x0 : x1, y0, abs(x1 - x0) + 1, color);
+		return;
+	}
+	if (x0 == x1) {
+		driver_framebuffer_vspan(window, x0, (y0 < y1) ? y0 : y1, abs(y1 - y0) + 1, color);
+		return;
+	}
+
 	int16_t steep = abs(y1 - y0) > abs(x1 - x0);
 	if (steep) {
 		_swap_int16_t(x0, y0);
@@ -87,14 +97,12 @@ void driver_framebuffer_line(Window* window, int16_t x0, int16_t y0, int16_t x1,
 void driver_framebuffer_rect(Window* window, int16_t x, int16_t y, uint16_t w, uint16_t h, bool fill, uint32_t color)
 {
 	if (fill) {
-		for (int16_t i=x; i<x+w; i++) {
-			driver_framebuffer_line(window, i, y, i, y+h-1, color);
-		}
+		driver_framebuffer_fill_rect(window, x, y, w, h, color);
 	} else {
-		driver_framebuffer_line(window, x,    y,     x+w-1, y,     color);
-		driver_framebuffer_line(window, x,    y+h-1, x+w-1, y+h-1, color);
-		driver_framebuffer_line(window, x,    y,     x,     y+h-1, color);
-		driver_framebuffer_line(window, x+w-1,y,     x+w-1, y+h-1, color);
+		driver_framebuffer_hspan(window, x,     y,     w, color);
+		driver_framebuffer_hspan(window, x,     y+h-1, w, color);
+		driver_framebuffer_vspan(window, x,     y,     h, color);
+		driver_framebuffer_vspan(window, x+w-1, y,     h, color);
 	}
 }
 
@@ -0,0 +1,266 @@
+/*
+ * The functions in this file keep recently drawn PNG images
+ * in decoded form, so that drawing the same image again only
+ * copies pixels instead of inflating and unfiltering the file.
+ *
+ * Images are stored in the native pixel format of the framebuffer
+ * together with a mask of the visible pixels when the image has
+ * an alpha channel. The least recently used images are removed
+ * when the cache grows beyond CONFIG_DRIVER_FRAMEBUFFER_PNG_CACHE_SIZE.
+ *
+ * (Only framebuffers with whole bytes per pixel are supported, other
+ * formats always decode the image.)
+ */
+
+#include "include/driver_framebuffer_internal.h"
+
+#define TAG "fb-png-cache"
+
+#ifdef CONFIG_DRIVER_FRAMEBUFFER_ENABLE
+
+#ifdef CONFIG_DRIVER_FRAMEBUFFER_PNG_CACHE_SIZE
+	#define PNG_CACHE_SIZE CONFIG_DRIVER_FRAMEBUFFER_PNG_CACHE_SIZE
+#else
+	#define PNG_CACHE_SIZE 0
+#endif
+
+#if !defined(BYTES_PER_PIXEL)
+	#undef PNG_CACHE_SIZE
+	#define PNG_CACHE_SIZE 0
+#endif
+
+typedef struct PngCacheEntry_t {
+	/* Linked list */
+	struct PngCacheEntry_t* _prevEntry; // LRU order, most recently used first
+	struct PngCacheEntry_t* _nextEntry;
+
+	/* Key */
+	char* name;
+	uint32_t size, stamp;
+
+	/* Decoded image */
+	Window image;   // Pixels in the native format, this window is not part of the window list
+	uint8_t* mask;  // A bit per pixel that is set for visible pixels, NULL if all pixels are visible
+	uint32_t bytes; // Memory used by the entry
+} PngCacheEntry;
+
+PngCacheEntry* pngCacheFirst = NULL;
+PngCacheEntry* pngCacheLast = NULL;
+uint32_t pngCacheUsed = 0; //Bytes
+uint32_t pngCacheHits = 0;
+uint32_t pngCacheMisses = 0;
+uint32_t pngCacheEntries = 0;
+
+/* Private functions */
+void _png_cache_unlink(PngCacheEntry* entry)
+{ //Remove an entry from the LRU list
+	if (entry->_prevEntry) entry->_prevEntry->_nextEntry = entry->_nextEntry;
+	if (entry->_nextEntry) entry->_nextEntry->_prevEntry = entry->_prevEntry;
+	if (pngCacheFirst == entry) pngCacheFirst = entry->_nextEntry;
+	if (pngCacheLast == entry) pngCacheLast = entry->_prevEntry;
+	entry->_prevEntry = NULL;
+	entry->_nextEntry = NULL;
+}
+
+void _png_cache_push(PngCacheEntry* entry)
+{ //Put an entry at the front of the LRU list
+	entry->_prevEntry = NULL;
+	entry->_nextEntry = pngCacheFirst;
+	if (pngCacheFirst) pngCacheFirst->_prevEntry = entry;
+	pngCacheFirst = entry;
+	if (!pngCacheLast) pngCacheLast = entry;
+}
+
+void _png_cache_free(PngCacheEntry* entry)
+{
+	free(entry->image.buffer);
+	free(entry->mask);
+	free(entry->name);
+	free(entry);
+}
+
+PngCacheEntry* _png_cache_find(const char* name, uint32_t size, uint32_t stamp)
+{
+	for (PngCacheEntry* entry = pngCacheFirst; entry != NULL; entry = entry->_nextEntry) {
+		if ((entry->size != size) || (entry->stamp != stamp)) continue;
+		if ((entry->name == NULL) != (name == NULL)) continue;
+		if (name && strcmp(entry->name, name)) continue;
+		return entry;
+	}
+	return NULL;
+}
+
+void _png_cache_remove(PngCacheEntry* entry)
+{
+	_png_cache_unlink(entry);
+	pngCacheUsed -= entry->bytes;
+	pngCacheEntries--;
+	_png_cache_free(entry);
+}
+
+void _png_cache_remove_name(const char* name)
+{ //Remove all entries with the given name
+	PngCacheEntry* entry = pngCacheFirst;
+	while (entry != NULL) {
+		PngCacheEntry* next = entry->_nextEntry;
+		if (entry->name && (strcmp(entry->name, name) == 0)) _png_cache_remove(entry);
+		entry = next;
+	}
+}
+
+#if PNG_CACHE_SIZE > 0
+esp_err_t _png_cache_decode(struct lib_png_reader* pr, const char* name, uint32_t size, uint32_t stamp, PngCacheEntry** result)
+{ //Decode an image into a new entry, leaves result NULL without reading any pixel data if the image does not fit in the cache
+	*result = NULL;
+	uint32_t width = pr->ihdr.width, height = pr->ihdr.height;
+	if ((width > 0x7FFF) || (height > 0x7FFF)) return ESP_OK;
+	uint32_t pixelBytes = width * height * BYTES_PER_PIXEL;
+	uint32_t maskBytes = (pr->ihdr.color_type & 4) ? ((width + 7) / 8) * height : 0; //Only images with an alpha channel need a mask
+	uint32_t bytes = sizeof(PngCacheEntry) + pixelBytes + maskBytes + (name ? strlen(name) + 1 : 0);
+	if (bytes > PNG_CACHE_SIZE) return ESP_OK;
+
+	PngCacheEntry* entry = calloc(1, sizeof(PngCacheEntry));
+	if (!entry) return ESP_OK;
+	entry->size  = size;
+	entry->stamp = stamp;
+	entry->bytes = bytes;
+	entry->image.width       = width;
+	entry->image.height      = height;
+	entry->image.orientation = landscape;
+	entry->image.drawWidth   = width;
+	entry->image.drawHeight  = height;
+	#ifdef CONFIG_DRIVER_FRAMEBUFFER_PNG_CACHE_SPIRAM
+		entry->image.buffer = heap_caps_malloc(pixelBytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+	#else
+		entry->image.buffer = heap_caps_malloc(pixelBytes, MALLOC_CAP_8BIT);
+	#endif
+	if (entry->image.buffer) memset(entry->image.buffer, 0, pixelBytes);
+	if (maskBytes) entry->mask = calloc(1, maskBytes);
+	if (name) entry->name = strdup(name);
+	if ((!entry->image.buffer) || (maskBytes && !entry->mask) || (name && !entry->name)) {
+		_png_cache_free(entry);
+		return ESP_OK;
+	}
+
+	pr->mask = entry->mask;
+	esp_err_t res = driver_framebuffer_png_draw(&entry->image, 0, 0, pr);
+	pr->mask = NULL;
+	if (res != ESP_OK) {
+		//The reader has been consumed, the image can't be drawn directly anymore
+		_png_cache_free(entry);
+		return res;
+	}
+
+	if (entry->mask) {
+		//Drop the mask if the alpha channel turned out to be unused
+		bool opaque = true;
+		for (uint32_t i = 0; opaque && (i < height); i++) {
+			const uint8_t* row = &entry->mask[i * ((width + 7) / 8)];
+			for (uint32_t x = 0; x < width; x++) {
+				if (!(row[x / 8] & (0x80 >> (x % 8)))) { opaque = false; break; }
+			}
+		}
+		if (opaque) {
+			free(entry->mask);
+			entry->mask = NULL;
+			entry->bytes -= maskBytes;
+		}
+	}
+	*result = entry;
+	return ESP_OK;
+}
+
+void _png_cache_render(Window* window, int16_t x, int16_t y, PngCacheEntry* entry)
+{ //Copy the visible runs of pixels of a decoded image
+	uint16_t width = entry->image.width;
+	uint32_t stride = (width + 7) / 8;
+	for (uint16_t row = 0; row < entry->image.height; row++) {
+		const uint8_t* pixels = &entry->image.buffer[row * width * BYTES_PER_PIXEL];
+		if (!entry->mask) {
+			driver_framebuffer_setPixelsNative(window, x, y + row, pixels, width);
+			continue;
+		}
+		const uint8_t* mask = &entry->mask[row * stride];
+		uint16_t i = 0;
+		while (i < width) {
+			while ((i < width) && !(mask[i / 8] & (0x80 >> (i % 8)))) i++;
+			uint16_t start = i;
+			while ((i < width) && (mask[i / 8] & (0x80 >> (i % 8)))) i++;
+			if (i > start) driver_framebuffer_setPixelsNative(window, x + start, y + row, &pixels[start * BYTES_PER_PIXEL], i - start);
+		}
+	}
+}
+#endif
+
+/* Public functions */
+bool driver_framebuffer_png_cache_draw(Window* window, int16_t x, int16_t y, const char* name, uint32_t size, uint32_t stamp)
+{
+	#if PNG_CACHE_SIZE > 0
+		PngCacheEntry* entry = _png_cache_find(name, size, stamp);
+		if (!entry) {
+			pngCacheMisses++;
+			return false;
+		}
+		if (pngCacheFirst != entry) {
+			_png_cache_unlink(entry);
+			_png_cache_push(entry);
+		}
+		pngCacheHits++;
+		_png_cache_render(window, x, y, entry);
+		return true;
+	#else
+		pngCacheMisses++;
+		return false;
+	#endif
+}
+
+esp_err_t driver_framebuffer_png_cache_load(Window* window, int16_t x, int16_t y, const char* name, uint32_t size, uint32_t stamp, lib_reader_read_t reader, void* reader_p)
+{
+	struct lib_png_reader *pr = lib_png_new(reader, reader_p);
+	if (pr == NULL) {
+		ESP_LOGE(TAG, "Out of memory.");
+		return ESP_FAIL;
+	}
+
+	#if PNG_CACHE_SIZE > 0
+		if (lib_png_read_header(pr) >= 0) {
+			PngCacheEntry* entry;
+			esp_err_t res = _png_cache_decode(pr, name, size, stamp, &entry);
+			if (res != ESP_OK) {
+				lib_png_destroy(pr);
+				return res;
+			}
+			if (entry) {
+				lib_png_destroy(pr);
+				if (name) _png_cache_remove_name(name); //Replaces an outdated version of the file
+				while (pngCacheUsed + entry->bytes > PNG_CACHE_SIZE) _png_cache_remove(pngCacheLast); //Evict the least recently used images
+				_png_cache_push(entry);
+				pngCacheUsed += entry->bytes;
+				pngCacheEntries++;
+				_png_cache_render(window, x, y, entry);
+				return ESP_OK;
+			}
+		}
+	#endif
+
+	//Not cached, decode the image straight into the framebuffer
+	esp_err_t res = driver_framebuffer_png_draw(window, x, y, pr);
+	lib_png_destroy(pr);
+	return res;
+}
+
+void driver_framebuffer_png_cache_clear()
+{
+	while (pngCacheLast) _png_cache_remove(pngCacheLast);
+}
+
+void driver_framebuffer_png_cache_stats(PngCacheStats* stats)
+{
+	stats->hits    = pngCacheHits;
+	stats->misses  = pngCacheMisses;
+	stats->entries = pngCacheEntries;
+	stats->used    = pngCacheUsed;
+	stats->size    = PNG_CACHE_SIZE;
+}
+
+#endif /* CONFIG_DRIVER_FRAMEBUFFER_ENABLE */
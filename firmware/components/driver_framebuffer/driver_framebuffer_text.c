@@ -47,7 +47,7 @@ POSSIBILITY OF SUCH DAMAGE.
 
 /* Fonts */
 
-#define FONTS_AMOUNT 14
+#define FONTS_AMOUNT 15
 
 const char* fontNames[] = {
 	"org18",
@@ -63,7 +63,8 @@ const char* fontNames[] = {
 	"roboto_regular22",       //SHA2017
 	"weather42",              //SHA2017
 	"pixelade13",             //SHA2017
-	"7x5"                     //CAMPZONE2019
+	"7x5",                    //CAMPZONE2019
+	"roboto_regular12_aa"     //Anti-aliased, 4 bits per pixel
 };
 const GFXfont* fontPointers[] = {
 	&org_018pt7b,
@@ -79,9 +80,231 @@ const GFXfont* fontPointers[] = {
 	&roboto22pt7b,
 	&weather42pt8b,
 	&roboto12pt7b, //Replaced pixelade13 with something that actually looks nice.
-	&ipane7x5
+	&ipane7x5,
+	&roboto12pt7baa4
 };
 
+/* Glyph cache */
+
+//Glyphs are drawn as a list of solid rectangles: horizontal runs of set bits,
+//scaled and merged with identical runs on the rows below. The rectangles of
+//recently used glyphs are kept in a small LRU cache, so printing the same
+//text again only costs one fill per rectangle.
+
+#ifdef CONFIG_DRIVER_FRAMEBUFFER_GLYPH_CACHE_SIZE
+	#define GLYPH_CACHE_SIZE CONFIG_DRIVER_FRAMEBUFFER_GLYPH_CACHE_SIZE
+#else
+	#define GLYPH_CACHE_SIZE 0
+#endif
+
+#define GLYPH_CACHE_BUCKETS 32
+
+typedef struct {
+	int16_t x, y;          // Position relative to the cursor
+	uint16_t width, height; // Size in pixels
+} GlyphRect;
+
+typedef struct GlyphCacheEntry_t {
+	/* Linked lists */
+	struct GlyphCacheEntry_t* _prevEntry;   // LRU order, most recently used first
+	struct GlyphCacheEntry_t* _nextEntry;
+	struct GlyphCacheEntry_t* _nextInBucket;
+	
+	/* Key */
+	const GFXfont* font;
+	uint8_t c, xScale, yScale;
+	
+	/* Rendered glyph */
+	uint16_t rectCount;
+	GlyphRect rects[];
+} GlyphCacheEntry;
+
+GlyphCacheEntry* glyphCacheBuckets[GLYPH_CACHE_BUCKETS] = {NULL};
+GlyphCacheEntry* glyphCacheFirst = NULL;
+GlyphCacheEntry* glyphCacheLast = NULL;
+uint32_t glyphCacheUsed = 0; //Bytes
+
+static inline uint8_t _glyph_cache_bucket(const GFXfont* font, uint8_t c, uint8_t xScale, uint8_t yScale)
+{
+	uint32_t hash = ((uintptr_t) font >> 2) ^ (c * 31) ^ (xScale << 3) ^ (yScale << 5);
+	return (hash ^ (hash >> 8)) % GLYPH_CACHE_BUCKETS;
+}
+
+static inline uint32_t _glyph_cache_entry_size(GlyphCacheEntry* entry)
+{
+	return sizeof(GlyphCacheEntry) + entry->rectCount * sizeof(GlyphRect);
+}
+
+void _glyph_cache_unlink(GlyphCacheEntry* entry)
+{ //Remove an entry from the LRU list
+	if (entry->_prevEntry) entry->_prevEntry->_nextEntry = entry->_nextEntry;
+	if (entry->_nextEntry) entry->_nextEntry->_prevEntry = entry->_prevEntry;
+	if (glyphCacheFirst == entry) glyphCacheFirst = entry->_nextEntry;
+	if (glyphCacheLast == entry) glyphCacheLast = entry->_prevEntry;
+	entry->_prevEntry = NULL;
+	entry->_nextEntry = NULL;
+}
+
+void _glyph_cache_push(GlyphCacheEntry* entry)
+{ //Put an entry at the front of the LRU list
+	entry->_prevEntry = NULL;
+	entry->_nextEntry = glyphCacheFirst;
+	if (glyphCacheFirst) glyphCacheFirst->_prevEntry = entry;
+	glyphCacheFirst = entry;
+	if (!glyphCacheLast) glyphCacheLast = entry;
+}
+
+void _glyph_cache_evict()
+{ //Remove the least recently used entry
+	GlyphCacheEntry* entry = glyphCacheLast;
+	if (!entry) return;
+	GlyphCacheEntry** link = &glyphCacheBuckets[_glyph_cache_bucket(entry->font, entry->c, entry->xScale, entry->yScale)];
+	while (*link && (*link != entry)) link = &(*link)->_nextInBucket;
+	if (*link) *link = entry->_nextInBucket;
+	_glyph_cache_unlink(entry);
+	glyphCacheUsed -= _glyph_cache_entry_size(entry);
+	free(entry);
+}
+
+GlyphCacheEntry* _glyph_render(const GFXfont* font, uint8_t c, uint8_t xScale, uint8_t yScale)
+{ //Convert a glyph bitmap into rectangles
+	const GFXglyph *glyph  = font->glyph + c - (uint8_t) font->first;
+	const uint8_t  *bitmap = font->bitmap;
+	
+	//Count the runs to find out how many rectangles are needed at most
+	uint16_t runs = 0;
+	uint32_t bitmapBit = glyph->bitmapOffset * 8;
+	for (uint8_t y = 0; y < glyph->height; y++) {
+		bool previous = false;
+		for (uint8_t x = 0; x < glyph->width; x++, bitmapBit++) {
+			bool set = (bitmap[bitmapBit / 8] << (bitmapBit % 8)) & 0x80;
+			if (set && !previous) runs++;
+			previous = set;
+		}
+	}
+	
+	GlyphCacheEntry* entry = malloc(sizeof(GlyphCacheEntry) + runs * sizeof(GlyphRect));
+	if (!entry) return NULL;
+	memset(entry, 0, sizeof(GlyphCacheEntry));
+	entry->font   = font;
+	entry->c      = c;
+	entry->xScale = xScale;
+	entry->yScale = yScale;
+	
+	bitmapBit = glyph->bitmapOffset * 8;
+	for (uint8_t y = 0; y < glyph->height; y++) {
+		int16_t rectY = (glyph->yOffset + y) * yScale - 1;
+		uint8_t x = 0;
+		while (x < glyph->width) {
+			//Find the next run of set bits on this row
+			while ((x < glyph->width) && !((bitmap[(bitmapBit + x) / 8] << ((bitmapBit + x) % 8)) & 0x80)) x++;
+			if (x >= glyph->width) break;
+			uint8_t start = x;
+			while ((x < glyph->width) && ((bitmap[(bitmapBit + x) / 8] << ((bitmapBit + x) % 8)) & 0x80)) x++;
+			
+			int16_t rectX = (glyph->xOffset + start) * xScale;
+			uint16_t rectWidth = (x - start) * xScale;
+			
+			//Extend the rectangle of an identical run on the row above, if there is one
+			bool merged = false;
+			for (uint16_t i = 0; i < entry->rectCount; i++) {
+				GlyphRect* rect = &entry->rects[i];
+				if ((rect->y + rect->height == rectY) && (rect->x == rectX) && (rect->width == rectWidth)) {
+					rect->height += yScale;
+					merged = true;
+					break;
+				}
+			}
+			if (!merged) {
+				GlyphRect* rect = &entry->rects[entry->rectCount++];
+				rect->x      = rectX;
+				rect->y      = rectY;
+				rect->width  = rectWidth;
+				rect->height = yScale;
+			}
+		}
+		bitmapBit += glyph->width;
+	}
+	
+	if (entry->rectCount < runs) { //Give back the space of the merged runs
+		GlyphCacheEntry* smaller = realloc(entry, _glyph_cache_entry_size(entry));
+		if (smaller) entry = smaller;
+	}
+	return entry;
+}
+
+GlyphCacheEntry* _glyph_cache_get(const GFXfont* font, uint8_t c, uint8_t xScale, uint8_t yScale, bool* cached)
+{ //Find a rendered glyph in the cache or render and add it, the caller frees the result if it did not end up in the cache
+	*cached = false;
+	uint8_t bucket = _glyph_cache_bucket(font, c, xScale, yScale);
+	if (GLYPH_CACHE_SIZE > 0) {
+		for (GlyphCacheEntry* entry = glyphCacheBuckets[bucket]; entry != NULL; entry = entry->_nextInBucket) {
+			if ((entry->font == font) && (entry->c == c) && (entry->xScale == xScale) && (entry->yScale == yScale)) {
+				if (glyphCacheFirst != entry) {
+					_glyph_cache_unlink(entry);
+					_glyph_cache_push(entry);
+				}
+				*cached = true;
+				return entry;
+			}
+		}
+	}
+	
+	GlyphCacheEntry* entry = _glyph_render(font, c, xScale, yScale);
+	if (!entry) return NULL;
+	
+	uint32_t size = _glyph_cache_entry_size(entry);
+	if (size <= GLYPH_CACHE_SIZE) {
+		while (glyphCacheUsed + size > GLYPH_CACHE_SIZE) _glyph_cache_evict();
+		entry->_nextInBucket = glyphCacheBuckets[bucket];
+		glyphCacheBuckets[bucket] = entry;
+		_glyph_cache_push(entry);
+		glyphCacheUsed += size;
+		*cached = true;
+	}
+	return entry;
+}
+
+/* Anti-aliased glyphs */
+
+static inline uint8_t _coverage(const uint8_t* data, uint32_t index, uint8_t bpp)
+{ //Read the coverage value of a pixel from a packed glyph bitmap, most significant bits first
+	uint32_t bit = index * bpp;
+	return (data[bit / 8] >> (8 - bpp - (bit % 8))) & ((1 << bpp) - 1);
+}
+
+void _print_char_aa(Window* window, const GFXglyph* glyph, const GFXfont* font, int16_t x0, int16_t y0, uint8_t xScale, uint8_t yScale, uint32_t color)
+{ //Fully covered runs are filled, partially covered pixels are blended with the background
+	const uint8_t* data = font->bitmap + glyph->bitmapOffset;
+	uint8_t bpp = font->bpp;
+	uint8_t max = (1 << bpp) - 1;
+	uint32_t index = 0;
+	for (uint8_t y = 0; y < glyph->height; y++) {
+		int16_t py = y0 + (glyph->yOffset + y) * yScale - 1;
+		uint8_t x = 0;
+		while (x < glyph->width) {
+			uint8_t coverage = _coverage(data, index + x, bpp);
+			int16_t px = x0 + (glyph->xOffset + x) * xScale;
+			if (coverage == max) {
+				uint8_t start = x;
+				while ((x < glyph->width) && (_coverage(data, index + x, bpp) == max)) x++;
+				driver_framebuffer_fill_rect(window, px, py, (x - start) * xScale, yScale, color);
+				continue;
+			}
+			if (coverage > 0) {
+				uint8_t alpha = (coverage * 255) / max;
+				for (uint8_t sy = 0; sy < yScale; sy++) {
+					for (uint8_t sx = 0; sx < xScale; sx++) {
+						driver_framebuffer_blendPixel(window, px + sx, py + sy, color, alpha);
+					}
+				}
+			}
+			x++;
+		}
+		index += glyph->width;
+	}
+}
+
 /* Private functions */
 void _print_char(Window* window, unsigned char c, int16_t x0, int16_t y0, uint8_t xScale, uint8_t yScale, uint32_t color, const GFXfont *font)
 {
@@ -90,30 +313,24 @@ void _print_char(Window* window, unsigned char c, int16_t x0, int16_t y0, uint8_
 		return;
 	}
 
-	c -= (uint8_t) font->first;
-	const GFXglyph *glyph   = font->glyph + c;
-	const uint8_t  *bitmap  = font->bitmap;
-
-	uint16_t bitmapOffset = glyph->bitmapOffset;
-	uint8_t  width        = glyph->width;
-	uint8_t  height       = glyph->height;
-	int8_t   xOffset      = glyph->xOffset;
-	int8_t   yOffset      = glyph->yOffset;
-
-	uint8_t  bit = 0, bits = 0;
-	for (uint8_t y = 0; y < height; y++) {
-		for (uint8_t x = 0; x < width; x++) {
-			if(!(bit++ & 7)) bits = bitmap[bitmapOffset++];
-			if(bits & 0x80) {
-				if (xScale == 1 && yScale == 1) {
-					driver_framebuffer_setPixel(window, x0+xOffset+x, y0+yOffset+y-1, color);
-				} else {
-					driver_framebuffer_rect(window, x0+(xOffset+x)*xScale, y0+(yOffset+y)*yScale-1, xScale, yScale, true, color);
-				}
-			}
-			bits <<= 1;
-		}
+	if (font->bpp > 1) {
+		_print_char_aa(window, font->glyph + c - (uint8_t) font->first, font, x0, y0, xScale, yScale, color);
+		return;
+	}
+
+	bool cached;
+	GlyphCacheEntry* entry = _glyph_cache_get(font, c, xScale, yScale, &cached);
+	if (!entry) {
+		ESP_LOGE(TAG, "print_char out of memory");
+		return;
+	}
+	
+	for (uint16_t i = 0; i < entry->rectCount; i++) {
+		GlyphRect* rect = &entry->rects[i];
+		driver_framebuffer_fill_rect(window, x0+rect->x, y0+rect->y, rect->width, rect->height, color);
 	}
+	
+	if (!cached) free(entry);
 }
 
 void _write(Window* window, uint8_t c, int16_t x0, int16_t *x, int16_t *y, uint8_t xScale, uint8_t yScale, uint32_t color, const GFXfont *font)
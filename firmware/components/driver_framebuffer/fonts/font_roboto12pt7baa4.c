@@ -0,0 +1,325 @@
+#include "../include/driver_framebuffer.h"
+const uint8_t roboto12pt7baa4Bitmaps[] = {
+  0xE4, 0xE4, 0xE4, 0xD4, 0xD3, 0xD3, 0x51, 0x31, 0xC4, 0x2B, 0x67, 0x2B,
+  0x66, 0x29, 0x65, 0x00, 0x09, 0x50, 0xD0, 0x00, 0x0C, 0x14, 0xA0, 0x0C,
+  0xFF, 0xFF, 0xFD, 0x00, 0x4A, 0x0A, 0x40, 0x00, 0x77, 0x0D, 0x10, 0x4F,
+  0xFF, 0xFF, 0xF5, 0x00, 0xC1, 0x3A, 0x00, 0x00, 0xD0, 0x68, 0x00, 0x02,
+  0xB0, 0x95, 0x00, 0x00, 0x04, 0x20, 0x00, 0x00, 0xA4, 0x00, 0x02, 0xBF,
+  0xE7, 0x00, 0xB9, 0x14, 0xF3, 0x0E, 0x40, 0x0A, 0x70, 0x9C, 0x40, 0x00,
+  0x00, 0x8E, 0xD6, 0x00, 0x00, 0x06, 0xE5, 0x3C, 0x00, 0x09, 0x91, 0xE6,
+  0x13, 0xD6, 0x04, 0xCF, 0xE8, 0x00, 0x00, 0xC2, 0x00, 0x00, 0x03, 0x00,
+  0x00, 0x0A, 0xEB, 0x10, 0x00, 0x04, 0xB1, 0x96, 0x09, 0x20, 0x4B, 0x19,
+  0x65, 0x90, 0x00, 0xAE, 0xB2, 0xC1, 0x00, 0x00, 0x00, 0xA4, 0x00, 0x00,
+  0x00, 0x68, 0x4D, 0xE5, 0x00, 0x2C, 0x0C, 0x42, 0xD0, 0x08, 0x30, 0xC4,
+  0x2D, 0x00, 0x00, 0x04, 0xDE, 0x50, 0x01, 0xBE, 0xD4, 0x00, 0x00, 0x7C,
+  0x16, 0xC0, 0x00, 0x08, 0xB0, 0x6B, 0x00, 0x00, 0x2E, 0xAC, 0x20, 0x00,
+  0x03, 0xDF, 0x40, 0x11, 0x01, 0xE5, 0x5E, 0x2A, 0x60, 0x5D, 0x00, 0x7D,
+  0xE2, 0x02, 0xE5, 0x13, 0xED, 0x00, 0x04, 0xCE, 0xD7, 0xBA, 0x00, 0x59,
+  0x58, 0x57, 0x00, 0x0A, 0x10, 0x09, 0x70, 0x03, 0xD0, 0x00, 0xA7, 0x00,
+  0x0E, 0x30, 0x01, 0xF1, 0x00, 0x2F, 0x00, 0x01, 0xF2, 0x00, 0x0E, 0x30,
+  0x00, 0xA7, 0x00, 0x03, 0xD0, 0x00, 0x09, 0x70, 0x00, 0x0A, 0x10, 0x83,
+  0x00, 0x2D, 0x20, 0x07, 0xA0, 0x01, 0xF2, 0x00, 0xC5, 0x00, 0xA8, 0x00,
+  0x99, 0x00, 0xA8, 0x00, 0xC5, 0x01, 0xF2, 0x06, 0xA0, 0x2D, 0x20, 0x83,
+  0x00, 0x00, 0xA4, 0x00, 0x77, 0xB7, 0x93, 0x26, 0xFC, 0x40, 0x0A, 0x7D,
+  0x30, 0x18, 0x04, 0x50, 0x00, 0x0A, 0x30, 0x00, 0x00, 0xE4, 0x00, 0x00,
+  0x0E, 0x40, 0x08, 0xFF, 0xFF, 0xFC, 0x12, 0x2E, 0x52, 0x10, 0x00, 0xE4,
+  0x00, 0x00, 0x0E, 0x40, 0x00, 0x00, 0x00, 0x00, 0x16, 0x3E, 0x5C, 0x94,
+  0xCF, 0xF5, 0x04, 0x10, 0xD4, 0x00, 0x03, 0xC0, 0x00, 0x96, 0x00, 0x1E,
+  0x10, 0x06, 0x90, 0x00, 0xC4, 0x00, 0x2D, 0x00, 0x08, 0x70, 0x00, 0xD2,
+  0x00, 0x5B, 0x00, 0x0B, 0x50, 0x00, 0x02, 0xBE, 0xD5, 0x00, 0xC8, 0x14,
+  0xF2, 0x2F, 0x10, 0x0B, 0x63, 0xE0, 0x00, 0x98, 0x4E, 0x00, 0x09, 0x84,
+  0xE0, 0x00, 0x98, 0x2F, 0x10, 0x0B, 0x60, 0xC8, 0x14, 0xF2, 0x02, 0xBE,
+  0xD5, 0x00, 0x26, 0xB9, 0xD9, 0xB9, 0x00, 0x89, 0x00, 0x89, 0x00, 0x89,
+  0x00, 0x89, 0x00, 0x89, 0x00, 0x89, 0x00, 0x89, 0x04, 0xCE, 0xD6, 0x01,
+  0xE5, 0x14, 0xF3, 0x4B, 0x00, 0x0C, 0x50, 0x00, 0x02, 0xE2, 0x00, 0x01,
+  0xC7, 0x00, 0x00, 0xB9, 0x00, 0x00, 0xAA, 0x00, 0x00, 0xAA, 0x00, 0x00,
+  0x3F, 0xFF, 0xFF, 0xC0, 0x04, 0xCE, 0xD5, 0x01, 0xE5, 0x14, 0xE1, 0x27,
+  0x00, 0x0E, 0x40, 0x00, 0x06, 0xE1, 0x00, 0x8F, 0xF5, 0x00, 0x00, 0x04,
+  0xE3, 0x37, 0x00, 0x0C, 0x62, 0xE5, 0x04, 0xE3, 0x05, 0xCE, 0xD5, 0x00,
+  0x00, 0x00, 0xDB, 0x00, 0x00, 0x08, 0xEB, 0x00, 0x00, 0x3D, 0x8B, 0x00,
+  0x00, 0xC5, 0x7B, 0x00, 0x07, 0xA0, 0x7B, 0x00, 0x3D, 0x10, 0x7B, 0x00,
+  0x9F, 0xFF, 0xFF, 0xF0, 0x00, 0x00, 0x7B, 0x00, 0x00, 0x00, 0x7B, 0x00,
+  0x04, 0xFF, 0xFF, 0x80, 0x6B, 0x11, 0x11, 0x07, 0x90, 0x00, 0x00, 0x9D,
+  0xEE, 0x80, 0x05, 0x71, 0x3D, 0x60, 0x00, 0x00, 0x7B, 0x08, 0x10, 0x07,
+  0xB0, 0xA9, 0x12, 0xD6, 0x01, 0xAE, 0xE8, 0x00, 0x00, 0x3B, 0xE6, 0x00,
+  0x3E, 0x72, 0x00, 0x0B, 0x70, 0x00, 0x00, 0xF9, 0xEE, 0x80, 0x2F, 0x91,
+  0x3E, 0x52, 0xF1, 0x00, 0x89, 0x0F, 0x20, 0x08, 0x90, 0xAB, 0x13, 0xE4,
+  0x01, 0xAE, 0xD7, 0x00, 0x8F, 0xFF, 0xFF, 0xB0, 0x00, 0x00, 0xB5, 0x00,
+  0x00, 0x3D, 0x00, 0x00, 0x0B, 0x70, 0x00, 0x03, 0xE1, 0x00, 0x00, 0xA8,
+  0x00, 0x00, 0x2E, 0x10, 0x00, 0x09, 0x90, 0x00, 0x02, 0xF2, 0x00, 0x00,
+  0x03, 0xBE, 0xD5, 0x00, 0xD8, 0x14, 0xF2, 0x1F, 0x20, 0x0D, 0x50, 0xC8,
+  0x14, 0xE2, 0x02, 0xEF, 0xF6, 0x01, 0xD6, 0x13, 0xE4, 0x4E, 0x00, 0x09,
+  0x81, 0xE5, 0x03, 0xD5, 0x04, 0xCE, 0xD7, 0x00, 0x04, 0xCE, 0xC3, 0x01,
+  0xE6, 0x17, 0xD0, 0x4D, 0x00, 0x0D, 0x45, 0xD0, 0x00, 0xB6, 0x1E, 0x61,
+  0x5F, 0x60, 0x5D, 0xE9, 0xD5, 0x00, 0x00, 0x2E, 0x10, 0x01, 0x4C, 0x80,
+  0x01, 0xFC, 0x70, 0x00, 0x0D, 0x40, 0x41, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x41, 0x0D, 0x40, 0x0D, 0x40, 0x41, 0x00, 0x00, 0x00, 0x00, 0x01, 0x60,
+  0x3E, 0x05, 0xC0, 0x94, 0x00, 0x00, 0x01, 0x78, 0x01, 0x7E, 0xC4, 0x5E,
+  0xA3, 0x00, 0x5E, 0x93, 0x00, 0x01, 0x7E, 0xC4, 0x00, 0x01, 0x78, 0x0F,
+  0xFF, 0xFF, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF,
+  0xF4, 0x00, 0x00, 0x00, 0x00, 0x2A, 0x30, 0x00, 0x01, 0x8E, 0xC5, 0x00,
+  0x00, 0x05, 0xBC, 0x20, 0x00, 0x6C, 0xD2, 0x18, 0xEC, 0x50, 0x02, 0xA3,
+  0x00, 0x00, 0x08, 0xEE, 0xA1, 0x5E, 0x32, 0xC7, 0x23, 0x00, 0x99, 0x00,
+  0x02, 0xE4, 0x00, 0x2D, 0x70, 0x00, 0x9A, 0x00, 0x00, 0x43, 0x00, 0x00,
+  0x21, 0x00, 0x00, 0xA7, 0x00, 0x00, 0x04, 0xAE, 0xEC, 0x70, 0x00, 0x00,
+  0x6D, 0x51, 0x03, 0x9B, 0x00, 0x03, 0xC1, 0x00, 0x00, 0x08, 0x60, 0x0A,
+  0x40, 0x3C, 0xEA, 0x01, 0xB0, 0x1D, 0x00, 0xD5, 0x1E, 0x00, 0xC0, 0x3B,
+  0x05, 0xB0, 0x0D, 0x00, 0xC0, 0x3A, 0x07, 0x80, 0x2C, 0x00, 0xC0, 0x3B,
+  0x06, 0xB1, 0x9C, 0x05, 0x90, 0x0E, 0x11, 0xCE, 0x6A, 0xDA, 0x10, 0x09,
+  0x80, 0x00, 0x00, 0x00, 0x00, 0x01, 0xC9, 0x30, 0x15, 0x00, 0x00, 0x00,
+  0x18, 0xDE, 0xD9, 0x00, 0x00, 0x00, 0x00, 0xBB, 0x00, 0x00, 0x00, 0x02,
+  0xEE, 0x20, 0x00, 0x00, 0x08, 0xAA, 0x80, 0x00, 0x00, 0x0D, 0x44, 0xE0,
+  0x00, 0x00, 0x4E, 0x00, 0xE5, 0x00, 0x00, 0xA9, 0x00, 0x9B, 0x00, 0x01,
+  0xFF, 0xFF, 0xFF, 0x20, 0x07, 0xD0, 0x00, 0x0D, 0x70, 0x0D, 0x60, 0x00,
+  0x06, 0xD0, 0xEF, 0xFE, 0xB3, 0x0E, 0x40, 0x18, 0xD0, 0xE4, 0x00, 0x2F,
+  0x1E, 0x40, 0x19, 0xC0, 0xEF, 0xFF, 0xF4, 0x0E, 0x40, 0x05, 0xE2, 0xE4,
+  0x00, 0x0E, 0x5E, 0x40, 0x06, 0xF2, 0xEF, 0xFF, 0xC5, 0x00, 0x00, 0x7D,
+  0xEC, 0x50, 0x08, 0xD4, 0x14, 0xE5, 0x1E, 0x40, 0x00, 0x8B, 0x3F, 0x10,
+  0x00, 0x01, 0x4F, 0x00, 0x00, 0x00, 0x2F, 0x10, 0x00, 0x01, 0x0E, 0x40,
+  0x00, 0x8B, 0x07, 0xD3, 0x14, 0xE5, 0x00, 0x7D, 0xFC, 0x50, 0xEF, 0xFE,
+  0x91, 0x0E, 0x40, 0x2A, 0xD1, 0xE4, 0x00, 0x0C, 0x6E, 0x40, 0x00, 0x8A,
+  0xE4, 0x00, 0x07, 0xBE, 0x40, 0x00, 0x8A, 0xE4, 0x00, 0x0D, 0x7E, 0x40,
+  0x2A, 0xD1, 0xEF, 0xFD, 0x91, 0x00, 0xEF, 0xFF, 0xFD, 0xE4, 0x00, 0x00,
+  0xE4, 0x00, 0x00, 0xE4, 0x00, 0x00, 0xEF, 0xFF, 0xF4, 0xE4, 0x00, 0x00,
+  0xE4, 0x00, 0x00, 0xE4, 0x00, 0x00, 0xEF, 0xFF, 0xFE, 0xEF, 0xFF, 0xFC,
+  0xE4, 0x00, 0x00, 0xE4, 0x00, 0x00, 0xE4, 0x00, 0x00, 0xEF, 0xFF, 0xF3,
+  0xE4, 0x00, 0x00, 0xE4, 0x00, 0x00, 0xE4, 0x00, 0x00, 0xE4, 0x00, 0x00,
+  0x00, 0x7D, 0xFD, 0x60, 0x07, 0xD4, 0x14, 0xE6, 0x0E, 0x50, 0x00, 0x6A,
+  0x2F, 0x10, 0x00, 0x00, 0x3F, 0x00, 0x7F, 0xFD, 0x2F, 0x10, 0x00, 0x5D,
+  0x0E, 0x60, 0x00, 0x5D, 0x06, 0xE5, 0x12, 0xAC, 0x00, 0x6C, 0xFE, 0xA2,
+  0xE4, 0x00, 0x01, 0xF3, 0xE4, 0x00, 0x01, 0xF3, 0xE4, 0x00, 0x01, 0xF3,
+  0xE4, 0x00, 0x01, 0xF3, 0xEF, 0xFF, 0xFF, 0xF3, 0xE4, 0x00, 0x01, 0xF3,
+  0xE4, 0x00, 0x01, 0xF3, 0xE4, 0x00, 0x01, 0xF3, 0xE4, 0x00, 0x01, 0xF3,
+  0xD6, 0xD6, 0xD6, 0xD6, 0xD6, 0xD6, 0xD6, 0xD6, 0xD6, 0x00, 0x00, 0x1F,
+  0x30, 0x00, 0x01, 0xF3, 0x00, 0x00, 0x1F, 0x30, 0x00, 0x01, 0xF3, 0x00,
+  0x00, 0x1F, 0x30, 0x00, 0x01, 0xF3, 0x66, 0x00, 0x2F, 0x26, 0xD3, 0x19,
+  0xD0, 0x08, 0xDE, 0xB3, 0x00, 0xE4, 0x00, 0x2E, 0x60, 0xE4, 0x01, 0xD7,
+  0x00, 0xE4, 0x0B, 0x90, 0x00, 0xE5, 0xAA, 0x00, 0x00, 0xEC, 0xBA, 0x00,
+  0x00, 0xE8, 0x0C, 0x60, 0x00, 0xE4, 0x02, 0xE3, 0x00, 0xE4, 0x00, 0x6D,
+  0x10, 0xE4, 0x00, 0x0A, 0xB0, 0xE4, 0x00, 0x00, 0xE4, 0x00, 0x00, 0xE4,
+  0x00, 0x00, 0xE4, 0x00, 0x00, 0xE4, 0x00, 0x00, 0xE4, 0x00, 0x00, 0xE4,
+  0x00, 0x00, 0xE4, 0x00, 0x00, 0xEF, 0xFF, 0xFA, 0xED, 0x00, 0x00, 0x08,
+  0xF4, 0xEF, 0x40, 0x00, 0x0E, 0xF4, 0xEB, 0xA0, 0x00, 0x5D, 0xD4, 0xE5,
+  0xF2, 0x00, 0xB6, 0xD4, 0xE4, 0xA7, 0x02, 0xE1, 0xE4, 0xE4, 0x4D, 0x09,
+  0x90, 0xE4, 0xE4, 0x0D, 0x5E, 0x30, 0xE4, 0xE4, 0x06, 0xEB, 0x00, 0xE4,
+  0xE4, 0x01, 0xE5, 0x00, 0xE4, 0x2F, 0x60, 0x00, 0x4F, 0x2F, 0xE2, 0x00,
+  0x4F, 0x2F, 0xBB, 0x00, 0x4F, 0x2F, 0x2D, 0x70, 0x4F, 0x2F, 0x14, 0xE2,
+  0x4F, 0x2F, 0x10, 0x9C, 0x4F, 0x2F, 0x10, 0x1D, 0xAF, 0x2F, 0x10, 0x04,
+  0xFF, 0x2F, 0x10, 0x00, 0x9F, 0x00, 0x6D, 0xFD, 0x60, 0x00, 0x7E, 0x41,
+  0x5E, 0x60, 0x0E, 0x50, 0x00, 0x6D, 0x03, 0xF1, 0x00, 0x02, 0xF2, 0x4F,
+  0x00, 0x00, 0x1F, 0x33, 0xF1, 0x00, 0x02, 0xF2, 0x0E, 0x50, 0x00, 0x6D,
+  0x00, 0x7D, 0x41, 0x4E, 0x60, 0x00, 0x6D, 0xFD, 0x60, 0x00, 0x0F, 0xFF,
+  0xFD, 0x60, 0x0F, 0x30, 0x04, 0xE5, 0x0F, 0x30, 0x00, 0xA8, 0x0F, 0x30,
+  0x03, 0xE5, 0x0F, 0xFF, 0xFD, 0x70, 0x0F, 0x30, 0x00, 0x00, 0x0F, 0x30,
+  0x00, 0x00, 0x0F, 0x30, 0x00, 0x00, 0x0F, 0x30, 0x00, 0x00, 0x00, 0x6D,
+  0xFC, 0x50, 0x00, 0x7D, 0x41, 0x5E, 0x60, 0x0E, 0x50, 0x00, 0x6D, 0x03,
+  0xF1, 0x00, 0x02, 0xF1, 0x4E, 0x00, 0x00, 0x1F, 0x23, 0xF0, 0x00, 0x02,
+  0xF1, 0x1E, 0x40, 0x00, 0x6D, 0x00, 0x7D, 0x41, 0x5E, 0x60, 0x00, 0x7D,
+  0xFE, 0xC1, 0x00, 0x00, 0x00, 0x1B, 0xC0, 0x00, 0x00, 0x00, 0x03, 0x00,
+  0xEF, 0xFE, 0xC4, 0x0E, 0x40, 0x16, 0xF2, 0xE4, 0x00, 0x0E, 0x5E, 0x40,
+  0x16, 0xF2, 0xEF, 0xFF, 0xD4, 0x0E, 0x40, 0x4E, 0x10, 0xE4, 0x00, 0xC8,
+  0x0E, 0x40, 0x04, 0xE1, 0xE4, 0x00, 0x0C, 0x80, 0x02, 0xAE, 0xEB, 0x20,
+  0x0C, 0x91, 0x18, 0xE1, 0x0F, 0x40, 0x00, 0xB3, 0x0A, 0xD5, 0x10, 0x00,
+  0x00, 0x6C, 0xFA, 0x30, 0x00, 0x00, 0x29, 0xE1, 0x3C, 0x00, 0x00, 0xE5,
+  0x1D, 0x81, 0x15, 0xF2, 0x02, 0xAE, 0xEC, 0x40, 0xAF, 0xFF, 0xFF, 0xF7,
+  0x00, 0x0B, 0x70, 0x00, 0x00, 0x0B, 0x70, 0x00, 0x00, 0x0B, 0x70, 0x00,
+  0x00, 0x0B, 0x70, 0x00, 0x00, 0x0B, 0x70, 0x00, 0x00, 0x0B, 0x70, 0x00,
+  0x00, 0x0B, 0x70, 0x00, 0x00, 0x0B, 0x70, 0x00, 0x5D, 0x00, 0x00, 0xD5,
+  0x5D, 0x00, 0x00, 0xD5, 0x5D, 0x00, 0x00, 0xD5, 0x5D, 0x00, 0x00, 0xD5,
+  0x5D, 0x00, 0x00, 0xD5, 0x5D, 0x00, 0x00, 0xD5, 0x4E, 0x00, 0x00, 0xE4,
+  0x1D, 0x81, 0x18, 0xD1, 0x02, 0xBE, 0xEA, 0x20, 0xC8, 0x00, 0x00, 0x8C,
+  0x6D, 0x00, 0x00, 0xD6, 0x1E, 0x40, 0x04, 0xF1, 0x09, 0x90, 0x09, 0xA0,
+  0x04, 0xE0, 0x0E, 0x40, 0x00, 0xD5, 0x5D, 0x00, 0x00, 0x7A, 0xA8, 0x00,
+  0x00, 0x2E, 0xE2, 0x00, 0x00, 0x0B, 0xB0, 0x00, 0x7B, 0x00, 0x0C, 0x70,
+  0x01, 0xF2, 0x4E, 0x00, 0x2F, 0xC0, 0x05, 0xD0, 0x0E, 0x30, 0x6A, 0xE1,
+  0x08, 0x90, 0x0B, 0x70, 0xA6, 0xA5, 0x0C, 0x60, 0x07, 0xA0, 0xE1, 0x6A,
+  0x1F, 0x20, 0x04, 0xE4, 0xC0, 0x2E, 0x4D, 0x00, 0x00, 0xFA, 0x70, 0x0C,
+  0xAA, 0x00, 0x00, 0xBF, 0x30, 0x08, 0xF6, 0x00, 0x00, 0x8D, 0x00, 0x04,
+  0xF2, 0x00, 0x4F, 0x30, 0x01, 0xE6, 0x09, 0xC0, 0x0A, 0xB0, 0x01, 0xD7,
+  0x4E, 0x20, 0x00, 0x4F, 0xE7, 0x00, 0x00, 0x0C, 0xE0, 0x00, 0x00, 0x5E,
+  0xD7, 0x00, 0x01, 0xE6, 0x4F, 0x30, 0x0A, 0xC0, 0x09, 0xC0, 0x5F, 0x20,
+  0x01, 0xE7, 0x9B, 0x00, 0x01, 0xE6, 0x2E, 0x40, 0x08, 0xC0, 0x07, 0xC0,
+  0x1E, 0x40, 0x01, 0xD5, 0x9B, 0x00, 0x00, 0x5D, 0xE2, 0x00, 0x00, 0x0C,
+  0x90, 0x00, 0x00, 0x0B, 0x80, 0x00, 0x00, 0x0B, 0x80, 0x00, 0x00, 0x0B,
+  0x80, 0x00, 0x6F, 0xFF, 0xFF, 0xF1, 0x00, 0x00, 0x0B, 0xA0, 0x00, 0x00,
+  0x7D, 0x10, 0x00, 0x03, 0xE3, 0x00, 0x00, 0x1D, 0x70, 0x00, 0x00, 0x9B,
+  0x00, 0x00, 0x05, 0xE2, 0x00, 0x00, 0x2E, 0x50, 0x00, 0x00, 0x7F, 0xFF,
+  0xFF, 0xF4, 0x1F, 0xF5, 0x1F, 0x20, 0x1F, 0x20, 0x1F, 0x20, 0x1F, 0x20,
+  0x1F, 0x20, 0x1F, 0x20, 0x1F, 0x20, 0x1F, 0x20, 0x1F, 0x20, 0x1F, 0x20,
+  0x1F, 0x20, 0x1F, 0xF5, 0x88, 0x00, 0x00, 0x3E, 0x00, 0x00, 0x0C, 0x50,
+  0x00, 0x06, 0xB0, 0x00, 0x01, 0xE2, 0x00, 0x00, 0x97, 0x00, 0x00, 0x4D,
+  0x00, 0x00, 0x0D, 0x40, 0x00, 0x07, 0xA0, 0x00, 0x01, 0xE1, 0xEF, 0x70,
+  0xB7, 0x0B, 0x70, 0xB7, 0x0B, 0x70, 0xB7, 0x0B, 0x70, 0xB7, 0x0B, 0x70,
+  0xB7, 0x0B, 0x70, 0xB7, 0xEF, 0x70, 0x02, 0xF2, 0x00, 0xAE, 0x90, 0x2E,
+  0x2E, 0x19, 0x80, 0x88, 0xFF, 0xFF, 0xFD, 0x4E, 0x30, 0x06, 0xA0, 0x03,
+  0xCF, 0xC4, 0x01, 0xE5, 0x17, 0xE0, 0x02, 0x00, 0x2F, 0x10, 0x6C, 0xFF,
+  0xF1, 0x3E, 0x40, 0x1F, 0x14, 0xE3, 0x18, 0xF2, 0x08, 0xEE, 0x7F, 0x30,
+  0x4E, 0x00, 0x00, 0x04, 0xE0, 0x00, 0x00, 0x4E, 0x00, 0x00, 0x04, 0xE8,
+  0xED, 0x50, 0x4F, 0x61, 0x5F, 0x24, 0xE0, 0x00, 0xB7, 0x4E, 0x00, 0x0A,
+  0x84, 0xE0, 0x00, 0xC7, 0x4F, 0x61, 0x5F, 0x24, 0xD8, 0xED, 0x50, 0x02,
+  0xBE, 0xD6, 0x00, 0xD8, 0x14, 0xE3, 0x3E, 0x00, 0x05, 0x35, 0xD0, 0x00,
+  0x00, 0x3E, 0x00, 0x03, 0x20, 0xC8, 0x13, 0xE3, 0x02, 0xBE, 0xD5, 0x00,
+  0x00, 0x00, 0x0E, 0x40, 0x00, 0x00, 0xE4, 0x00, 0x00, 0x0E, 0x40, 0x5D,
+  0xE9, 0xE4, 0x2F, 0x51, 0x6F, 0x47, 0xB0, 0x00, 0xE4, 0x8A, 0x00, 0x0E,
+  0x46, 0xB0, 0x00, 0xE4, 0x2F, 0x51, 0x7F, 0x40, 0x5D, 0xE9, 0xE4, 0x02,
+  0xBE, 0xD4, 0x00, 0xC8, 0x15, 0xE1, 0x3E, 0x00, 0x0C, 0x55, 0xFF, 0xFF,
+  0xF7, 0x3E, 0x00, 0x00, 0x00, 0xC8, 0x12, 0xA2, 0x02, 0xBE, 0xE8, 0x00,
+  0x00, 0x7E, 0xB0, 0x2F, 0x30, 0x04, 0xE0, 0x05, 0xFF, 0xF6, 0x04, 0xE0,
+  0x00, 0x4E, 0x00, 0x04, 0xE0, 0x00, 0x4E, 0x00, 0x04, 0xE0, 0x00, 0x4E,
+  0x00, 0x05, 0xDE, 0x9D, 0x42, 0xF6, 0x16, 0xF4, 0x6C, 0x00, 0x0E, 0x48,
+  0xA0, 0x00, 0xE4, 0x6C, 0x00, 0x0E, 0x41, 0xF5, 0x16, 0xF4, 0x05, 0xDE,
+  0x9E, 0x40, 0x00, 0x00, 0xF3, 0x1C, 0x31, 0x8D, 0x00, 0x5D, 0xEB, 0x30,
+  0x3F, 0x00, 0x00, 0x03, 0xF0, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x03, 0xF7,
+  0xDE, 0x70, 0x3F, 0x81, 0x5F, 0x13, 0xF0, 0x00, 0xF3, 0x3F, 0x00, 0x0F,
+  0x33, 0xF0, 0x00, 0xF3, 0x3F, 0x00, 0x0F, 0x33, 0xF0, 0x00, 0xF3, 0x04,
+  0x01, 0xE2, 0x00, 0x01, 0xF2, 0x1F, 0x21, 0xF2, 0x1F, 0x21, 0xF2, 0x1F,
+  0x21, 0xF2, 0x00, 0x40, 0x02, 0xE1, 0x00, 0x00, 0x02, 0xF1, 0x02, 0xF1,
+  0x02, 0xF1, 0x02, 0xF1, 0x02, 0xF1, 0x02, 0xF1, 0x02, 0xF1, 0x02, 0xF1,
+  0x04, 0xF0, 0x6E, 0x70, 0x2F, 0x10, 0x00, 0x02, 0xF1, 0x00, 0x00, 0x2F,
+  0x10, 0x00, 0x02, 0xF1, 0x09, 0xC1, 0x2F, 0x17, 0xC1, 0x02, 0xF5, 0xD2,
+  0x00, 0x2F, 0xBD, 0x10, 0x02, 0xF1, 0x7B, 0x00, 0x2F, 0x10, 0xC7, 0x02,
+  0xF1, 0x02, 0xE3, 0x0F, 0x30, 0xF3, 0x0F, 0x30, 0xF3, 0x0F, 0x30, 0xF3,
+  0x0F, 0x30, 0xF3, 0x0F, 0x30, 0xF3, 0x5D, 0x9E, 0xE5, 0x7E, 0xE8, 0x05,
+  0xF5, 0x17, 0xF9, 0x13, 0xF2, 0x5D, 0x00, 0x1F, 0x20, 0x0D, 0x55, 0xD0,
+  0x01, 0xF1, 0x00, 0xD5, 0x5D, 0x00, 0x1F, 0x10, 0x0D, 0x55, 0xD0, 0x01,
+  0xF1, 0x00, 0xD5, 0x5D, 0x00, 0x1F, 0x10, 0x0D, 0x50, 0x3E, 0x7D, 0xE7,
+  0x03, 0xF8, 0x15, 0xF1, 0x3F, 0x00, 0x0F, 0x33, 0xF0, 0x00, 0xF3, 0x3F,
+  0x00, 0x0F, 0x33, 0xF0, 0x00, 0xF3, 0x3F, 0x00, 0x0F, 0x30, 0x04, 0xCE,
+  0xC4, 0x02, 0xE6, 0x16, 0xE2, 0x7B, 0x00, 0x0B, 0x79, 0x90, 0x00, 0x99,
+  0x7B, 0x00, 0x0B, 0x72, 0xE5, 0x15, 0xE2, 0x04, 0xCE, 0xC4, 0x00, 0x4D,
+  0x9E, 0xD5, 0x04, 0xF6, 0x16, 0xF2, 0x4E, 0x00, 0x0C, 0x64, 0xE0, 0x00,
+  0xA8, 0x4E, 0x00, 0x0C, 0x64, 0xF6, 0x16, 0xF2, 0x4E, 0x9E, 0xD5, 0x04,
+  0xE0, 0x00, 0x00, 0x4E, 0x00, 0x00, 0x04, 0xE0, 0x00, 0x00, 0x05, 0xDE,
+  0x9E, 0x32, 0xF5, 0x16, 0xF3, 0x7B, 0x00, 0x0F, 0x39, 0x90, 0x00, 0xF3,
+  0x7B, 0x00, 0x0F, 0x32, 0xF5, 0x16, 0xF3, 0x05, 0xDE, 0x9F, 0x30, 0x00,
+  0x00, 0xF3, 0x00, 0x00, 0x0F, 0x30, 0x00, 0x00, 0xF3, 0x4D, 0xAE, 0x04,
+  0xF7, 0x30, 0x4D, 0x00, 0x04, 0xD0, 0x00, 0x4D, 0x00, 0x04, 0xD0, 0x00,
+  0x4D, 0x00, 0x00, 0x03, 0xCE, 0xC4, 0x00, 0xD6, 0x06, 0xE1, 0x0D, 0x92,
+  0x02, 0x00, 0x2A, 0xED, 0x50, 0x13, 0x00, 0x4F, 0x21, 0xF5, 0x14, 0xF1,
+  0x04, 0xDF, 0xD5, 0x00, 0x00, 0xC5, 0x00, 0x0C, 0x50, 0x1F, 0xFF, 0xA0,
+  0x0C, 0x50, 0x00, 0xC5, 0x00, 0x0C, 0x50, 0x00, 0xC5, 0x00, 0x0C, 0x80,
+  0x00, 0x5E, 0x90, 0x3E, 0x00, 0x0F, 0x33, 0xE0, 0x00, 0xF3, 0x3E, 0x00,
+  0x0F, 0x33, 0xE0, 0x00, 0xF3, 0x3F, 0x00, 0x0F, 0x31, 0xF5, 0x17, 0xF3,
+  0x06, 0xEE, 0x9E, 0x30, 0xC6, 0x00, 0x7B, 0x6B, 0x00, 0xC6, 0x1F, 0x11,
+  0xE1, 0x0B, 0x66, 0xA0, 0x05, 0xBB, 0x50, 0x01, 0xEE, 0x00, 0x00, 0xA9,
+  0x00, 0x7A, 0x00, 0xA9, 0x00, 0xB6, 0x3E, 0x00, 0xED, 0x00, 0xE2, 0x0E,
+  0x34, 0xBC, 0x33, 0xD0, 0x09, 0x79, 0x67, 0x87, 0x90, 0x05, 0xBD, 0x12,
+  0xCB, 0x40, 0x01, 0xFC, 0x00, 0xDE, 0x10, 0x00, 0xC7, 0x00, 0x8B, 0x00,
+  0x5E, 0x10, 0x9B, 0x00, 0xB8, 0x3E, 0x20, 0x02, 0xEC, 0x70, 0x00, 0x09,
+  0xE1, 0x00, 0x02, 0xEC, 0x80, 0x00, 0xB8, 0x2E, 0x30, 0x6D, 0x10, 0x8C,
+  0x00, 0xC8, 0x00, 0x7B, 0x6C, 0x00, 0xC6, 0x1F, 0x21, 0xF1, 0x0B, 0x76,
+  0xB0, 0x05, 0xCA, 0x60, 0x01, 0xEE, 0x10, 0x00, 0xAB, 0x00, 0x00, 0xA6,
+  0x00, 0x04, 0xE1, 0x00, 0x8E, 0x50, 0x00, 0x6F, 0xFF, 0xFC, 0x00, 0x00,
+  0x2E, 0x50, 0x00, 0x0B, 0x90, 0x00, 0x08, 0xC1, 0x00, 0x04, 0xE2, 0x00,
+  0x01, 0xE6, 0x00, 0x00, 0x7F, 0xFF, 0xFF, 0x00, 0x00, 0x4C, 0x00, 0x1E,
+  0x30, 0x05, 0xC0, 0x00, 0x6C, 0x00, 0x06, 0xB0, 0x01, 0xB8, 0x00, 0xBE,
+  0x20, 0x01, 0xA9, 0x00, 0x06, 0xB0, 0x00, 0x6C, 0x00, 0x03, 0xE1, 0x00,
+  0x05, 0xB0, 0xD1, 0xD1, 0xD1, 0xD1, 0xD1, 0xD1, 0xD1, 0xD1, 0xD1, 0xD1,
+  0xD1, 0x0C, 0x30, 0x00, 0x3E, 0x10, 0x00, 0xD5, 0x00, 0x0C, 0x60, 0x00,
+  0xC6, 0x00, 0x09, 0xB1, 0x00, 0x2E, 0xB0, 0x09, 0xA1, 0x00, 0xC6, 0x00,
+  0x0C, 0x50, 0x02, 0xE2, 0x00, 0xB5, 0x00, 0x06, 0xEE, 0x92, 0x2C, 0x00,
+  0xC3, 0x29, 0xEE, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+const GFXglyph roboto12pt7baa4Glyphs[] = {
+  {     0,   0,   0,   3,    0,    1 },   // 0x20 ' '
+  {     0,   2,   9,   3,    1,   -8 },   // 0x21 '!'
+  {     9,   4,   3,   4,    0,   -9 },   // 0x22 '"'
+  {    15,   8,   9,   8,    0,   -8 },   // 0x23 '#'
+  {    51,   7,  13,   7,    0,  -10 },   // 0x24 '$'
+  {    97,   9,   9,  10,    0,   -8 },   // 0x25 '%'
+  {   138,   9,   9,   8,    0,   -8 },   // 0x26 '&'
+  {   179,   2,   3,   2,    0,   -9 },   // 0x27 '''
+  {   182,   5,  13,   4,    0,   -9 },   // 0x28 '('
+  {   215,   4,  13,   5,    0,   -9 },   // 0x29 ')'
+  {   241,   6,   5,   6,    0,   -8 },   // 0x2A '*'
+  {   256,   7,   8,   7,    0,   -7 },   // 0x2B '+'
+  {   284,   2,   4,   3,    0,   -1 },   // 0x2C ','
+  {   288,   4,   1,   4,    0,   -3 },   // 0x2D '-'
+  {   290,   3,   2,   3,    0,   -1 },   // 0x2E '.'
+  {   293,   5,  10,   5,    0,   -8 },   // 0x2F '/'
+  {   318,   7,   9,   7,    0,   -8 },   // 0x30 '0'
+  {   350,   4,   9,   7,    1,   -8 },   // 0x31 '1'
+  {   368,   7,   9,   7,    0,   -8 },   // 0x32 '2'
+  {   400,   7,   9,   7,    0,   -8 },   // 0x33 '3'
+  {   432,   8,   9,   7,    0,   -8 },   // 0x34 '4'
+  {   468,   7,   9,   7,    0,   -8 },   // 0x35 '5'
+  {   500,   7,   9,   7,    0,   -8 },   // 0x36 '6'
+  {   532,   7,   9,   7,    0,   -8 },   // 0x37 '7'
+  {   564,   7,   9,   7,    0,   -8 },   // 0x38 '8'
+  {   596,   7,   9,   7,    0,   -8 },   // 0x39 '9'
+  {   628,   3,   7,   3,    0,   -6 },   // 0x3A ':'
+  {   639,   3,   9,   3,    0,   -6 },   // 0x3B ';'
+  {   653,   6,   6,   7,    0,   -6 },   // 0x3C '<'
+  {   671,   7,   5,   7,    0,   -6 },   // 0x3D '='
+  {   689,   7,   6,   7,    0,   -6 },   // 0x3E '>'
+  {   710,   6,   9,   6,    0,   -8 },   // 0x3F '?'
+  {   737,  12,  12,  12,    0,   -8 },   // 0x40 '@'
+  {   809,  10,   9,   8,   -1,   -8 },   // 0x41 'A'
+  {   854,   7,   9,   8,    1,   -8 },   // 0x42 'B'
+  {   886,   8,   9,   8,    0,   -8 },   // 0x43 'C'
+  {   922,   7,   9,   9,    1,   -8 },   // 0x44 'D'
+  {   954,   6,   9,   7,    1,   -8 },   // 0x45 'E'
+  {   981,   6,   9,   7,    1,   -8 },   // 0x46 'F'
+  {  1008,   8,   9,   9,    0,   -8 },   // 0x47 'G'
+  {  1044,   8,   9,   9,    1,   -8 },   // 0x48 'H'
+  {  1080,   2,   9,   4,    1,   -8 },   // 0x49 'I'
+  {  1089,   7,   9,   7,    0,   -8 },   // 0x4A 'J'
+  {  1121,   8,   9,   8,    1,   -8 },   // 0x4B 'K'
+  {  1157,   6,   9,   7,    1,   -8 },   // 0x4C 'L'
+  {  1184,  10,   9,  11,    1,   -8 },   // 0x4D 'M'
+  {  1229,   8,   9,   9,    0,   -8 },   // 0x4E 'N'
+  {  1265,   9,   9,   9,    0,   -8 },   // 0x4F 'O'
+  {  1306,   8,   9,   8,    0,   -8 },   // 0x50 'P'
+  {  1342,   9,  11,   9,    0,   -8 },   // 0x51 'Q'
+  {  1392,   7,   9,   8,    1,   -8 },   // 0x52 'R'
+  {  1424,   8,   9,   8,    0,   -8 },   // 0x53 'S'
+  {  1460,   8,   9,   8,    0,   -8 },   // 0x54 'T'
+  {  1496,   8,   9,   8,    0,   -8 },   // 0x55 'U'
+  {  1532,   8,   9,   8,    0,   -8 },   // 0x56 'V'
+  {  1568,  12,   9,  12,    0,   -8 },   // 0x57 'W'
+  {  1622,   8,   9,   8,    0,   -8 },   // 0x58 'X'
+  {  1658,   8,   9,   8,    0,   -8 },   // 0x59 'Y'
+  {  1694,   8,   9,   8,    0,   -8 },   // 0x5A 'Z'
+  {  1730,   4,  13,   3,    0,  -10 },   // 0x5B '['
+  {  1756,   6,  10,   5,    0,   -8 },   // 0x5C '\'
+  {  1786,   3,  13,   3,    0,  -10 },   // 0x5D ']'
+  {  1806,   5,   4,   5,    0,   -8 },   // 0x5E '^'
+  {  1816,   6,   1,   6,    0,    1 },   // 0x5F '_'
+  {  1819,   4,   2,   4,    0,   -9 },   // 0x60 '`'
+  {  1823,   7,   7,   7,    0,   -6 },   // 0x61 'a'
+  {  1848,   7,  10,   7,    0,   -9 },   // 0x62 'b'
+  {  1883,   7,   7,   7,    0,   -6 },   // 0x63 'c'
+  {  1908,   7,  10,   7,    0,   -9 },   // 0x64 'd'
+  {  1943,   7,   7,   7,    0,   -6 },   // 0x65 'e'
+  {  1968,   5,  10,   5,    0,   -9 },   // 0x66 'f'
+  {  1993,   7,  10,   7,    0,   -6 },   // 0x67 'g'
+  {  2028,   7,  10,   7,    0,   -9 },   // 0x68 'h'
+  {  2063,   3,  10,   3,    0,   -9 },   // 0x69 'i'
+  {  2078,   4,  13,   3,   -1,   -9 },   // 0x6A 'j'
+  {  2104,   7,  10,   7,    0,   -9 },   // 0x6B 'k'
+  {  2139,   3,  10,   3,    0,   -9 },   // 0x6C 'l'
+  {  2154,  11,   7,  11,    0,   -6 },   // 0x6D 'm'
+  {  2193,   7,   7,   7,    0,   -6 },   // 0x6E 'n'
+  {  2218,   7,   7,   7,    0,   -6 },   // 0x6F 'o'
+  {  2243,   7,  10,   7,    0,   -6 },   // 0x70 'p'
+  {  2278,   7,  10,   7,    0,   -6 },   // 0x71 'q'
+  {  2313,   5,   7,   4,    0,   -6 },   // 0x72 'r'
+  {  2331,   7,   7,   7,    0,   -6 },   // 0x73 's'
+  {  2356,   5,   9,   4,   -1,   -8 },   // 0x74 't'
+  {  2379,   7,   7,   7,    0,   -6 },   // 0x75 'u'
+  {  2404,   6,   7,   6,    0,   -6 },   // 0x76 'v'
+  {  2425,  10,   7,  10,    0,   -6 },   // 0x77 'w'
+  {  2460,   7,   7,   6,    0,   -6 },   // 0x78 'x'
+  {  2485,   6,  10,   6,    0,   -6 },   // 0x79 'y'
+  {  2515,   7,   7,   6,    0,   -6 },   // 0x7A 'z'
+  {  2540,   5,  12,   4,    0,   -9 },   // 0x7B '{'
+  {  2570,   2,  11,   3,    1,   -8 },   // 0x7C '|'
+  {  2581,   5,  12,   4,   -1,   -9 },   // 0x7D '}'
+  {  2611,   9,   3,   9,    0,   -4 } }; // 0x7E '~'
+
+const GFXfont roboto12pt7baa4 = {
+  (uint8_t  *)roboto12pt7baa4Bitmaps,
+  (GFXglyph *)roboto12pt7baa4Glyphs,
+  0x20, 0x7E, 12, 4 };//B
+
+// Approx. 3297 bytes
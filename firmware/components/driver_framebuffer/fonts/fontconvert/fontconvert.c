@@ -10,6 +10,9 @@ For UNIX-like systems.  Outputs to stdout; redirect to header file, e.g.:
 
 REQUIRES FREETYPE LIBRARY.  www.freetype.org
 
+Optionally glyphs can be stored anti-aliased with 2 or 4 bits of coverage
+per pixel instead of 1 bit, pass the amount of bits as the last argument.
+
 Currently this only extracts the printable 7-bit ASCII chars of a font.
 Will eventually extend with some int'l chars a la ftGFX, not there yet.
 Keep 7-bit fonts around as an option in that case, more compact.
@@ -48,9 +51,14 @@ void enbit(uint8_t value) {
 	}
 }
 
+// Output a value of multiple bits, most significant bit first
+void enbits(uint8_t value, uint8_t bits) {
+	while(bits--) enbit(value & (1 << bits));
+}
+
 int main(int argc, char *argv[]) {
 	int                i, j, err, size, dpi=DEFAULT_DPI, first=' ', last='~', offset=0,
-	                   bitmapOffset = 0, x, y, byte;
+	                   bitmapOffset = 0, x, y, byte, bpp = 1;
 	char              *fontName, c, *ptr;
 	FT_Library         library;
 	FT_Face            face;
@@ -64,11 +72,12 @@ int main(int argc, char *argv[]) {
 	//   fontconvert [filename] [size]
 	//   fontconvert [filename] [size] [last char]
 	//   fontconvert [filename] [size] [first char] [last char]
+	//   fontconvert [filename] [size] [dpi] [first char] [last char] [offset] [bpp]
 	// Unless overridden, default first and last chars are
 	// ' ' (space) and '~', respectively
 
 	if(argc < 3) {
-		fprintf(stderr, "Usage: %s fontfile size [dpi] [first] [last] [offset]\n",
+		fprintf(stderr, "Usage: %s fontfile size [dpi] [first] [last] [offset] [bpp]\n",
 		  argv[0]);
 		return 1;
 	}
@@ -89,9 +98,20 @@ int main(int argc, char *argv[]) {
 		first = atoi(argv[4]);
 		last  = atoi(argv[5]);
 		offset = atoi(argv[6]);
+	} else if(argc == 8) {
+		dpi = atoi(argv[3]);
+		first = atoi(argv[4]);
+		last  = atoi(argv[5]);
+		offset = atoi(argv[6]);
+		bpp = atoi(argv[7]);
 	}
 	
-	fprintf(stderr, "%s) SIZE: %u, DPI: %d, FIRST: %d (%c), LAST: %d(%c), OFFSET: %d\n", argv[1], size, dpi, first, first, last, last, offset);
+	if((bpp != 1) && (bpp != 2) && (bpp != 4)) {
+		fprintf(stderr, "Bits per pixel must be 1, 2 or 4\n");
+		return 1;
+	}
+	
+	fprintf(stderr, "%s) SIZE: %u, DPI: %d, FIRST: %d (%c), LAST: %d(%c), OFFSET: %d, BPP: %d\n", argv[1], size, dpi, first, first, last, last, offset, bpp);
 
 	if(last < first) {
 		i     = first;
@@ -119,6 +139,7 @@ int main(int argc, char *argv[]) {
 	// Insert font size and 7/8 bit.  fontName was alloc'd w/extra
 	// space to allow this, we're not sprintfing into Forbidden Zone.
 	sprintf(ptr, "%dpt%db", size, (last > 127) ? 8 : 7);
+	if(bpp > 1) sprintf(&ptr[strlen(ptr)], "aa%d", bpp);
 	// Space and punctuation chars in name replaced w/ underscores.  
 	for(i=0; (c=fontName[i]); i++) {
 		if(isspace(c) || ispunct(c)) fontName[i] = '_';
@@ -160,15 +181,16 @@ int main(int argc, char *argv[]) {
 	// Process glyphs and output huge bitmap data array
 	for(i=first, j=0; i<=last; i++, j++) {
 		// MONO renderer provides clean image with perfect crop
-		// (no wasted pixels) via bitmap struct.
-		if((err = FT_Load_Char(face, i, FT_LOAD_TARGET_MONO))) {
+		// (no wasted pixels) via bitmap struct. The NORMAL renderer
+		// provides 8 bits of coverage per pixel for anti-aliased fonts.
+		if((err = FT_Load_Char(face, i, (bpp > 1) ? FT_LOAD_TARGET_NORMAL : FT_LOAD_TARGET_MONO))) {
 			fprintf(stderr, "Error %d loading char '%c'\n",
 			  err, i);
 			continue;
 		}
 
 		if((err = FT_Render_Glyph(face->glyph,
-		  FT_RENDER_MODE_MONO))) {
+		  (bpp > 1) ? FT_RENDER_MODE_NORMAL : FT_RENDER_MODE_MONO))) {
 			fprintf(stderr, "Error %d rendering char '%c'\n",
 			  err, i);
 			continue;
@@ -200,20 +222,30 @@ int main(int argc, char *argv[]) {
 
 		for(y=0; y < bitmap->rows; y++) {
 			for(x=0;x < bitmap->width; x++) {
-				byte = x / 8;
-				bit  = 0x80 >> (x & 7);
-				enbit(bitmap->buffer[
-				  y * bitmap->pitch + byte] & bit);
+				if(bpp > 1) {
+					// Scale 8 bit coverage down to the requested depth, rounded
+					int coverage = bitmap->buffer[y * bitmap->pitch + x];
+					enbits((coverage * ((1 << bpp) - 1) + 127) / 255, bpp);
+				} else {
+					byte = x / 8;
+					bit  = 0x80 >> (x & 7);
+					enbit(bitmap->buffer[
+					  y * bitmap->pitch + byte] & bit);
+				}
 			}
 		}
 
 		// Pad end of char bitmap to next byte boundary if needed
-		int n = (bitmap->width * bitmap->rows) & 7;
-		if(n) { // Pixel count not an even multiple of 8?
+		int n = (bitmap->width * bitmap->rows * bpp) & 7;
+		if(n) { // Bit count not an even multiple of 8?
 			n = 8 - n; // # bits to next multiple
 			while(n--) enbit(0);
 		}
-		bitmapOffset += (bitmap->width * bitmap->rows + 7) / 8;
+		bitmapOffset += (bitmap->width * bitmap->rows * bpp + 7) / 8;
+		if(bitmapOffset > 0xFFFF) {
+			fprintf(stderr, "Bitmap data exceeds 64K at char '%c', use a smaller size or fewer bits per pixel\n", i);
+			return 1;
+		}
 
 		FT_Done_Glyph(glyph);
 	}
@@ -254,8 +286,13 @@ int main(int argc, char *argv[]) {
 		printf("  0x%02X, 0x%02X, %ld };//B\n\n",
 			first+offset, last+offset, face->size->metrics.height >> 6);
 	}*/
-	printf("  0x%02X, 0x%02X, %d };//B\n\n",
-			first+offset, last+offset, size);
+	if(bpp > 1) {
+		printf("  0x%02X, 0x%02X, %d, %d };//B\n\n",
+				first+offset, last+offset, size, bpp);
+	} else {
+		printf("  0x%02X, 0x%02X, %d };//B\n\n",
+				first+offset, last+offset, size);
+	}
 	printf("// Approx. %d bytes\n",
 	  bitmapOffset + (last - first + 1) * 7 + 7);
 	// Size estimate is based on AVR struct and pointer sizes;
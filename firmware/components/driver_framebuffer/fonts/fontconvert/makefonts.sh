@@ -42,3 +42,6 @@ do
 done
 
 $convert weather.ttf 42 $dpi 61440 61635 -61439 > ../../font_weather42pt8b.c
+
+# Anti-aliased fonts (4 bits of coverage per pixel)
+$convert roboto.ttf 12 $dpi 32 126 0 4 > ../../font_roboto12pt7baa4.c
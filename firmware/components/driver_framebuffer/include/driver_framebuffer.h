@@ -15,11 +15,13 @@
 #include "driver_framebuffer_orientation.h"
 #include "driver_framebuffer_drawing.h"
 #include "driver_framebuffer_text.h"
+#include "driver_framebuffer_png_cache.h"
 
 //PNG library
 #include "mem_reader.h"
 #include "file_reader.h"
 #include "png_reader.h"
+struct lib_png_reader;
 
 /* Flags */
 #define FB_FLAG_FORCE          1
@@ -51,6 +53,24 @@ void driver_framebuffer_setPixel(Window* window, int16_t x, int16_t y, uint32_t
 uint32_t driver_framebuffer_getPixel(Window* window, int16_t x, int16_t y);
 /* Get the color of a pixel in the framebuffer or the provided frame */
 
+void driver_framebuffer_setPixels(Window* window, int16_t x, int16_t y, const uint32_t* values, uint16_t count);
+/* Set a row of count pixels starting at point (x, y) in the framebuffer or the provided frame to the provided colors */
+
+void driver_framebuffer_setPixelsNative(Window* window, int16_t x, int16_t y, const uint8_t* pixels, uint16_t count);
+/* Set a row of count pixels starting at point (x, y) from data in the native format of the framebuffer (only for formats with whole bytes per pixel) */
+
+void driver_framebuffer_blendPixel(Window* window, int16_t x, int16_t y, uint32_t value, uint8_t alpha);
+/* Mix a color into a pixel in the framebuffer or the provided frame, alpha ranges from 0 (transparent) to 255 (opaque) */
+
+void driver_framebuffer_fill_rect(Window* window, int16_t x, int16_t y, uint16_t w, uint16_t h, uint32_t value);
+/* Fill a rectangle from point (x, y) to point (x+w-1, y+h-1) in the framebuffer or the provided frame with a single color */
+
+void driver_framebuffer_hspan(Window* window, int16_t x, int16_t y, uint16_t w, uint32_t value);
+/* Draw a horizontal line of w pixels starting at point (x, y) */
+
+void driver_framebuffer_vspan(Window* window, int16_t x, int16_t y, uint16_t h, uint32_t value);
+/* Draw a vertical line of h pixels starting at point (x, y) */
+
 uint16_t driver_framebuffer_getWidth(Window* window);
 /* Get the width of the framebuffer or the provided window */
 
@@ -60,6 +80,9 @@ uint16_t driver_framebuffer_getHeight(Window* window);
 esp_err_t driver_framebuffer_png(Window* window, int16_t x, int16_t y, lib_reader_read_t reader, void* reader_p);
 /* Draw a PNG image to the framebuffer of the provided window */
 
+esp_err_t driver_framebuffer_png_draw(Window* window, int16_t x, int16_t y, struct lib_png_reader* pr);
+/* Draw a PNG image from an opened PNG reader to the framebuffer or the provided window */
+
 void driver_framebuffer_blit(Window* source, Window* target);
 /* Blit a window to the framebuffer of another window or the main framebuffer */
 
@@ -1,5 +1,6 @@
 /* This file specifies the framebuffer configuration for the displays that are supported. */
 /* The order in this file determines priority if multiple drivers are enabled */
+/* Displays that define FB_FLUSH_REGIONS support partial updates and get one FB_FLUSH call per dirty region */
 
 #ifndef _DRIVER_FRAMEBUFFER_DEVICES_H_
 #define _DRIVER_FRAMEBUFFER_DEVICES_H_
@@ -57,6 +58,7 @@
 	#define FB_TYPE_1BPP
 	#define FB_1BPP_VERT2
 	#define FB_FLUSH(buffer,eink_flags,x0,y0,x1,y1) driver_ssd1306_write_part(buffer,x0,y0,x1,y1)
+	#define FB_FLUSH_REGIONS
 	#define COLOR_FILL_DEFAULT 0x000000
 	#define COLOR_TEXT_DEFAULT 0xFFFFFF
 
@@ -68,6 +70,7 @@
 	#define FB_TYPE_1BPP
 	#define FB_1BPP_VERT
 	#define FB_FLUSH(buffer,eink_flags,x0,y0,x1,y1) driver_erc12864_write_part(buffer,x0,y0,x1,y1)
+	#define FB_FLUSH_REGIONS
 	#ifdef CONFIG_DRIVER_DISOBEY_SAMD_ENABLE
 		#define FB_SET_BACKLIGHT(brightness) driver_disobey_samd_write_backlight(brightness)
 	#endif
@@ -86,6 +89,7 @@
 	#endif
 	#define FB_ALPHA_ENABLED
 	#define FB_FLUSH(buffer,eink_flags,x0,y0,x1,y1) driver_ili9341_write_partial(buffer, x0, y0, x1, y1)
+	#define FB_FLUSH_REGIONS
 	#define FB_SET_BACKLIGHT(brightness) driver_ili9341_set_backlight(brightness > 127)
 	#define COLOR_FILL_DEFAULT 0x000000
 	#define COLOR_TEXT_DEFAULT 0xFFFFFF
@@ -97,6 +101,7 @@
 	#define FB_HEIGHT ST7735_HEIGHT
 	#define FB_TYPE_16BPP
 	#define FB_FLUSH(buffer,eink_flags,x0,y0,x1,y1) driver_st7735_write_partial(buffer, x0, y0, x1, y1)
+	#define FB_FLUSH_REGIONS
 	#define FB_SET_BACKLIGHT(brightness) driver_st7735_set_backlight(brightness > 127)
 	#define COLOR_FILL_DEFAULT 0x000000
 	#define COLOR_TEXT_DEFAULT 0xFFFFFF
@@ -112,6 +117,7 @@
 			#define FB_TYPE_16BPP
 	#endif
 	#define FB_FLUSH(buffer,eink_flags,x0,y0,x1,y1) driver_st7789v_write_partial(buffer, x0, y0, x1, y1)
+	#define FB_FLUSH_REGIONS
 	#define FB_SET_BACKLIGHT(brightness) driver_st7789v_set_backlight(brightness > 127)
 	#define COLOR_FILL_DEFAULT 0x000000
 	#define COLOR_TEXT_DEFAULT 0xFFFFFF
@@ -178,6 +184,10 @@
 	#define PIXEL_SIZE 32
 #endif
 
+#if (PIXEL_SIZE % 8) == 0
+	#define BYTES_PER_PIXEL (PIXEL_SIZE / 8)
+#endif
+
 #endif
 
 #endif //_DRIVER_FRAMEBUFFER_DEVICES_H_
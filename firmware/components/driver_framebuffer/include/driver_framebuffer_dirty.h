@@ -3,6 +3,13 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "sdkconfig.h"
+
+#ifdef CONFIG_DRIVER_FRAMEBUFFER_DIRTY_REGIONS
+	#define DIRTY_REGIONS_MAX CONFIG_DRIVER_FRAMEBUFFER_DIRTY_REGIONS
+#else
+	#define DIRTY_REGIONS_MAX 1
+#endif
 
 bool driver_framebuffer_is_dirty();
 /* Returns true if the framebuffer contains a dirty area */
@@ -11,6 +18,12 @@ void driver_framebuffer_set_dirty_area(int16_t x0, int16_t y0, int16_t x1, int16
 /* Set the dirty area, either incremental or directly by setting the force flag */
 
 void driver_framebuffer_get_dirty_area(int16_t* x0, int16_t* y0, int16_t* x1, int16_t* y1);
-/* Get the dirty area */
+/* Get the dirty area (the bounding box of all dirty regions) */
+
+uint8_t driver_framebuffer_get_dirty_region_count();
+/* Get the amount of separate dirty regions */
+
+void driver_framebuffer_get_dirty_region(uint8_t index, int16_t* x0, int16_t* y0, int16_t* x1, int16_t* y1);
+/* Get one of the dirty regions */
 
 #endif
@@ -17,6 +17,7 @@ typedef struct {
 	uint8_t   first;       ///< ASCII extents (first char)
 	uint8_t   last;        ///< ASCII extents (last char)
 	uint8_t   yAdvance;    ///< Newline distance (y axis)
+	uint8_t   bpp;         ///< Bits of coverage per pixel, 0 or 1 for monochrome, 2 or 4 for anti-aliased
 } GFXfont;
 
 #endif
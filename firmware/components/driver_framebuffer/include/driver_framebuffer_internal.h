@@ -15,6 +15,7 @@
 #include "driver_framebuffer_orientation.h"
 #include "driver_framebuffer_drawing.h"
 #include "driver_framebuffer_text.h"
+#include "driver_framebuffer_png_cache.h"
 
 #include "driver_framebuffer.h"
 
@@ -0,0 +1,30 @@
+#ifndef _DRIVER_FRAMEBUFFER_PNG_CACHE_H_
+#define _DRIVER_FRAMEBUFFER_PNG_CACHE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "esp_system.h"
+
+#include "driver_framebuffer_compositor.h"
+#include "reader.h"
+
+typedef struct {
+	uint32_t hits, misses;
+	uint32_t entries;
+	uint32_t used, size; // Bytes
+} PngCacheStats;
+
+bool driver_framebuffer_png_cache_draw(Window* window, int16_t x, int16_t y, const char* name, uint32_t size, uint32_t stamp);
+/* Draw a decoded image from the cache, returns false if the image is not in the cache. Images are identified by name (may be NULL), size and stamp (e.g. file path, file size and modification time) */
+
+esp_err_t driver_framebuffer_png_cache_load(Window* window, int16_t x, int16_t y, const char* name, uint32_t size, uint32_t stamp, lib_reader_read_t reader, void* reader_p);
+/* Decode and draw a PNG image, the decoded image is added to the cache if it fits */
+
+void driver_framebuffer_png_cache_clear();
+/* Remove all images from the cache */
+
+void driver_framebuffer_png_cache_stats(PngCacheStats* stats);
+/* Get the cache usage counters */
+
+#endif
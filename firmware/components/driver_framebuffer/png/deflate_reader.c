@@ -4,179 +4,330 @@
 #include <unistd.h>
 #include <string.h>
 
+#include <sdkconfig.h>
+
+#ifdef CONFIG_DRIVER_FRAMEBUFFER_INFLATE_SPIRAM
+#include <esp_heap_caps.h>
+#endif
+
 #include "deflate_reader.h"
 
+#ifdef CONFIG_DRIVER_FRAMEBUFFER_INFLATE_POOL_SIZE
+#define LIB_DEFLATE_POOL_SIZE CONFIG_DRIVER_FRAMEBUFFER_INFLATE_POOL_SIZE
+#else
+#define LIB_DEFLATE_POOL_SIZE 0
+#endif
+
+#if LIB_DEFLATE_POOL_SIZE > 0
+#include <freertos/FreeRTOS.h>
+#endif
+
 #define likely(x)   __builtin_expect(!!(x), 1)
 #define unlikely(x) __builtin_expect(!!(x), 0)
 
 static inline int
-lib_deflate_get_bits_long(struct lib_deflate_reader *dr, int num)
+lib_deflate_fetch(struct lib_deflate_reader *dr)
 {
-	int value = dr->bitbuf[1];
-	if (num > dr->bitlen + 8)
+	// input is fetched one byte at a time, only when its bits are needed, so
+	// that nothing after the end of the deflate stream is consumed.
+	uint8_t byte;
+	ssize_t res = dr->read(dr->read_p, &byte, 1);
+	if (unlikely(res < 1))
 	{
-		ssize_t res = dr->read(dr->read_p, dr->bitbuf, 2);
-		if (unlikely(res < 2))
-		{
-			if (res < 0)
-				return res;
-			return -LIB_DEFLATE_ERROR_UNEXPECTED_END_OF_FILE;
-		}
-		uint16_t *bitbuf = (uint16_t *) dr->bitbuf;
-#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
-		value |= *bitbuf << 8;
-#elif __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
-		value |= __builtin_bswap16(*bitbuf) << 8;
-#endif
-	}
-	else if (num > dr->bitlen)
-	{
-		ssize_t res = dr->read(dr->read_p, &(dr->bitbuf[1]), 1);
-		if (unlikely(res < 1))
-		{
-			if (res < 0)
-				return res;
-			return -LIB_DEFLATE_ERROR_UNEXPECTED_END_OF_FILE;
-		}
-		value |= dr->bitbuf[1] << 8;
+		if (res < 0)
+			return res;
+		return -LIB_DEFLATE_ERROR_UNEXPECTED_END_OF_FILE;
 	}
-
-	value >>= 8 - dr->bitlen;
-	value &= (1 << num) - 1;
-	dr->bitlen -= num;
-	dr->bitlen &= 7;
-
-	return value;
+	dr->bitbuf |= (uint32_t) byte << dr->bitlen;
+	dr->bitlen += 8;
+	return 0;
 }
 
 static inline int
 lib_deflate_get_bits(struct lib_deflate_reader *dr, int num)
 {
-	int value = dr->bitbuf[1];
-	if (num > dr->bitlen)
+	while (dr->bitlen < num)
 	{
-		ssize_t res = dr->read(dr->read_p, &(dr->bitbuf[1]), 1);
-		if (unlikely(res < 1))
-		{
-			if (res < 0)
-				return res;
-			return -LIB_DEFLATE_ERROR_UNEXPECTED_END_OF_FILE;
-		}
-		value |= dr->bitbuf[1] << 8;
+		int res = lib_deflate_fetch(dr);
+		if (unlikely(res < 0))
+			return res;
 	}
 
-	value >>= 8 - dr->bitlen;
-	value &= (1 << num) - 1;
+	int value = dr->bitbuf & ((1 << num) - 1);
+	dr->bitbuf >>= num;
 	dr->bitlen -= num;
-	dr->bitlen &= 7;
 
 	return value;
 }
 
-static inline int
-lib_deflate_build_huffman(const uint8_t *tbl, int tbl_len, uint16_t *tree)
+static int
+lib_deflate_build_huffman(const uint8_t *lengths, int num, struct lib_deflate_huffman *h)
 {
-	int bits;
-	int bits_prev = 0;
-	int total = 0;
-	for (bits=1; bits<16; bits++)
+	memset(h->count, 0, sizeof(h->count));
+	int i;
+	for (i=0; i<num; i++)
+		h->count[ lengths[i] ]++;
+	h->count[0] = 0;
+
+	// check that the lengths form a valid prefix code
+	int left = 1;
+	int codes = 0;
+	int len;
+	for (len=1; len<16; len++)
+	{
+		left <<= 1;
+		left -= h->count[len];
+		if (unlikely(left < 0))
+			return -LIB_DEFLATE_ERROR_UNBALANCED_HUFFMAN_TREE; // over-subscribed
+		codes += h->count[len];
+	}
+	if (unlikely(left > 0 && codes > 1))
+		return -LIB_DEFLATE_ERROR_UNBALANCED_HUFFMAN_TREE; // incomplete, only allowed for a single code
+
+	// sort symbols by code
+	uint16_t offs[16];
+	offs[1] = 0;
+	for (len=1; len<15; len++)
+		offs[len + 1] = offs[len] + h->count[len];
+	for (i=0; i<num; i++)
 	{
-		int i;
-		for (i=0; i<tbl_len; i++)
+		if (lengths[i] != 0)
+			h->symbol[ offs[ lengths[i] ]++ ] = i;
+	}
+
+	// fill the look-up table for the short codes. codes are stored most
+	// significant bit first, so the table is indexed by the reversed code.
+	memset(h->fast, 0, sizeof(h->fast));
+	int code = 0;
+	int index = 0;
+	for (len=1; len<=LIB_DEFLATE_FAST_BITS; len++)
+	{
+		int n;
+		for (n=0; n<h->count[len]; n++, code++, index++)
 		{
-			if (unlikely(tbl[i] == bits))
-			{
-				if (unlikely(bits - bits_prev > 8))
-				{
-					*tree++ = 8;
-					bits_prev += 8;
-				}
-				uint16_t *base = tree++;
-				*tree++ = i;
-				int count = 1;
-				i++;
-				for (; i<tbl_len; i++)
-				{
-					if (unlikely(tbl[i] == bits))
-					{
-						*tree++ = i;
-						count++;
-					}
-				}
-				*base = (count << 4) | (bits - bits_prev);
-				bits_prev = bits;
-				total += (0x10000 * count) >> bits;
-				break;
-			}
+			int reversed = 0;
+			int bit;
+			for (bit=0; bit<len; bit++)
+				reversed |= ((code >> bit) & 1) << (len - 1 - bit);
+			uint16_t entry = (h->symbol[index] << 4) | len;
+			for (; reversed < (1 << LIB_DEFLATE_FAST_BITS); reversed += 1 << len)
+				h->fast[reversed] = entry;
 		}
+		code <<= 1;
 	}
 
-	if (unlikely(total != 0x10000))
+	return 0;
+}
+
+static int
+lib_deflate_get_huffman_slow(struct lib_deflate_reader *dr, const struct lib_deflate_huffman *h)
+{
+	// canonical decoding, one bit at a time, for codes longer than the table
+	int code = 0;
+	int first = 0;
+	int index = 0;
+	int len;
+	for (len=1; len<16; len++)
 	{
-		// table not well-balanced. something is wrong.
-		return -LIB_DEFLATE_ERROR_UNBALANCED_HUFFMAN_TREE;
+		while (dr->bitlen < len)
+		{
+			int res = lib_deflate_fetch(dr);
+			if (unlikely(res < 0))
+				return res;
+		}
+		code |= (dr->bitbuf >> (len - 1)) & 1;
+		int count = h->count[len];
+		if (code - count < first)
+		{
+			dr->bitbuf >>= len;
+			dr->bitlen -= len;
+			return h->symbol[ index + (code - first) ];
+		}
+		index += count;
+		first += count;
+		first <<= 1;
+		code <<= 1;
 	}
 
-	return 0;
+	return -LIB_DEFLATE_ERROR_HUFFMAN_INVALID_CODE;
 }
 
 static inline int
-lib_deflate_get_huffman(struct lib_deflate_reader *dr, const uint16_t *tbl)
+lib_deflate_get_huffman(struct lib_deflate_reader *dr, const struct lib_deflate_huffman *h)
 {
-	int value = 0;
 	while (1)
 	{
-		uint16_t bits = *tbl++;
-		uint16_t entries = bits >> 4;
-
-		bits &= 15;
-		int res = lib_deflate_get_bits(dr, bits);
-		if (unlikely(res < 0))
-			return res;
-
-		// shift res into value, in reverse order.
-		switch (bits)
+		// missing input bits are zero; the entry is only valid if all its bits are present
+		uint16_t entry = h->fast[ dr->bitbuf & ((1 << LIB_DEFLATE_FAST_BITS) - 1) ];
+		int len = entry & 15;
+		if (likely(len != 0 && len <= dr->bitlen))
 		{
-			case 8: value <<= 1; value += res & 1; res >>= 1;
-			case 7: value <<= 1; value += res & 1; res >>= 1;
-			case 6: value <<= 1; value += res & 1; res >>= 1;
-			case 5: value <<= 1; value += res & 1; res >>= 1;
-			case 4: value <<= 1; value += res & 1; res >>= 1;
-			case 3: value <<= 1; value += res & 1; res >>= 1;
-			case 2: value <<= 1; value += res & 1; res >>= 1;
-			case 1: value <<= 1; value += res;
+			dr->bitbuf >>= len;
+			dr->bitlen -= len;
+			return entry >> 4;
 		}
+		if (len == 0 && dr->bitlen >= LIB_DEFLATE_FAST_BITS)
+			return lib_deflate_get_huffman_slow(dr, h);
 
-		if (value < entries)
-			return tbl[value];
-
-		value -= entries;
-		tbl = &tbl[entries];
+		int res = lib_deflate_fetch(dr);
+		if (unlikely(res < 0))
+			return res;
 	}
-
-	return value;
 }
 
 void
 lib_deflate_init(struct lib_deflate_reader *dr, lib_reader_read_t read, void *read_p)
 {
+	// the window is kept, so a reader can be re-used for the next stream
+	uint8_t *look_behind = dr->look_behind;
+	int lb_mask = dr->lb_mask;
+
 	memset(dr, 0, sizeof(struct lib_deflate_reader));
 	dr->read = read;
 	dr->read_p = read_p;
+	dr->look_behind = look_behind;
+	dr->lb_mask = lb_mask;
 }
 
-struct lib_deflate_reader *
-lib_deflate_new(lib_reader_read_t read, void *read_p)
+static struct lib_deflate_reader *
+lib_deflate_alloc(int window_size)
 {
 	struct lib_deflate_reader *dr = (struct lib_deflate_reader *) malloc(sizeof(struct lib_deflate_reader));
 	if (unlikely(dr == NULL))
 		return NULL;
 
+	// the window is only touched for back-references, the huffman tables
+	// in the reader itself are used for every symbol and stay in internal ram.
+#ifdef CONFIG_DRIVER_FRAMEBUFFER_INFLATE_SPIRAM
+	dr->look_behind = (uint8_t *) heap_caps_malloc(window_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+	if (dr->look_behind == NULL)
+#endif
+	dr->look_behind = (uint8_t *) malloc(window_size);
+	if (unlikely(dr->look_behind == NULL))
+	{
+		free(dr);
+		return NULL;
+	}
+	dr->lb_mask = window_size - 1;
+
+	return dr;
+}
+
+static void
+lib_deflate_free(struct lib_deflate_reader *dr)
+{
+	free(dr->look_behind);
+	free(dr);
+}
+
+#if LIB_DEFLATE_POOL_SIZE > 0
+// readers are kept after use, so that decoding many small streams does not
+// allocate and free a window each time.
+static portMUX_TYPE lib_deflate_pool_mux = portMUX_INITIALIZER_UNLOCKED;
+static struct lib_deflate_reader *lib_deflate_pool[LIB_DEFLATE_POOL_SIZE];
+
+static struct lib_deflate_reader *
+lib_deflate_pool_get(int window_size)
+{ // take the smallest pooled reader with a large enough window
+	struct lib_deflate_reader *dr = NULL;
+	portENTER_CRITICAL(&lib_deflate_pool_mux);
+	int best = -1;
+	int i;
+	for (i=0; i<LIB_DEFLATE_POOL_SIZE; i++)
+	{
+		if (lib_deflate_pool[i] == NULL || lib_deflate_pool[i]->lb_mask + 1 < window_size)
+			continue;
+		if (best < 0 || lib_deflate_pool[i]->lb_mask < lib_deflate_pool[best]->lb_mask)
+			best = i;
+	}
+	if (best >= 0)
+	{
+		dr = lib_deflate_pool[best];
+		lib_deflate_pool[best] = NULL;
+	}
+	portEXIT_CRITICAL(&lib_deflate_pool_mux);
+	return dr;
+}
+
+static struct lib_deflate_reader *
+lib_deflate_pool_put(struct lib_deflate_reader *dr)
+{ // store a reader, returns the reader that did not fit in the pool
+	portENTER_CRITICAL(&lib_deflate_pool_mux);
+	int smallest = 0;
+	int i;
+	for (i=0; i<LIB_DEFLATE_POOL_SIZE; i++)
+	{
+		if (lib_deflate_pool[i] == NULL)
+		{
+			smallest = i;
+			break;
+		}
+		if (lib_deflate_pool[i]->lb_mask < lib_deflate_pool[smallest]->lb_mask)
+			smallest = i;
+	}
+	// when the pool is full, keep the larger windows
+	struct lib_deflate_reader *evicted = lib_deflate_pool[smallest];
+	if (evicted == NULL || evicted->lb_mask < dr->lb_mask)
+		lib_deflate_pool[smallest] = dr;
+	else
+		evicted = dr;
+	portEXIT_CRITICAL(&lib_deflate_pool_mux);
+	return evicted;
+}
+#endif
+
+void
+lib_deflate_pool_free(void)
+{
+#if LIB_DEFLATE_POOL_SIZE > 0
+	int i;
+	for (i=0; i<LIB_DEFLATE_POOL_SIZE; i++)
+	{
+		portENTER_CRITICAL(&lib_deflate_pool_mux);
+		struct lib_deflate_reader *dr = lib_deflate_pool[i];
+		lib_deflate_pool[i] = NULL;
+		portEXIT_CRITICAL(&lib_deflate_pool_mux);
+		if (dr)
+			lib_deflate_free(dr);
+	}
+#endif
+}
+
+struct lib_deflate_reader *
+lib_deflate_new_sized(lib_reader_read_t read, void *read_p, size_t out_len)
+{
+	// back-references never go further back than the start of the stream,
+	// so a stream with a known length only needs a window of that size.
+	int window_size = 256;
+	while (window_size < LIB_DEFLATE_WINDOW_SIZE && (size_t) window_size < out_len)
+		window_size <<= 1;
+
+#if LIB_DEFLATE_POOL_SIZE > 0
+	struct lib_deflate_reader *dr = lib_deflate_pool_get(window_size);
+	if (dr == NULL)
+		dr = lib_deflate_alloc(window_size);
+	if (dr == NULL)
+	{ // memory may be held by pooled readers that are too small
+		lib_deflate_pool_free();
+		dr = lib_deflate_alloc(window_size);
+	}
+#else
+	struct lib_deflate_reader *dr = lib_deflate_alloc(window_size);
+#endif
+	if (unlikely(dr == NULL))
+		return NULL;
+
 	lib_deflate_init(dr, read, read_p);
 
 	return dr;
 }
 
+struct lib_deflate_reader *
+lib_deflate_new(lib_reader_read_t read, void *read_p)
+{
+	return lib_deflate_new_sized(read, read_p, LIB_DEFLATE_WINDOW_SIZE);
+}
+
 ssize_t
 lib_deflate_read(struct lib_deflate_reader *dr, uint8_t *buf, size_t buf_len)
 {
@@ -197,6 +348,7 @@ lib_deflate_read(struct lib_deflate_reader *dr, uint8_t *buf, size_t buf_len)
 
 			if (block_type == 0)
 			{ // stored block
+				dr->bitbuf = 0; // skip to the next byte boundary
 				dr->bitlen = 0;
 
 				uint16_t rd_buf[2];
@@ -223,30 +375,29 @@ lib_deflate_read(struct lib_deflate_reader *dr, uint8_t *buf, size_t buf_len)
 			}
 			else if (block_type == 1)
 			{ // static huffman
-				int i;
-				uint16_t *tree = dr->huffman_lc_tree;
-				*tree++ = ((280-256) << 4) | 7;
-				for (i=256; i<280; i++)
-					*tree++ = i;
-				*tree++ = ((144-0+288-280) << 4) | 1;
-				for (i=0; i<144; i++)
-					*tree++ = i;
-				for (i=280; i<288; i++)
-					*tree++ = i;
-				*tree++ = ((256-144) << 4) | 1;
-				for (i=144; i<256; i++)
-					*tree++ = i;
-
-				tree = dr->huffman_dc_tree;
-				*tree++ = ((32-0) << 4) | 5;
-				for (i=0; i<32; i++)
-					*tree++ = i;
+				if (!dr->huffman_static)
+				{
+					uint8_t huffman[288];
+					memset(&huffman[  0], 8, 144);
+					memset(&huffman[144], 9, 256-144);
+					memset(&huffman[256], 7, 280-256);
+					memset(&huffman[280], 8, 288-280);
+					int res = lib_deflate_build_huffman(huffman, 288, &dr->huffman_lc);
+					if (unlikely(res < 0))
+						return res;
+
+					memset(huffman, 5, 32);
+					res = lib_deflate_build_huffman(huffman, 32, &dr->huffman_dc);
+					if (unlikely(res < 0))
+						return res;
+					dr->huffman_static = true;
+				}
 
 				dr->state = LIB_DEFLATE_STATE_HUFFMAN;
 			}
 			else if (block_type == 2)
 			{ // dynamic huffman
-				int blc_dc_lc = lib_deflate_get_bits_long(dr, 14);
+				int blc_dc_lc = lib_deflate_get_bits(dr, 14);
 				if (unlikely(blc_dc_lc < 0))
 					return blc_dc_lc;
 
@@ -255,7 +406,8 @@ lib_deflate_read(struct lib_deflate_reader *dr, uint8_t *buf, size_t buf_len)
 				int blc_num = 4   +  (blc_dc_lc >> 10);
 
 				// use the temp huffman array for all huffman table creates.
-				uint8_t huffman[288];
+				// literal/length and distance code lengths form one sequence.
+				uint8_t huffman[288+32];
 
 				static const uint8_t blc_order[19] = {
 					16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15, 
@@ -270,116 +422,67 @@ lib_deflate_read(struct lib_deflate_reader *dr, uint8_t *buf, size_t buf_len)
 					huffman[blc_order[i]] = bits;
 				}
 
-				uint16_t blc_tree[19 + 7];
-				int res = lib_deflate_build_huffman(huffman, 19, blc_tree);
+				dr->huffman_static = false;
+				int res = lib_deflate_build_huffman(huffman, 19, &dr->huffman_lc);
 				if (unlikely(res < 0))
 					return res; // invalid table
 
-				int lc_i=0;
-				while (lc_i < lc_num)
+				int num = lc_num + dc_num;
+				int len_i = 0;
+				while (len_i < num)
 				{
-					int len = lib_deflate_get_huffman(dr, blc_tree);
+					int len = lib_deflate_get_huffman(dr, &dr->huffman_lc);
 					if (unlikely(len < 0))
 						return len;
 
 					if (len < 16)
 					{
-						huffman[lc_i++] = len;
+						huffman[len_i++] = len;
+						continue;
 					}
-					else if (len == 16)
+
+					uint8_t repeat_len = 0;
+					int repeat;
+					if (len == 16)
 					{
-						if (unlikely(lc_i == 0))
+						if (unlikely(len_i == 0))
 							return -LIB_DEFLATE_ERROR_DYNAMIC_HUFFMAN_SETUP_ERROR;
-						uint8_t prev_len = huffman[lc_i - 1];
-						int repeat = lib_deflate_get_bits(dr, 2);
+						repeat_len = huffman[len_i - 1];
+						repeat = lib_deflate_get_bits(dr, 2);
 						if (unlikely(repeat < 0))
 							return repeat;
 						repeat += 3;
-						if (unlikely(lc_i + repeat > lc_num))
-							return -LIB_DEFLATE_ERROR_DYNAMIC_HUFFMAN_SETUP_ERROR; // overflow
-						while (repeat--)
-							huffman[lc_i++] = prev_len;
 					}
 					else if (len == 17)
 					{
-						int repeat = lib_deflate_get_bits(dr, 3);
+						repeat = lib_deflate_get_bits(dr, 3);
 						if (unlikely(repeat < 0))
 							return repeat;
 						repeat += 3;
-						if (unlikely(lc_i + repeat > lc_num))
-							return -LIB_DEFLATE_ERROR_DYNAMIC_HUFFMAN_SETUP_ERROR; // overflow
-						while (repeat--)
-							huffman[lc_i++] = 0;
 					}
 					else if (len == 18)
 					{
-						int repeat = lib_deflate_get_bits(dr, 7);
+						repeat = lib_deflate_get_bits(dr, 7);
 						if (unlikely(repeat < 0))
 							return repeat;
 						repeat += 11;
-						if (unlikely(lc_i + repeat > lc_num))
-							return -LIB_DEFLATE_ERROR_DYNAMIC_HUFFMAN_SETUP_ERROR; // overflow
-						while (repeat--)
-							huffman[lc_i++] = 0;
 					}
 					else return -LIB_DEFLATE_ERROR_DYNAMIC_HUFFMAN_SETUP_ERROR;
+
+					if (unlikely(len_i + repeat > num))
+						return -LIB_DEFLATE_ERROR_DYNAMIC_HUFFMAN_SETUP_ERROR; // overflow
+					memset(&huffman[len_i], repeat_len, repeat);
+					len_i += repeat;
 				}
 
-				res = lib_deflate_build_huffman(huffman, lc_i, dr->huffman_lc_tree);
+				if (unlikely(huffman[256] == 0))
+					return -LIB_DEFLATE_ERROR_DYNAMIC_HUFFMAN_SETUP_ERROR; // no end-of-block code
+
+				res = lib_deflate_build_huffman(huffman, lc_num, &dr->huffman_lc);
 				if (unlikely(res < 0))
 					return res; // invalid table
 
-				int dc_i=0;
-				while (dc_i < dc_num)
-				{
-					int len = lib_deflate_get_huffman(dr, blc_tree);
-					if (unlikely(len < 0))
-						return len;
-
-					if (len < 16)
-					{
-						huffman[dc_i++] = len;
-					}
-					else if (len == 16)
-					{
-						if (unlikely(dc_i == 0))
-							return -LIB_DEFLATE_ERROR_DYNAMIC_HUFFMAN_SETUP_ERROR;
-						uint8_t prev_len = huffman[dc_i - 1];
-						int repeat = lib_deflate_get_bits(dr, 2);
-						if (unlikely(repeat < 0))
-							return repeat;
-						repeat += 3;
-						if (unlikely(dc_i + repeat > dc_num))
-							return -LIB_DEFLATE_ERROR_DYNAMIC_HUFFMAN_SETUP_ERROR; // overflow
-						while (repeat--)
-							huffman[dc_i++] = prev_len;
-					}
-					else if (len == 17)
-					{
-						int repeat = lib_deflate_get_bits(dr, 3);
-						if (unlikely(repeat < 0))
-							return repeat;
-						repeat += 3;
-						if (unlikely(dc_i + repeat > dc_num))
-							return -LIB_DEFLATE_ERROR_DYNAMIC_HUFFMAN_SETUP_ERROR; // overflow
-						while (repeat--)
-							huffman[dc_i++] = 0;
-					}
-					else if (len == 18)
-					{
-						int repeat = lib_deflate_get_bits(dr, 7);
-						if (unlikely(repeat < 0))
-							return repeat;
-						repeat += 11;
-						if (unlikely(dc_i + repeat > dc_num))
-							return -LIB_DEFLATE_ERROR_DYNAMIC_HUFFMAN_SETUP_ERROR; // overflow
-						while (repeat--)
-							huffman[dc_i++] = 0;
-					}
-					else return -LIB_DEFLATE_ERROR_DYNAMIC_HUFFMAN_SETUP_ERROR;
-				}
-
-				res = lib_deflate_build_huffman(huffman, dc_i, dr->huffman_dc_tree);
+				res = lib_deflate_build_huffman(&huffman[lc_num], dc_num, &dr->huffman_dc);
 				if (unlikely(res < 0))
 					return res; // invalid table
 
@@ -401,8 +504,8 @@ lib_deflate_read(struct lib_deflate_reader *dr, uint8_t *buf, size_t buf_len)
 				size_t copylen = dr->copy_len;
 				if (copylen > buf_len - buf_pos)
 					copylen = buf_len - buf_pos;
-				if (copylen > 32768 - dr->lb_pos)
-					copylen = 32768 - dr->lb_pos;
+				if (copylen > dr->lb_mask + 1 - dr->lb_pos)
+					copylen = dr->lb_mask + 1 - dr->lb_pos;
 
 				uint8_t *rd_buf = &dr->look_behind[ dr->lb_pos ];
 				ssize_t res = dr->read(dr->read_p, rd_buf, copylen);
@@ -419,26 +522,27 @@ lib_deflate_read(struct lib_deflate_reader *dr, uint8_t *buf, size_t buf_len)
 				dr->copy_len -= copylen;
 
 				dr->lb_pos += copylen;
-				dr->lb_pos &= 32767;
-				if (dr->lb_size < 32768)
-					dr->lb_size += copylen;
+				dr->lb_pos &= dr->lb_mask;
+				dr->lb_size += copylen;
+				if (dr->lb_size > dr->lb_mask + 1)
+					dr->lb_size = dr->lb_mask + 1;
 			}
 			dr->state = LIB_DEFLATE_STATE_NEW_BLOCK;
 		}
 
-		if (dr->state == LIB_DEFLATE_STATE_HUFFMAN)
+		while (dr->state == LIB_DEFLATE_STATE_HUFFMAN && buf_pos < buf_len)
 		{ // huffman encoded block.
-			int token = lib_deflate_get_huffman(dr, dr->huffman_lc_tree);
+			int token = lib_deflate_get_huffman(dr, &dr->huffman_lc);
 			if (unlikely(token < 0))
 				return token;
 			if (token < 256)
-			{ // store token and return
+			{ // store token and continue
 				buf[buf_pos++] = token;
 
 				dr->look_behind[ dr->lb_pos ] = token;
 				dr->lb_pos++;
-				dr->lb_pos &= 32767;
-				if (dr->lb_size < 32768)
+				dr->lb_pos &= dr->lb_mask;
+				if (dr->lb_size <= dr->lb_mask)
 					dr->lb_size++;
 			}
 			else if (token == 256)
@@ -465,7 +569,7 @@ lib_deflate_read(struct lib_deflate_reader *dr, uint8_t *buf, size_t buf_len)
 				copy_len += clp[ token ];
 
 				// determine distance
-				int token = lib_deflate_get_huffman(dr, dr->huffman_dc_tree);
+				token = lib_deflate_get_huffman(dr, &dr->huffman_dc);
 				if (unlikely(token < 0))
 					return token;
 				if (unlikely(token >= 30))
@@ -478,7 +582,7 @@ lib_deflate_read(struct lib_deflate_reader *dr, uint8_t *buf, size_t buf_len)
 					0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13
 				};
 
-				int dist = dcb[ token ] ? lib_deflate_get_bits_long(dr, dcb[ token ]) : 0;
+				int dist = dcb[ token ] ? lib_deflate_get_bits(dr, dcb[ token ]) : 0;
 				if (unlikely(dist < 0))
 					return dist;
 				dist += dcp[ token ];
@@ -499,22 +603,37 @@ lib_deflate_read(struct lib_deflate_reader *dr, uint8_t *buf, size_t buf_len)
 				if (buf_pos >= buf_len)
 					return buf_pos;
 
-				// int copylen = dr->copy_len;
-				// copylen = buf_len - buf_pos if copylen > buf_len - buf_pos
-				// copylen = dr->copy_dist if copylen > dr->copy_dist
-				// copylen = 32768 - dr->lb_pos if copylen > 32768 - dr->lb_pos
-				// copylen = 32768 - pos if copylen > 32768 - pos
-				dr->copy_len--;
-				int pos = (dr->lb_pos - dr->copy_dist) & 32767;
-				int token = dr->look_behind[ pos ];
-
-				buf[buf_pos++] = token;
+				// copy in chunks that do not wrap around the end of look_behind
+				// and do not overlap with the data they are copied from
+				int pos = (dr->lb_pos - dr->copy_dist) & dr->lb_mask;
+				int copylen = dr->copy_len;
+				if (copylen > buf_len - buf_pos)
+					copylen = buf_len - buf_pos;
+				if (copylen > dr->lb_mask + 1 - dr->lb_pos)
+					copylen = dr->lb_mask + 1 - dr->lb_pos;
+				if (copylen > dr->lb_mask + 1 - pos)
+					copylen = dr->lb_mask + 1 - pos;
+
+				uint8_t *dst = &dr->look_behind[ dr->lb_pos ];
+				if (dr->copy_dist == 1)
+				{ // run of a single byte
+					memset(dst, dr->look_behind[ pos ], copylen);
+				}
+				else
+				{
+					if (copylen > dr->copy_dist)
+						copylen = dr->copy_dist;
+					memmove(dst, &dr->look_behind[ pos ], copylen);
+				}
+				memcpy(&buf[buf_pos], dst, copylen);
+				buf_pos += copylen;
 
-				dr->look_behind[ dr->lb_pos ] = token;
-				dr->lb_pos++;
-				dr->lb_pos &= 32767;
-				if (dr->lb_size < 32768)
-					dr->lb_size++;
+				dr->copy_len -= copylen;
+				dr->lb_pos += copylen;
+				dr->lb_pos &= dr->lb_mask;
+				dr->lb_size += copylen;
+				if (dr->lb_size > dr->lb_mask + 1)
+					dr->lb_size = dr->lb_mask + 1;
 			}
 			dr->state = LIB_DEFLATE_STATE_HUFFMAN;
 		}
@@ -526,5 +645,10 @@ lib_deflate_read(struct lib_deflate_reader *dr, uint8_t *buf, size_t buf_len)
 void
 lib_deflate_destroy(struct lib_deflate_reader *dr)
 {
-	free(dr);
+#if LIB_DEFLATE_POOL_SIZE > 0
+	dr = lib_deflate_pool_put(dr);
+	if (dr == NULL)
+		return;
+#endif
+	lib_deflate_free(dr);
 }
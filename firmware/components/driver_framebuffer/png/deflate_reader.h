@@ -23,32 +23,46 @@ enum lib_deflate_error_t {
 	LIB_DEFLATE_ERROR_DYNAMIC_HUFFMAN_SETUP_ERROR,
 	LIB_DEFLATE_ERROR_HUFFMAN_RESERVED_LENGTH,
 	LIB_DEFLATE_ERROR_HUFFMAN_INVALID_DISTANCE,
+	LIB_DEFLATE_ERROR_HUFFMAN_INVALID_CODE,
 	LIB_DEFLATE_ERROR_TOP,
 };
 
+#define LIB_DEFLATE_WINDOW_SIZE 32768 // largest distance a deflate stream may refer back to
+#define LIB_DEFLATE_FAST_BITS 9 // codes up to this length are decoded with a single table look-up
+
+struct lib_deflate_huffman {
+	uint16_t fast[1 << LIB_DEFLATE_FAST_BITS]; // (symbol << 4) | length, indexed by the next input bits; 0 for longer codes
+	uint16_t count[16];   // number of codes per length
+	uint16_t symbol[288]; // symbols ordered by code
+};
+
 struct lib_deflate_reader {
 	lib_reader_read_t read;
 	void *read_p;
 
-	uint8_t bitbuf[2];
+	uint32_t bitbuf; // next input bits, least significant bit first
 	uint8_t bitlen;
 
 	bool is_last_block;
 	enum lib_deflate_state_t state;
-	uint8_t look_behind[32768];
+	uint8_t *look_behind;
+	int lb_mask; // window size - 1, the window size is a power of two
 	int lb_size;
 	int lb_pos;
 
 	int copy_dist;
 	int copy_len;
 
-	uint16_t huffman_lc_tree[288+15];
-	uint16_t huffman_dc_tree[32+15];
+	bool huffman_static; // the tables currently hold the fixed codes
+	struct lib_deflate_huffman huffman_lc;
+	struct lib_deflate_huffman huffman_dc;
 };
 
 extern struct lib_deflate_reader * lib_deflate_new(lib_reader_read_t read, void *read_p);
+extern struct lib_deflate_reader * lib_deflate_new_sized(lib_reader_read_t read, void *read_p, size_t out_len);
 extern void lib_deflate_init(struct lib_deflate_reader *dr, lib_reader_read_t read, void *read_p);
 extern ssize_t lib_deflate_read(struct lib_deflate_reader *dr, uint8_t *buf, size_t buf_len);
 extern void lib_deflate_destroy(struct lib_deflate_reader *dr);
+extern void lib_deflate_pool_free(void);
 
 #endif // LIB_DEFLATE_READER_H
@@ -0,0 +1,326 @@
+// Checks and times the inflater against raw deflate streams made by zlib.
+//
+//   inflate_bench [-t] [-b read_size]
+//
+// Every stream is decoded through lib_mem_read with several read sizes and compared with its
+// input. With -t each stream is also decoded repeatedly, by this inflater, by the baseline one
+// when built with BASELINE=<rev>, and by zlib, and the output rate of each is reported.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "deflate_reader.h"
+#include "mem_reader.h"
+
+#ifdef HAVE_BASELINE
+extern void * base_deflate_new(lib_reader_read_t read, void *read_p);
+extern ssize_t base_deflate_read(void *dr, uint8_t *buf, size_t buf_len);
+extern void base_deflate_destroy(void *dr);
+#endif
+
+#define MIN_TIME 0.2 // seconds spent timing each decoder on each stream
+
+struct stream {
+	const char *data_name;
+	const char *mode_name;
+	const uint8_t *data;
+	size_t len;
+	uint8_t *packed;
+	size_t packed_len;
+};
+
+static const struct {
+	const char *name;
+	int level;
+	int strategy;
+} modes[] = {
+	{ "level 0",      0, Z_DEFAULT_STRATEGY },
+	{ "level 1",      1, Z_DEFAULT_STRATEGY },
+	{ "level 6",      6, Z_DEFAULT_STRATEGY },
+	{ "level 9",      9, Z_DEFAULT_STRATEGY },
+	{ "filtered",     6, Z_FILTERED },
+	{ "huffman only", 6, Z_HUFFMAN_ONLY },
+	{ "rle",          6, Z_RLE },
+	{ "fixed",        6, Z_FIXED },
+};
+
+static uint32_t rnd_state = 1;
+
+static uint32_t
+rnd(void)
+{
+	rnd_state = rnd_state * 1103515245 + 12345;
+	return rnd_state >> 8;
+}
+
+static double
+now(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static size_t
+make_text(uint8_t *buf, size_t len)
+{
+	static const char *words[] = {
+		"badge", "display", "frame", "buffer", "pixel", "the", "a", "of", "and", "to",
+		"flash", "image", "decode", "window", "stream", "block", "table", "code", "light",
+		"colour", "row", "byte", "read", "write", "Huffman", "length", "distance", "literal",
+	};
+	size_t pos = 0;
+	while (pos < len)
+	{
+		const char *w = words[rnd() % (sizeof(words) / sizeof(words[0]))];
+		while (*w && pos < len)
+			buf[pos++] = *w++;
+		if (pos < len)
+			buf[pos++] = (rnd() % 12) ? ' ' : '\n';
+	}
+	return len;
+}
+
+static size_t
+make_image(uint8_t *buf, size_t len)
+{ // PNG rows: sub filtered RGB gradients with some noise
+	const int width = 320;
+	const int stride = 1 + width * 3;
+	size_t rows = len / stride;
+	size_t y;
+	for (y=0; y<rows; y++)
+	{
+		uint8_t *row = &buf[y * stride];
+		uint8_t prev[3] = { 0, 0, 0 };
+		row[0] = 1;
+		int x;
+		for (x=0; x<width; x++)
+		{
+			int c;
+			for (c=0; c<3; c++)
+			{
+				uint8_t v = (x * (c + 1) + y * (3 - c)) / 4 + ((rnd() % 16 == 0) ? rnd() % 8 : 0);
+				row[1 + x * 3 + c] = v - prev[c];
+				prev[c] = v;
+			}
+		}
+	}
+	return rows * stride;
+}
+
+static size_t
+make_random(uint8_t *buf, size_t len)
+{
+	size_t i;
+	for (i=0; i<len; i++)
+		buf[i] = rnd();
+	return len;
+}
+
+static bool
+pack(struct stream *s, int level, int strategy)
+{
+	z_stream z;
+	memset(&z, 0, sizeof(z));
+	if (deflateInit2(&z, level, Z_DEFLATED, -15, 9, strategy) != Z_OK)
+		return false;
+	s->packed = malloc(deflateBound(&z, s->len));
+	if (s->packed == NULL)
+		return false;
+	z.next_in = (uint8_t *) s->data;
+	z.avail_in = s->len;
+	z.next_out = s->packed;
+	z.avail_out = deflateBound(&z, s->len);
+	int res = deflate(&z, Z_FINISH);
+	s->packed_len = z.total_out;
+	deflateEnd(&z);
+	return res == Z_STREAM_END;
+}
+
+static ssize_t
+inflate_lib(const struct stream *s, uint8_t *out, size_t read_size)
+{
+	struct lib_mem_reader *mr = lib_mem_new(s->packed, s->packed_len);
+	struct lib_deflate_reader *dr = lib_deflate_new_sized((lib_reader_read_t) &lib_mem_read, mr, s->len);
+	if (mr == NULL || dr == NULL)
+		return -1;
+	size_t pos = 0;
+	ssize_t res;
+	do
+	{
+		size_t n = s->len + 1 - pos < read_size ? s->len + 1 - pos : read_size;
+		res = lib_deflate_read(dr, &out[pos], n);
+		if (res > 0)
+			pos += res;
+	} while (res > 0 && pos <= s->len);
+	lib_deflate_destroy(dr);
+	lib_mem_destroy(mr);
+	return res < 0 ? res : (ssize_t) pos;
+}
+
+#ifdef HAVE_BASELINE
+static ssize_t
+inflate_base(const struct stream *s, uint8_t *out, size_t read_size)
+{
+	struct lib_mem_reader *mr = lib_mem_new(s->packed, s->packed_len);
+	void *dr = base_deflate_new((lib_reader_read_t) &lib_mem_read, mr);
+	if (mr == NULL || dr == NULL)
+		return -1;
+	size_t pos = 0;
+	ssize_t res;
+	do
+	{
+		size_t n = s->len + 1 - pos < read_size ? s->len + 1 - pos : read_size;
+		res = base_deflate_read(dr, &out[pos], n);
+		if (res > 0)
+			pos += res;
+	} while (res > 0 && pos <= s->len);
+	base_deflate_destroy(dr);
+	lib_mem_destroy(mr);
+	return res < 0 ? res : (ssize_t) pos;
+}
+#endif
+
+static ssize_t
+inflate_zlib(const struct stream *s, uint8_t *out, size_t read_size)
+{
+	z_stream z;
+	memset(&z, 0, sizeof(z));
+	if (inflateInit2(&z, -15) != Z_OK)
+		return -1;
+	z.next_in = s->packed;
+	z.avail_in = s->packed_len;
+	int res;
+	do
+	{
+		z.next_out = &out[z.total_out];
+		z.avail_out = s->len + 1 - z.total_out < read_size ? s->len + 1 - z.total_out : read_size;
+		res = inflate(&z, Z_NO_FLUSH);
+	} while (res == Z_OK && z.total_out <= s->len);
+	ssize_t len = z.total_out;
+	inflateEnd(&z);
+	return res == Z_STREAM_END ? len : -1;
+}
+
+typedef ssize_t (*inflate_t)(const struct stream *s, uint8_t *out, size_t read_size);
+
+static double
+rate(inflate_t fn, const struct stream *s, uint8_t *out, size_t read_size)
+{ // MB of output per second
+	int runs = 0;
+	double start = now();
+	double elapsed;
+	do
+	{
+		if (fn(s, out, read_size) != (ssize_t) s->len)
+			return 0;
+		runs++;
+		elapsed = now() - start;
+	} while (elapsed < MIN_TIME);
+	return (double) s->len * runs / elapsed / 1e6;
+}
+
+int
+main(int argc, char **argv)
+{
+	bool timing = false;
+	size_t bench_read_size = 4096;
+	int opt;
+	while ((opt = getopt(argc, argv, "tb:")) != -1)
+	{
+		if (opt == 't')
+			timing = true;
+		else if (opt == 'b' && atoi(optarg) > 0)
+			bench_read_size = atoi(optarg);
+		else
+		{
+			fprintf(stderr, "Usage: %s [-t] [-b read_size]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	static const struct {
+		const char *name;
+		size_t (*make)(uint8_t *buf, size_t len);
+		size_t len;
+	} kinds[] = {
+		{ "text",   make_text,   1 << 20 },
+		{ "image",  make_image,  1 << 20 },
+		{ "random", make_random, 256 << 10 },
+	};
+	static const size_t read_sizes[] = { 1, 7, 300, 4096, 1 << 20 };
+	const int num_kinds = sizeof(kinds) / sizeof(kinds[0]);
+	const int num_modes = sizeof(modes) / sizeof(modes[0]);
+
+	uint8_t *out = malloc((1 << 20) + 1);
+	if (out == NULL)
+		return 1;
+
+	if (timing)
+	{
+#ifdef HAVE_BASELINE
+		printf("%-6s %-12s %8s %10s %10s %10s %9s\n", "data", "mode", "ratio", "MB/s", "baseline", "zlib", "speedup");
+#else
+		printf("%-6s %-12s %8s %10s %10s\n", "data", "mode", "ratio", "MB/s", "zlib");
+#endif
+	}
+
+	int failures = 0;
+	int count = 0;
+	int k, m;
+	for (k=0; k<num_kinds; k++)
+	{
+		uint8_t *data = malloc(kinds[k].len);
+		if (data == NULL)
+			return 1;
+		size_t len = kinds[k].make(data, kinds[k].len);
+		for (m=0; m<num_modes; m++)
+		{
+			struct stream s = { kinds[k].name, modes[m].name, data, len, NULL, 0 };
+			if (!pack(&s, modes[m].level, modes[m].strategy))
+			{
+				fprintf(stderr, "zlib failed on %s, %s\n", s.data_name, s.mode_name);
+				return 1;
+			}
+			count++;
+
+			size_t r;
+			for (r=0; r<sizeof(read_sizes) / sizeof(read_sizes[0]); r++)
+			{
+				memset(out, 0, len);
+				ssize_t res = inflate_lib(&s, out, read_sizes[r]);
+				if (res != (ssize_t) len || memcmp(out, data, len) != 0)
+				{
+					printf("FAIL %s, %s, read size %zu: %zd\n", s.data_name, s.mode_name, read_sizes[r], res);
+					failures++;
+					break;
+				}
+			}
+
+			if (timing)
+			{
+				double lib = rate(inflate_lib, &s, out, bench_read_size);
+				double zlib = rate(inflate_zlib, &s, out, bench_read_size);
+				printf("%-6s %-12s %7.1f%% %10.1f", s.data_name, s.mode_name, 100.0 * s.packed_len / len, lib);
+#ifdef HAVE_BASELINE
+				double base = rate(inflate_base, &s, out, bench_read_size);
+				printf(" %10.1f %10.1f %8.1fx\n", base, zlib, base > 0 ? lib / base : 0);
+#else
+				printf(" %10.1f\n", zlib);
+#endif
+			}
+			free(s.packed);
+		}
+		free(data);
+	}
+	free(out);
+
+	printf("%s%d of %d streams decoded correctly\n", timing ? "\n" : "", count - failures, count);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,2 @@
+// Host build: the inflater without the ESP32 window placement and reader pool
+#pragma once
@@ -189,11 +189,206 @@ lib_png_paeth(uint8_t _a, uint8_t _b, uint8_t _c)
 	return _c;
 }
 
+// Row converters, one is selected per image based on the color type and bit depth.
+// They convert pixels x0 up to x1 of the current scanline to RGB24 colors, for
+// images with an alpha channel the alpha value is stored in the top byte and
+// true is returned.
+
+static bool
+lib_png_row_grey16(struct lib_png_reader *pr, uint32_t x0, uint32_t x1, uint32_t *row)
+{
+	const uint8_t *src = &pr->scanline[x0*2];
+	for (uint32_t x=x0; x<x1; x++, src+=2)
+		*row++ = src[0] * 0x010101;
+	return false;
+}
+
+static bool
+lib_png_row_grey8(struct lib_png_reader *pr, uint32_t x0, uint32_t x1, uint32_t *row)
+{
+	const uint8_t *src = &pr->scanline[x0];
+	for (uint32_t x=x0; x<x1; x++)
+		*row++ = *src++ * 0x010101;
+	return false;
+}
+
+static bool
+lib_png_row_grey_packed(struct lib_png_reader *pr, uint32_t x0, uint32_t x1, uint32_t *row)
+{
+	uint8_t depth = pr->ihdr.bit_depth;
+	uint8_t mask  = (1 << depth) - 1;
+	uint32_t scale = (255 / mask) * 0x010101;
+	for (uint32_t x=x0; x<x1; x++)
+	{
+		uint32_t bit = x * depth;
+		*row++ = ((pr->scanline[bit >> 3] >> (8 - depth - (bit & 7))) & mask) * scale;
+	}
+	return false;
+}
+
+static bool
+lib_png_row_rgb16(struct lib_png_reader *pr, uint32_t x0, uint32_t x1, uint32_t *row)
+{
+	const uint8_t *src = &pr->scanline[x0*6];
+	for (uint32_t x=x0; x<x1; x++, src+=6)
+		*row++ = (src[0] << 16) | (src[2] << 8) | src[4];
+	return false;
+}
+
+static bool
+lib_png_row_rgb8(struct lib_png_reader *pr, uint32_t x0, uint32_t x1, uint32_t *row)
+{
+	const uint8_t *src = &pr->scanline[x0*3];
+	for (uint32_t x=x0; x<x1; x++, src+=3)
+		*row++ = (src[0] << 16) | (src[1] << 8) | src[2];
+	return false;
+}
+
+static bool
+lib_png_row_palette8(struct lib_png_reader *pr, uint32_t x0, uint32_t x1, uint32_t *row)
+{
+	const uint8_t *src = &pr->scanline[x0];
+	for (uint32_t x=x0; x<x1; x++)
+		*row++ = pr->palette_lut[*src++];
+	return false;
+}
+
+static bool
+lib_png_row_palette_packed(struct lib_png_reader *pr, uint32_t x0, uint32_t x1, uint32_t *row)
+{
+	uint8_t depth = pr->ihdr.bit_depth;
+	uint8_t mask  = (1 << depth) - 1;
+	for (uint32_t x=x0; x<x1; x++)
+	{
+		uint32_t bit = x * depth;
+		*row++ = pr->palette_lut[(pr->scanline[bit >> 3] >> (8 - depth - (bit & 7))) & mask];
+	}
+	return false;
+}
+
+static inline uint32_t
+lib_png_alpha16(const uint8_t *src)
+{
+	// keep pixels with a low but non-zero alpha value visible
+	return (uint32_t) (src[0] ? src[0] : (src[1] ? 1 : 0)) << 24;
+}
+
+static bool
+lib_png_row_grey_alpha16(struct lib_png_reader *pr, uint32_t x0, uint32_t x1, uint32_t *row)
+{
+	const uint8_t *src = &pr->scanline[x0*4];
+	for (uint32_t x=x0; x<x1; x++, src+=4)
+		*row++ = lib_png_alpha16(&src[2]) | (src[0] * 0x010101);
+	return true;
+}
+
+static bool
+lib_png_row_grey_alpha8(struct lib_png_reader *pr, uint32_t x0, uint32_t x1, uint32_t *row)
+{
+	const uint8_t *src = &pr->scanline[x0*2];
+	for (uint32_t x=x0; x<x1; x++, src+=2)
+		*row++ = ((uint32_t) src[1] << 24) | (src[0] * 0x010101);
+	return true;
+}
+
+static bool
+lib_png_row_rgba16(struct lib_png_reader *pr, uint32_t x0, uint32_t x1, uint32_t *row)
+{
+	const uint8_t *src = &pr->scanline[x0*8];
+	for (uint32_t x=x0; x<x1; x++, src+=8)
+		*row++ = lib_png_alpha16(&src[6]) | (src[0] << 16) | (src[2] << 8) | src[4];
+	return true;
+}
+
+static bool
+lib_png_row_rgba8(struct lib_png_reader *pr, uint32_t x0, uint32_t x1, uint32_t *row)
+{
+	const uint8_t *src = &pr->scanline[x0*4];
+	for (uint32_t x=x0; x<x1; x++, src+=4)
+		*row++ = ((uint32_t) src[3] << 24) | (src[0] << 16) | (src[1] << 8) | src[2];
+	return true;
+}
+
+static lib_png_row_converter_t
+lib_png_row_converter(struct lib_png_reader *pr)
+{
+	bool wide = pr->ihdr.bit_depth == 16;
+	switch (pr->ihdr.color_type)
+	{
+		case 0:
+			if (wide)
+				return lib_png_row_grey16;
+			return pr->ihdr.bit_depth == 8 ? lib_png_row_grey8 : lib_png_row_grey_packed;
+		case 2:
+			return wide ? lib_png_row_rgb16 : lib_png_row_rgb8;
+		case 3:
+			return pr->ihdr.bit_depth == 8 ? lib_png_row_palette8 : lib_png_row_palette_packed;
+		case 4:
+			return wide ? lib_png_row_grey_alpha16 : lib_png_row_grey_alpha8;
+		case 6:
+			return wide ? lib_png_row_rgba16 : lib_png_row_rgba8;
+	}
+	return NULL;
+}
+
+static inline void
+lib_png_write_row(Window* window, uint32_t *row, uint32_t count, bool alpha, int16_t x, int16_t y)
+{
+#ifdef CONFIG_DRIVER_FRAMEBUFFER_ENABLE
+	if (!alpha)
+	{
+		driver_framebuffer_setPixels(window, x, y, row, count);
+		return;
+	}
+
+	// write the runs of visible pixels, fully transparent pixels are skipped
+	uint32_t start = 0;
+	while (start < count)
+	{
+		while (start < count && (row[start] >> 24) == 0)
+			start++;
+		uint32_t end = start;
+		while (end < count && (row[end] >> 24) != 0)
+		{
+			row[end] &= 0xffffff;
+			end++;
+		}
+		if (end > start)
+			driver_framebuffer_setPixels(window, x + start, y, &row[start], end - start);
+		start = end;
+	}
+#endif
+}
+
+static void
+lib_png_mask_row(struct lib_png_reader *pr, const uint32_t *row, uint32_t x0, uint32_t x1, bool alpha, uint32_t y)
+{
+	// mark the visible pixels, the mask has a bit per pixel and rows start at a byte boundary
+	uint8_t *mask = &pr->mask[y * ((pr->ihdr.width + 7) >> 3)];
+	for (uint32_t x=x0; x<x1; x++)
+	{
+		if (!alpha || (row[x - x0] >> 24) != 0)
+			mask[x >> 3] |= 0x80 >> (x & 7);
+		else
+			mask[x >> 3] &= ~(0x80 >> (x & 7));
+	}
+}
+
 static inline int
 lib_png_decode(Window* window, struct lib_png_reader *pr, uint32_t width, uint32_t height, uint32_t scanline_width, uint16_t offset_x, uint16_t offset_y, uint32_t dst_min_x, uint32_t dst_min_y, uint32_t dst_width, uint32_t dst_height, uint32_t dst_pixlen, uint32_t dst_linelen)
 {
 	memset(pr->scanline, 0, scanline_width);
 
+	lib_png_row_converter_t convert = lib_png_row_converter(pr);
+	if (convert == NULL)
+		return -LIB_PNG_ERROR_INVALID_PNG_TYPE;
+
+	// only the visible part of each row is converted
+	uint32_t x_start = dst_min_x;
+	uint32_t x_end = width < dst_width ? width : dst_width;
+	if (x_end > x_start + 0x7fff)
+		x_end = x_start + 0x7fff;
+
 	uint32_t y;
 	for (y=0; y<height; y++)
 	{
@@ -285,114 +480,12 @@ lib_png_decode(Window* window, struct lib_png_reader *pr, uint32_t width, uint32
 				return -LIB_PNG_ERROR_INVALID_PNG_SCANLINE_TYPE;
 		}
 
-		for (x=0; x<width; x++)
+		if (y >= dst_min_y && y < dst_height && x_start < x_end)
 		{
-			uint16_t r=0, g=0, b=0, a=0;
-			switch (pr->ihdr.color_type)
-			{
-				case 0:
-					a = 0xffff;
-					switch (pr->ihdr.bit_depth)
-					{
-						case 16:
-							r = g = b = (pr->scanline[x*2 + 0] << 8) | pr->scanline[x*2 + 1];
-							break;
-						case 8:
-							r = g = b = pr->scanline[x] * 0x0101;
-							break;
-						case 4:
-							r = g = b = ((pr->scanline[x>>1] >> (((x^1)&1)*4)) & 15) * 0x1111;
-							break;
-						case 2:
-							r = g = b = ((pr->scanline[x>>2] >> (((x^3)&3)*2)) & 3) * 0x5555;
-							break;
-						case 1:
-							r = g = b = ((pr->scanline[x>>3] >> ((x^7)&7)) & 1) * 0xffff;
-							break;
-					}
-					break;
-				case 2:
-					a = 0xffff;
-					switch (pr->ihdr.bit_depth)
-					{
-						case 16:
-							r = (pr->scanline[x*6 + 0] << 8) | pr->scanline[x*6 + 1];
-							g = (pr->scanline[x*6 + 2] << 8) | pr->scanline[x*6 + 3];
-							b = (pr->scanline[x*6 + 4] << 8) | pr->scanline[x*6 + 5];
-							break;
-						case 8:
-							r = pr->scanline[x*3 + 0] * 0x0101;
-							g = pr->scanline[x*3 + 1] * 0x0101;
-							b = pr->scanline[x*3 + 2] * 0x0101;
-							break;
-					}
-					break;
-				case 3:
-					a = 0xffff;
-					switch (pr->ihdr.bit_depth)
-					{
-						case 8:
-							b = pr->scanline[x];
-							break;
-						case 4:
-							b = (pr->scanline[x>>1] >> (((x^1)&1)*4)) & 15;
-							break;
-						case 2:
-							b = (pr->scanline[x>>2] >> (((x^3)&3)*2)) & 3;
-							break;
-						case 1:
-							b = (pr->scanline[x>>3] >> ((x^7)&7)) & 1;
-							break;
-					}
-					if (b < pr->palette_len)
-					{
-						r = pr->palette[b*3 + 0] * 0x0101;
-						g = pr->palette[b*3 + 1] * 0x0101;
-						b = pr->palette[b*3 + 2] * 0x0101;
-					}
-					else
-					{
-						r = g = b = 0; // or should this be an error?
-					}
-					break;
-				case 4:
-					switch (pr->ihdr.bit_depth)
-					{
-						case 16:
-							r = g = b = (pr->scanline[x*4 + 0] << 8) | pr->scanline[x*4 + 1];
-							a = (pr->scanline[x*4 + 2] << 8) | pr->scanline[x*4 + 3];
-							break;
-						case 8:
-							r = g = b = pr->scanline[x*2 + 0] * 0x0101;
-							a = pr->scanline[x*2 + 1] * 0x0101;
-							break;
-					}
-					break;
-				case 6:
-					switch (pr->ihdr.bit_depth)
-					{
-						case 16:
-							r = (pr->scanline[x*8 + 0] << 8) | pr->scanline[x*8 + 1];
-							g = (pr->scanline[x*8 + 2] << 8) | pr->scanline[x*8 + 3];
-							b = (pr->scanline[x*8 + 4] << 8) | pr->scanline[x*8 + 5];
-							a = (pr->scanline[x*8 + 6] << 8) | pr->scanline[x*8 + 7];
-							break;
-						case 8:
-							r = pr->scanline[x*4 + 0] * 0x0101;
-							g = pr->scanline[x*4 + 1] * 0x0101;
-							b = pr->scanline[x*4 + 2] * 0x0101;
-							a = pr->scanline[x*4 + 3] * 0x0101;
-							break;
-					}
-					break;
-			}
-
-			if (a != 0 && x >= dst_min_x && x < dst_width && y >= dst_min_y && y < dst_height)
-			{
-				#ifdef CONFIG_DRIVER_FRAMEBUFFER_ENABLE
-				driver_framebuffer_setPixel(window, offset_x + x, offset_y + y, ((r>>8)<<16)+((g>>8)<<8)+(b>>8));
-				#endif
-			}
+			bool alpha = convert(pr, x_start, x_end, pr->row);
+			if (pr->mask != NULL)
+				lib_png_mask_row(pr, pr->row, x_start, x_end, alpha, y);
+			lib_png_write_row(window, pr->row, x_end - x_start, alpha, offset_x + x_start, offset_y + y);
 		}
 	}
 
@@ -558,6 +651,21 @@ int lib_png_load_image(Window* window, struct lib_png_reader *pr, uint16_t offse
 	if (pr->scanline == NULL)
 		return -LIB_PNG_ERROR_OUT_OF_MEMORY;
 
+	// allocate converted row
+	pr->row = (uint32_t *) malloc(pr->ihdr.width * sizeof(uint32_t));
+	if (pr->row == NULL)
+		return -LIB_PNG_ERROR_OUT_OF_MEMORY;
+
+	// look-up table for palette colors, unused entries are black
+	if (pr->ihdr.color_type == 3)
+	{
+		pr->palette_lut = (uint32_t *) calloc(256, sizeof(uint32_t));
+		if (pr->palette_lut == NULL)
+			return -LIB_PNG_ERROR_OUT_OF_MEMORY;
+		for (int i=0; i<pr->palette_len; i++)
+			pr->palette_lut[i] = (pr->palette[i*3 + 0] << 16) | (pr->palette[i*3 + 1] << 8) | pr->palette[i*3 + 2];
+	}
+
 	// start parsing IDAT
 	uint8_t rfc1950_hdr[2];
 	res = lib_png_chunk_read_idat(pr, rfc1950_hdr, 2);
@@ -575,7 +683,12 @@ int lib_png_load_image(Window* window, struct lib_png_reader *pr, uint16_t offse
 	if (((rfc1950_hdr[0] << 8) + rfc1950_hdr[1]) % 31 != 0) // check checksum
 		return -LIB_PNG_ERROR_INVALID_DEFLATE_HEADER;
 
-	pr->dr = lib_deflate_new((lib_reader_read_t) &lib_png_chunk_read_idat, pr);
+	// small images fit in a window smaller than the default 32 KB
+	size_t out_len = LIB_DEFLATE_WINDOW_SIZE;
+	if (pr->ihdr.interlace_method == 0 && pr->ihdr.height < LIB_DEFLATE_WINDOW_SIZE && pr->scanline_width < LIB_DEFLATE_WINDOW_SIZE)
+		out_len = (pr->scanline_width + 1) * pr->ihdr.height;
+
+	pr->dr = lib_deflate_new_sized((lib_reader_read_t) &lib_png_chunk_read_idat, pr, out_len);
 	if (pr->dr == NULL)
 		return -LIB_PNG_ERROR_OUT_OF_MEMORY;
 
@@ -653,6 +766,14 @@ lib_png_destroy(struct lib_png_reader *pr)
 		free(pr->scanline);
 	pr->scanline = NULL;
 
+	if (pr->row)
+		free(pr->row);
+	pr->row = NULL;
+
+	if (pr->palette_lut)
+		free(pr->palette_lut);
+	pr->palette_lut = NULL;
+
 	if (pr->dr)
 		lib_deflate_destroy(pr->dr);
 	pr->dr = NULL;
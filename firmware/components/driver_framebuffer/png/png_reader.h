@@ -63,11 +63,16 @@ struct lib_png_reader {
 	uint8_t scanline_bpp; // 1, 2, 3, 4, 6 or 8
 	uint32_t scanline_width;
 	uint8_t *scanline; // large enough for scanline + temp secondary scanline
+	uint32_t *row; // converted pixels of the current scanline
+	uint32_t *palette_lut; // palette as RGB24 colors
+	uint8_t *mask; // optional, owned by the caller; gets a bit per pixel set for the visible pixels
 
 	struct lib_deflate_reader *dr;
 	uint32_t adler;
 };
 
+typedef bool (*lib_png_row_converter_t)(struct lib_png_reader *pr, uint32_t x0, uint32_t x1, uint32_t *row);
+
 extern struct lib_png_reader * lib_png_new(lib_reader_read_t read, void *read_p);
 extern int lib_png_read_header(struct lib_png_reader *pr);
 extern int lib_png_load_image(Window *window, struct lib_png_reader *pr, uint16_t offset_x, uint16_t offset_y, uint32_t dst_min_x, uint32_t dst_min_y, uint32_t dst_width, uint32_t dst_height, uint32_t dst_linelen);
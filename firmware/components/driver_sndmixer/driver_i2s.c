@@ -1,8 +1,20 @@
 #include <sdkconfig.h>
 #include "driver_i2s.h"
+#include "sndmixer.h"
 
 #ifdef CONFIG_DRIVER_SNDMIXER_ENABLE
 
+#ifdef CONFIG_DRIVER_SNDMIXER_I2S_PORT1
+#define I2S_PORT 1
+#else
+#define I2S_PORT 0
+#endif
+
+// One DMA buffer holds one mixer block, so that every write fills whole buffers.
+#define DMA_BUF_LEN (SNDMIXER_BLOCK_SIZE > 1024 ? 1024 : SNDMIXER_BLOCK_SIZE)
+
+#define SAT(x, min, max) ((x > max) ? max : (x < min) ? min : x)
+
 struct Config {
   uint8_t volume;
 } config;
@@ -45,15 +57,11 @@ void driver_i2s_sound_start() {
     .communication_format = I2S_COMM_FORMAT_I2S,
 #endif
     .intr_alloc_flags = 0,
-    .dma_buf_count    = 4,
-    .dma_buf_len      = buffsize / 4
+    .dma_buf_count    = SAT(buffsize / DMA_BUF_LEN, 2, 128),
+    .dma_buf_len      = DMA_BUF_LEN
   };
 
-#ifdef DRIVER_SNDMIXER_I2S_PORT1
-  const i2s_port_t port = 1;
-#else
-  const i2s_port_t port = 0;
-#endif
+  const i2s_port_t port = I2S_PORT;
 
   i2s_driver_install(port, &cfg, 4, &soundQueue);
   i2s_set_sample_rates(port, cfg.sample_rate);
@@ -79,47 +87,12 @@ void driver_i2s_sound_start() {
 }
 
 void driver_i2s_sound_stop() {
-    #ifdef DRIVER_SNDMIXER_I2S_PORT1
-  const i2s_port_t port = 1;
-#else
-  const i2s_port_t port = 0;
-#endif
-  i2s_driver_uninstall(port);
+  i2s_driver_uninstall(I2S_PORT);
 }
 
-#define SND_CHUNKSZ 32
-void driver_i2s_sound_push(int16_t *buf, int len, int stereo_input) {
-  uint16_t tmpb[SND_CHUNKSZ * 2];
-  int i = 0;
-  while (i < len) {
-    int plen = len - i;
-    if (plen > SND_CHUNKSZ) {
-      plen = SND_CHUNKSZ;
-    }
-    for (int sample = 0; sample < plen; sample++) {
-      int32_t s[2] = {0, 0};
-      if (stereo_input) {
-        s[0] = buf[(i + sample) * 2 + 0];
-        s[1] = buf[(i + sample) * 2 + 1];
-      } else {
-        s[0] = s[1] = buf[i + sample];
-      }
-      // Multiply with volume/volume_max, then offset to [0:UINT16_MAX]
-      s[0]                       = s[0] * config.volume / (256*128) - INT16_MIN;
-      s[1]                       = s[1] * config.volume / (256*128) - INT16_MIN;
-      tmpb[(i + sample) * 2 + 0] = s[0];
-      tmpb[(i + sample) * 2 + 1] = s[1];
-    }
-
-#ifdef DRIVER_SNDMIXER_I2S_PORT1
-    const i2s_port_t port = 1;
-#else
-    const i2s_port_t port = 0;
-#endif
-
-    i2s_write_bytes(port, (char *)tmpb, plen * 2 * sizeof(tmpb[0]), portMAX_DELAY);
-    i += plen;
-  }
+void driver_i2s_sound_write(const uint16_t *frames, int len) {
+  size_t written;
+  i2s_write(I2S_PORT, frames, len * 2 * sizeof(frames[0]), &written, portMAX_DELAY);
 }
 
 void driver_i2s_set_volume(uint8_t new_volume) {
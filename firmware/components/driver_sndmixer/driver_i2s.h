@@ -1,3 +1,5 @@
+#pragma once
+#include <sdkconfig.h>
 #include <string.h>
 #include <stdint.h>
 #include "freertos/FreeRTOS.h"
@@ -20,8 +22,16 @@ void driver_i2s_sound_start();
 // Stop audio output driver
 void driver_i2s_sound_stop();
 
-// Push audio to the driver
-void driver_i2s_sound_push(int16_t *buf, int len, int stereo);
+// Samples in the DMA format are unsigned for the internal DAC, signed for external ones. Adding
+// this converts a signed sample.
+#ifdef CONFIG_DRIVER_SNDMIXER_I2S_DAC_INTERNAL
+#define DRIVER_I2S_SAMPLE_OFFSET 0x8000
+#else
+#define DRIVER_I2S_SAMPLE_OFFSET 0
+#endif
+
+// Push audio that is already in the DMA format: len frames of two 16-bit samples
+void driver_i2s_sound_write(const uint16_t *frames, int len);
 
 // Set the volume (0-255)
 void driver_i2s_set_volume(uint8_t new_volume);
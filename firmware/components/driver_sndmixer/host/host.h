@@ -0,0 +1,9 @@
+#pragma once
+#include <stdint.h>
+
+// Show the messages of the mixer and its sources
+extern int host_verbose;
+
+// Runs the mixer task until it has written frames frames to I2S, and stores them in out as
+// interleaved stereo. frames must be a multiple of SNDMIXER_BLOCK_SIZE.
+void host_render(int16_t *out, int frames);
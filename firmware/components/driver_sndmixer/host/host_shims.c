@@ -0,0 +1,248 @@
+// FreeRTOS, esp_timer, heap and I2S output for running the sound mixer on a PC.
+//
+// The mixer task is not started as a thread. host_render runs it on the calling thread until it
+// has written the requested frames, then jumps back out of driver_i2s_sound_write. Commands sent
+// in between are handled at the start of the next block, so renders do not depend on timing.
+// Other tasks, like the MP3 decoder with CONFIG_DRIVER_SNDMIXER_MP3_DECODE_AHEAD, are threads.
+
+#include <pthread.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_heap_caps.h"
+#include "driver_i2s.h"
+#include "sndmixer.h"
+#include "host.h"
+
+int host_verbose;
+
+int host_log(const char *fmt, ...) {
+  if (!host_verbose)
+    return 0;
+  va_list ap;
+  va_start(ap, fmt);
+  int r = vprintf(fmt, ap);
+  va_end(ap);
+  return r;
+}
+
+void uxPortCompareSet(volatile uint32_t *addr, uint32_t compare, uint32_t *set) {
+  uint32_t expected = compare;
+  if (!__atomic_compare_exchange_n(addr, &expected, *set, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+    *set = expected;
+  else
+    *set = compare;
+}
+
+/* Queues */
+
+// Queues never fill up: the mixer only runs inside host_render, so a full queue would keep the
+// harness waiting forever.
+typedef struct {
+  pthread_mutex_t lock;
+  int item_size;
+  int head, count, size;
+  uint8_t *items;
+} host_queue_t;
+
+QueueHandle_t xQueueCreate(int length, int item_size) {
+  host_queue_t *q = calloc(1, sizeof(host_queue_t));
+  if (!q)
+    return NULL;
+  pthread_mutex_init(&q->lock, NULL);
+  q->item_size = item_size;
+  q->size      = length;
+  q->items     = malloc(length * item_size);
+  if (!q->items) {
+    free(q);
+    return NULL;
+  }
+  return q;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+  host_queue_t *q = queue;
+  free(q->items);
+  free(q);
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait) {
+  host_queue_t *q = queue;
+  pthread_mutex_lock(&q->lock);
+  if (q->count == q->size) {
+    uint8_t *items = malloc(q->size * 2 * q->item_size);
+    if (!items) {
+      pthread_mutex_unlock(&q->lock);
+      return pdFALSE;
+    }
+    for (int i = 0; i < q->count; i++)
+      memcpy(items + i * q->item_size, q->items + ((q->head + i) % q->size) * q->item_size,
+             q->item_size);
+    free(q->items);
+    q->items = items;
+    q->head  = 0;
+    q->size *= 2;
+  }
+  memcpy(q->items + ((q->head + q->count) % q->size) * q->item_size, item, q->item_size);
+  q->count++;
+  pthread_mutex_unlock(&q->lock);
+  return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait) {
+  host_queue_t *q = queue;
+  pthread_mutex_lock(&q->lock);
+  int r = (q->count > 0);
+  if (r) {
+    memcpy(item, q->items + q->head * q->item_size, q->item_size);
+    q->head = (q->head + 1) % q->size;
+    q->count--;
+  }
+  pthread_mutex_unlock(&q->lock);
+  return r ? pdTRUE : pdFALSE;
+}
+
+/* Tasks */
+
+typedef struct {
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  uint32_t notified;
+  void (*fn)(void *);
+  void *arg;
+} host_task_t;
+
+static __thread host_task_t *current_task;
+static void (*mixer_task)(void *);
+static void *mixer_arg;
+
+static void *task_main(void *arg) {
+  current_task = arg;
+  current_task->fn(current_task->arg);
+  return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(void (*fn)(void *), const char *name, uint32_t stack, void *arg,
+                                   int priority, TaskHandle_t *handle, int core) {
+  if (strcmp(name, "sndmixer") == 0) {
+    mixer_task = fn;
+    mixer_arg  = arg;
+    if (handle)
+      *handle = NULL;
+    return pdTRUE;
+  }
+  host_task_t *t = calloc(1, sizeof(host_task_t));
+  if (!t)
+    return pdFALSE;
+  pthread_mutex_init(&t->lock, NULL);
+  pthread_cond_init(&t->cond, NULL);
+  t->fn  = fn;
+  t->arg = arg;
+  if (pthread_create(&t->thread, NULL, task_main, t) != 0) {
+    free(t);
+    return pdFALSE;
+  }
+  pthread_detach(t->thread);
+  if (handle)
+    *handle = t;
+  return pdTRUE;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  // Tasks only ever delete themselves
+  if (current_task) {
+    host_task_t *t = current_task;
+    current_task   = NULL;
+    pthread_mutex_destroy(&t->lock);
+    pthread_cond_destroy(&t->cond);
+    free(t);
+    pthread_exit(NULL);
+  }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait) {
+  host_task_t *t = current_task;
+  pthread_mutex_lock(&t->lock);
+  while (!t->notified)
+    pthread_cond_wait(&t->cond, &t->lock);
+  uint32_t r = t->notified;
+  t->notified = clear ? 0 : r - 1;
+  pthread_mutex_unlock(&t->lock);
+  return r;
+}
+
+void xTaskNotifyGive(TaskHandle_t task) {
+  host_task_t *t = task;
+  pthread_mutex_lock(&t->lock);
+  t->notified++;
+  pthread_cond_signal(&t->cond);
+  pthread_mutex_unlock(&t->lock);
+}
+
+/* Memory */
+
+void *heap_caps_malloc(size_t size, uint32_t caps) {
+  return malloc(size);
+}
+
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps) {
+  return calloc(n, size);
+}
+
+void heap_caps_free(void *ptr) {
+  free(ptr);
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+  return (caps & MALLOC_CAP_SPIRAM) ? 4000 * 1024 : 160 * 1024;
+}
+
+/* I2S output */
+
+static uint8_t volume = 255;
+static int16_t *render_out;
+static int render_left;
+static jmp_buf render_done;
+
+void driver_i2s_sound_start() {}
+
+void driver_i2s_sound_stop() {}
+
+void driver_i2s_sound_mute(int doMute) {}
+
+void driver_i2s_set_volume(uint8_t new_volume) {
+  volume = new_volume;
+}
+
+uint8_t driver_i2s_get_volume() {
+  return volume;
+}
+
+int host_master_volume(void) {
+  return volume * 128;
+}
+
+void driver_i2s_sound_write(const uint16_t *frames, int len) {
+  for (int i = 0; i < len * 2; i++)
+    render_out[i] = (int16_t)(frames[i] - DRIVER_I2S_SAMPLE_OFFSET);
+  render_out += len * 2;
+  render_left -= len;
+  if (render_left <= 0)
+    longjmp(render_done, 1);
+}
+
+void host_render(int16_t *out, int frames) {
+  if (frames <= 0)
+    return;
+  render_out  = out;
+  render_left = frames;
+  if (!setjmp(render_done))
+    mixer_task(mixer_arg);
+}
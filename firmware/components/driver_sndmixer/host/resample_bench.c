@@ -0,0 +1,129 @@
+// Quality and speed of the channel resamplers. A sine tone at the source rate is converted to the
+// output rate, and the level of its first image is measured against the tone. A tone above the
+// Nyquist frequency of the output is measured where it aliases to, against the input level. Then every resampler converts the same buffer repeatedly, mono and
+// stereo, to measure output frames per second.
+//
+//   resample_bench [tone_hz [source_rate [output_rate]]]
+//
+// Defaults: a 7 kHz tone at 22050 Hz played at 44100 Hz, which puts the image at 15050 Hz.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sndmixer.h"
+#include "snd_resample.h"
+
+#define SOURCE_SECONDS 2
+#define SPEED_RUNS     50
+#define ANALYSIS_LEN   8192
+
+static const char *names[] = {"nearest", "linear", "sinc"};
+
+static double now(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+// Converts n output frames, starting at the first source frame
+static void resample(int mode, const int16_t *table, const int16_t *buffer, int stereo,
+                     uint32_t rate, int32_t *out, int n) {
+  uint32_t acc = 0;
+  if (mode == SNDMIXER_RESAMPLE_SINC)
+    resample_sinc(table, buffer, stereo, &acc, rate, out, n);
+  else if (mode == SNDMIXER_RESAMPLE_LINEAR)
+    resample_linear(buffer, stereo, &acc, rate, out, n);
+  else
+    resample_nearest(buffer, stereo, &acc, rate, out, n);
+}
+
+// Magnitude of frequency f in a Hann windowed piece of the output
+static double magnitude(const int32_t *s, int n, double f, int rate) {
+  double re = 0, im = 0;
+  for (int i = 0; i < n; i++) {
+    double w  = 0.5 - 0.5 * cos(2 * M_PI * i / n);
+    double ph = 2 * M_PI * f * i / rate;
+    re += s[i] * w * cos(ph);
+    im += s[i] * w * sin(ph);
+  }
+  return hypot(re, im);
+}
+
+int main(int argc, char **argv) {
+  double tone     = argc > 1 ? atof(argv[1]) : 7000;
+  int source_rate = argc > 2 ? atoi(argv[2]) : 22050;
+  int output_rate = argc > 3 ? atoi(argv[3]) : 44100;
+  if (tone <= 0 || tone >= source_rate / 2.0 || output_rate <= 0) {
+    fprintf(stderr, "Usage: %s [tone_hz [source_rate [output_rate]]]\n", argv[0]);
+    return 2;
+  }
+
+  // Where the first image of the tone, or the tone itself when the output can't carry it, ends up
+  int aliased  = tone >= output_rate / 2.0;
+  double image = fmod(aliased ? tone : source_rate - tone, output_rate);
+  if (image > output_rate / 2.0)
+    image = output_rate - image;
+  if (!aliased && fabs(image - tone) < 1) {
+    fprintf(stderr, "The image of a %.0f Hz tone lands on the tone itself\n", tone);
+    return 2;
+  }
+
+  int frames     = source_rate * SOURCE_SECONDS;
+  uint32_t rate  = ((uint64_t)source_rate << 16) / output_rate;
+  int out_frames = (uint64_t)(frames - 1) * 0x10000 / rate - 1;
+  // The resamplers look up to RESAMPLE_HISTORY frames back, so the buffers start with silence.
+  int16_t *mono   = calloc(RESAMPLE_HISTORY + frames, sizeof(int16_t));
+  int16_t *stereo = calloc((RESAMPLE_HISTORY + frames) * 2, sizeof(int16_t));
+  int32_t *out    = malloc(out_frames * 2 * sizeof(int32_t));
+  int16_t *table  = resample_sinc_table(rate);
+  if (!mono || !stereo || !out || !table) {
+    fprintf(stderr, "Out of memory\n");
+    return 1;
+  }
+  for (int i = 0; i < frames; i++) {
+    int16_t s = lrint(16000 * sin(2 * M_PI * tone * i / source_rate));
+    mono[RESAMPLE_HISTORY + i]               = s;
+    stereo[(RESAMPLE_HISTORY + i) * 2 + 0] = s;
+    stereo[(RESAMPLE_HISTORY + i) * 2 + 1] = -s;
+  }
+  const int16_t *mono_src   = mono + RESAMPLE_HISTORY;
+  const int16_t *stereo_src = stereo + RESAMPLE_HISTORY * 2;
+  if (out_frames < ANALYSIS_LEN * 2) {
+    fprintf(stderr, "Output rate too low for the analysis\n");
+    return 1;
+  }
+
+  printf("%.0f Hz tone at %d Hz, played at %d Hz: %s at %.0f Hz\n\n", tone, source_rate,
+         output_rate, aliased ? "alias" : "image", image);
+  printf("%-8s %8s %8s %14s %14s\n", "", "tone", "image", "mono", "stereo");
+  for (int mode = 0; mode < 3; mode++) {
+    resample(mode, table, mono_src, 0, rate, out, out_frames);
+    const int32_t *piece = out + (out_frames - ANALYSIS_LEN) / 2;
+    double level         = magnitude(piece, ANALYSIS_LEN, tone, output_rate);
+    double image_level   = magnitude(piece, ANALYSIS_LEN, image, output_rate);
+    // A full Hann windowed sine of amplitude A has magnitude A * n / 4
+    double tone_db  = 20 * log10(level / (16000.0 * ANALYSIS_LEN / 4));
+    double image_db = 20 * log10(image_level / (aliased ? 16000.0 * ANALYSIS_LEN / 4 : level));
+
+    double speed[2];
+    for (int st = 0; st < 2; st++) {
+      double start = now();
+      for (int r = 0; r < SPEED_RUNS; r++)
+        resample(mode, table, st ? stereo_src : mono_src, st, rate, out, out_frames);
+      speed[st] = (double)out_frames * SPEED_RUNS / (now() - start) / 1e6;
+    }
+    if (aliased)
+      printf("%-8s %8s", names[mode], "-");
+    else
+      printf("%-8s %5.1f dB", names[mode], tone_db);
+    printf(" %5.0f dB %8.1f Mframes/s %6.1f Mframes/s\n", image_db, speed[0], speed[1]);
+  }
+  free(mono);
+  free(stereo);
+  free(out);
+  free(table);
+  return 0;
+}
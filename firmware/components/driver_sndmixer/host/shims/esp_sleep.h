@@ -0,0 +1,2 @@
+#pragma once
+// Included by driver_i2s.h; nothing of it is used on the host.
@@ -0,0 +1,15 @@
+#pragma once
+// The parts of FreeRTOS the sound mixer uses, implemented in host_shims.c
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef uint32_t TickType_t;
+typedef void *TaskHandle_t;
+typedef void *QueueHandle_t;
+
+#define pdFALSE 0
+#define pdTRUE  1
+#define portMAX_DELAY 0xffffffffUL
+#define portNUM_PROCESSORS 2
+
+void uxPortCompareSet(volatile uint32_t *addr, uint32_t compare, uint32_t *set);
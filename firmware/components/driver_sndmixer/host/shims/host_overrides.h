@@ -0,0 +1,14 @@
+#pragma once
+// Included before every mixer source.
+#include <stdio.h>
+#include "driver_i2s.h"
+
+// Their progress messages only show up with -v.
+int host_log(const char *fmt, ...);
+#define printf host_log
+
+// The mixer scales its output by the I2S volume (0-255) / 32768, like the I2S driver always did,
+// which leaves only the top few bits of a sound. The harness renders at 128 times that level, so
+// that the golden output keeps all the bits the mixer and the sources produce.
+int host_master_volume(void);
+#define driver_i2s_get_volume() host_master_volume()
@@ -0,0 +1,24 @@
+#pragma once
+// Configuration of the host build. Sample rate and sizes are those of a badge, the options are
+// the menuconfig defaults, apart from the SPIRAM, which most badges with a speaker have.
+#include <sys/types.h>  // ssize_t, which the ESP-IDF headers pull in for sndmixer.h
+
+#define CONFIG_DRIVER_SNDMIXER_ENABLE 1
+#ifndef CONFIG_DRIVER_SNDMIXER_SAMPLE_RATE
+#define CONFIG_DRIVER_SNDMIXER_SAMPLE_RATE 22050
+#endif
+#define CONFIG_DRIVER_SNDMIXER_BITS_PER_SAMPLE 16
+#define CONFIG_DRIVER_SNDMIXER_BLOCK_SIZE 128
+#define CONFIG_DRIVER_SNDMIXER_MAX_EVENTS 32
+#define CONFIG_DRIVER_SNDMIXER_RESAMPLE_LINEAR 1
+#define CONFIG_DRIVER_SNDMIXER_SYNTH_VOICES 16
+#define CONFIG_DRIVER_SNDMIXER_MOD_SAMPLE_CACHE 128
+#define CONFIG_DRIVER_SNDMIXER_LIMITER 1
+#define CONFIG_DRIVER_SNDMIXER_MP3_HALF_RATE 1
+#define CONFIG_DRIVER_SNDMIXER_MP3_STREAM_BUFFER 16384
+#define CONFIG_DRIVER_SNDMIXER_WAV_STREAM_BUFFER 8192
+#define CONFIG_DRIVER_SNDMIXER_I2S_DAC_EXTERNAL 1
+#define CONFIG_SPIRAM_SUPPORT 1
+#if defined(CONFIG_DRIVER_SNDMIXER_MP3_DECODE_AHEAD) && !defined(CONFIG_DRIVER_SNDMIXER_MP3_RING_SIZE)
+#define CONFIG_DRIVER_SNDMIXER_MP3_RING_SIZE 4608
+#endif
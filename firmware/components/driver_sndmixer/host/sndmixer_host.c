@@ -0,0 +1,417 @@
+// Runs the sound mixer and its sources on a PC. Every scenario is rendered and compared with its
+// golden output in golden/, and the time spent per kind of sound is reported.
+//
+//   sndmixer_host [-g] [-r repeats] [-v] [scenario...]
+//
+// -g writes new golden files instead of comparing, -r renders every scenario more than once for
+// steadier timing, -v shows the messages of the mixer. Rendered output is kept in out/.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "sndmixer.h"
+#include "host.h"
+#include "test_sounds.h"
+
+// Largest difference from the golden output that still passes. The filter tables are calculated
+// in floating point, which may round differently on other hosts.
+#define TOLERANCE 2
+
+#define MAX_SOUNDS 16
+
+typedef struct {
+  const char *name;
+  int stereo;    // mixer output
+  int channels;  // mixer channels
+  void (*run)(int16_t *out, int frames);
+} scenario_t;
+
+static int ids[MAX_SOUNDS];
+static int no_ids;
+
+static int keep(int id) {
+  if (no_ids < MAX_SOUNDS)
+    ids[no_ids++] = id;
+  return id;
+}
+
+// Files are passed to the mixer as first and last byte
+static int queue_wav(const uint8_t *wav, int len) {
+  return keep(sndmixer_queue_wav(wav, wav + len - 1, 0));
+}
+
+typedef struct {
+  const uint8_t *data;
+  int len, pos;
+} mem_stream_t;
+
+// Reads in pieces of at most 1000 bytes, as a file on the badge might
+static ssize_t mem_read(void *stream, void *buf, size_t len) {
+  mem_stream_t *s = stream;
+  int n           = s->len - s->pos;
+  if (n > (int)len)
+    n = len;
+  if (n > 1000)
+    n = 1000;
+  memcpy(buf, s->data + s->pos, n);
+  s->pos += n;
+  return n;
+}
+
+static uint8_t *wav_pcm16, *wav_pcm8, *wav_ima, *xm, *mp3;
+static int wav_pcm16_len, wav_pcm8_len, wav_ima_len, xm_len, mp3_len;
+static mem_stream_t ima_stream, mp3_stream;
+
+static void run_wav_pcm16(int16_t *out, int frames) {
+  int id = queue_wav(wav_pcm16, wav_pcm16_len);
+  sndmixer_set_volume(id, 256);
+  sndmixer_play(id);
+  host_render(out, frames);
+}
+
+static void run_wav_pcm8_sinc(int16_t *out, int frames) {
+  int id = queue_wav(wav_pcm8, wav_pcm8_len);
+  sndmixer_set_resampler(id, SNDMIXER_RESAMPLE_SINC);
+  sndmixer_set_volume(id, 200);
+  sndmixer_play(id);
+  host_render(out, frames);
+}
+
+static void run_wav_ima_stream(int16_t *out, int frames) {
+  ima_stream = (mem_stream_t){wav_ima, wav_ima_len, 0};
+  int id     = keep(sndmixer_queue_wav_stream(mem_read, &ima_stream, 0));
+  sndmixer_set_resampler(id, SNDMIXER_RESAMPLE_NEAREST);
+  sndmixer_set_pan(id, -64);
+  sndmixer_play(id);
+  // Volume and pan changes at block boundaries and at exact frames
+  uint32_t now = sndmixer_get_clock();
+  sndmixer_set_volume_at(id, 256, now + 1000);
+  sndmixer_set_volume_at(id, 64, now + 3333);
+  sndmixer_pause_at(id, now + 5000);
+  sndmixer_play_at(id, now + 6000);
+  int half = frames / 2 / SNDMIXER_BLOCK_SIZE * SNDMIXER_BLOCK_SIZE;
+  host_render(out, half);
+  sndmixer_set_pan(id, 100);
+  host_render(out + half * 2, frames - half);
+}
+
+// Pan has no effect in mono: hard left, then hard right, must sound as centered, with the volume
+// ramps intact
+static void run_wav_pan_mono(int16_t *out, int frames) {
+  int id = queue_wav(wav_pcm16, wav_pcm16_len);
+  sndmixer_set_pan(id, -128);
+  sndmixer_play(id);
+  uint32_t now = sndmixer_get_clock();
+  sndmixer_set_volume_at(id, 256, now + 1500);
+  int half = frames / 2 / SNDMIXER_BLOCK_SIZE * SNDMIXER_BLOCK_SIZE;
+  host_render(out, half);
+  sndmixer_set_pan(id, 128);
+  sndmixer_set_volume(id, 96);
+  host_render(out + half * 2, frames - half);
+}
+
+static void run_mod(int16_t *out, int frames) {
+  int id = keep(sndmixer_queue_mod(xm, xm + xm_len - 1));
+  sndmixer_set_volume(id, 256);
+  sndmixer_play(id);
+  host_render(out, frames);
+}
+
+static void run_mp3(int16_t *out, int frames) {
+  int id = keep(sndmixer_queue_mp3(mp3, mp3 + mp3_len - 1));
+  sndmixer_set_volume(id, 160);
+  sndmixer_play(id);
+  host_render(out, frames);
+}
+
+static void run_mp3_stream(int16_t *out, int frames) {
+  mp3_stream = (mem_stream_t){mp3, mp3_len, 0};
+  int id     = keep(sndmixer_queue_mp3_stream(mem_read, &mp3_stream));
+  sndmixer_set_volume(id, 160);
+  sndmixer_play(id);
+  host_render(out, frames);
+}
+
+static void run_synth(int16_t *out, int frames) {
+  int id = keep(sndmixer_queue_synth());
+  sndmixer_freq(id, 300);
+  sndmixer_set_volume(id, 256);
+  uint32_t now = sndmixer_get_clock();
+  sndmixer_play_at(id, now + 700);
+  int step = frames / 5 / SNDMIXER_BLOCK_SIZE * SNDMIXER_BLOCK_SIZE;
+  for (int w = 0; w < 5; w++) {
+    sndmixer_waveform(id, w);
+    sndmixer_freq(id, 300 + w * 250);
+    int n = (w == 4) ? frames - 4 * step : step;
+    host_render(out + w * step * 2, n);
+  }
+}
+
+static void run_poly(int16_t *out, int frames) {
+  static const uint8_t chords[4][3] = {{60, 64, 67}, {57, 60, 64}, {53, 57, 60}, {55, 59, 62}};
+  int id = keep(sndmixer_queue_poly());
+  sndmixer_set_envelope(id, 10, 50, 90, 80);
+  sndmixer_waveform(id, 2);
+  sndmixer_set_volume(id, 256);
+  sndmixer_set_eq(SNDMIXER_EQ_LOWPASS, 2000, 0.707, 0);
+  sndmixer_play(id);
+  int step = frames / 4 / SNDMIXER_BLOCK_SIZE * SNDMIXER_BLOCK_SIZE;
+  for (int c = 0; c < 4; c++) {
+    for (int n = 0; n < 3; n++) {
+      if (c > 0)
+        sndmixer_note_off(id, chords[c - 1][n]);
+      sndmixer_note_on(id, chords[c][n], 100 - n * 20);
+    }
+    int n = (c == 3) ? frames - 3 * step : step;
+    host_render(out + c * step * 2, n);
+  }
+}
+
+// Everything at once, to see the mixer load and the limiter at work
+static void run_mix(int16_t *out, int frames) {
+  int id[5];
+  id[0]      = queue_wav(wav_pcm16, wav_pcm16_len);
+  ima_stream = (mem_stream_t){wav_ima, wav_ima_len, 0};
+  id[1]      = keep(sndmixer_queue_wav_stream(mem_read, &ima_stream, 0));
+  id[2]      = keep(sndmixer_queue_mod(xm, xm + xm_len - 1));
+  id[3]      = keep(sndmixer_queue_mp3(mp3, mp3 + mp3_len - 1));
+  id[4]      = keep(sndmixer_queue_poly());
+  sndmixer_set_resampler(id[1], SNDMIXER_RESAMPLE_SINC);
+  sndmixer_set_pan(id[0], -128);
+  sndmixer_set_pan(id[3], 128);
+  for (int i = 0; i < 5; i++) {
+    sndmixer_set_volume(id[i], 256);
+    sndmixer_play(id[i]);
+  }
+  for (int n = 48; n < 72; n += 3)
+    sndmixer_note_on(id[4], n, 127);
+  host_render(out, frames);
+}
+
+static const scenario_t scenarios[] = {
+    {"wav_pcm16", 1, 4, run_wav_pcm16},
+    {"wav_pcm8_sinc", 0, 4, run_wav_pcm8_sinc},
+    {"wav_ima_stream", 1, 4, run_wav_ima_stream},
+    {"wav_pan_mono", 0, 4, run_wav_pan_mono},
+    {"mod", 1, 4, run_mod},
+    {"mp3", 1, 4, run_mp3},
+    {"mp3_stream_mono", 0, 4, run_mp3_stream},
+    {"synth", 0, 4, run_synth},
+    {"poly", 1, 4, run_poly},
+    {"mix", 1, 8, run_mix},
+};
+#define NO_SCENARIOS (sizeof(scenarios) / sizeof(scenarios[0]))
+
+static const char *stats_names[SNDMIXER_STATS_COUNT] = {"wav", "mod", "mp3", "synth", "poly",
+                                                        "mixer"};
+
+static int write_wav(const char *path, const int16_t *frames, int len, int stereo) {
+  FILE *f = fopen(path, "wb");
+  if (!f)
+    return 0;
+  int channels      = stereo ? 2 : 1;
+  int rate          = sndmixer_get_samplerate();
+  uint32_t data_len = len * channels * 2;
+  uint8_t hdr[44];
+  memcpy(hdr, "RIFF", 4);
+  uint32_t v[] = {36 + data_len, 16, 1 | channels << 16, rate, rate * channels * 2,
+                  channels * 2 | 16 << 16, data_len};
+  memcpy(hdr + 8, "WAVEfmt ", 8);
+  for (int i = 0; i < 7; i++) {
+    int pos = (i == 0) ? 4 : (i == 6) ? 40 : 12 + i * 4;
+    for (int b = 0; b < 4; b++)
+      hdr[pos + b] = v[i] >> (b * 8);
+  }
+  memcpy(hdr + 36, "data", 4);
+  fwrite(hdr, 1, sizeof(hdr), f);
+  for (int i = 0; i < len; i++) {
+    for (int c = 0; c < channels; c++) {
+      uint16_t s = frames[i * 2 + c];
+      uint8_t b[2] = {s & 0xff, s >> 8};
+      fwrite(b, 1, 2, f);
+    }
+  }
+  return fclose(f) == 0;
+}
+
+// Reads a wav written by write_wav as stereo. Returns the amount of frames, or -1.
+static int read_wav(const char *path, int16_t **frames) {
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return -1;
+  uint8_t hdr[44];
+  if (fread(hdr, 1, sizeof(hdr), f) != sizeof(hdr) || memcmp(hdr + 36, "data", 4) != 0) {
+    fclose(f);
+    return -1;
+  }
+  int channels = hdr[22];
+  int len      = (hdr[40] | hdr[41] << 8 | hdr[42] << 16 | hdr[43] << 24) / (channels * 2);
+  *frames      = malloc(len * 2 * sizeof(int16_t));
+  for (int i = 0; i < len; i++) {
+    uint8_t b[4];
+    if (fread(b, 1, channels * 2, f) != (size_t)channels * 2) {
+      len = i;
+      break;
+    }
+    (*frames)[i * 2 + 0] = (int16_t)(b[0] | b[1] << 8);
+    (*frames)[i * 2 + 1] = (channels == 2) ? (int16_t)(b[2] | b[3] << 8) : (*frames)[i * 2];
+  }
+  fclose(f);
+  return len;
+}
+
+// Compares a render with its golden file. Returns 1 if it matches.
+static int compare(const scenario_t *s, const int16_t *out, int frames) {
+  char path[256];
+  snprintf(path, sizeof(path), "golden/%s.wav", s->name);
+  int16_t *golden;
+  int len = read_wav(path, &golden);
+  if (len < 0) {
+    printf("  FAIL: can't read %s\n", path);
+    return 0;
+  }
+  int max_diff = 0, differ = 0;
+  for (int i = 0; i < len * 2 && i < frames * 2; i++) {
+    int d = abs(out[i] - golden[i]);
+    if (d > max_diff)
+      max_diff = d;
+    if (d)
+      differ++;
+  }
+  free(golden);
+  if (len != frames) {
+    printf("  FAIL: %d frames, golden has %d\n", frames, len);
+    return 0;
+  }
+  if (max_diff > TOLERANCE) {
+    printf("  FAIL: %d samples differ from the golden output, by up to %d\n", differ, max_diff);
+    return 0;
+  }
+  printf("  ok: matches the golden output");
+  if (differ)
+    printf(", %d samples off by up to %d", differ, max_diff);
+  printf("\n");
+  return 1;
+}
+
+static void print_stats(const char *indent, const sndmixer_stats_t *stats, uint64_t *total_us) {
+  int rate = sndmixer_get_samplerate();
+  for (int t = 0; t < SNDMIXER_STATS_COUNT; t++) {
+    if (!stats[t].frames)
+      continue;
+    uint64_t us = total_us ? total_us[t] : stats[t].time_us;
+    double secs = us / 1e6;
+    printf("%s%-6s %9u frames %9.2f ms %8.2f Mframes/s", indent, stats_names[t], stats[t].frames,
+           secs * 1e3, secs > 0 ? stats[t].frames / secs / 1e6 : 0);
+    if (t == SNDMIXER_STATS_MIXER)
+      printf("  load %.2f%%", secs * 100 * rate / stats[t].frames);
+    printf("\n");
+  }
+}
+
+int main(int argc, char **argv) {
+  int generate = 0, repeats = 1;
+  const char *only[NO_SCENARIOS];
+  int no_only = 0;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-g") == 0) {
+      generate = 1;
+    } else if (strcmp(argv[i], "-v") == 0) {
+      host_verbose = 1;
+    } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+      repeats = atoi(argv[++i]);
+      if (repeats < 1)
+        repeats = 1;
+    } else if (argv[i][0] != '-' && no_only < (int)NO_SCENARIOS) {
+      only[no_only++] = argv[i];
+    } else {
+      fprintf(stderr, "Usage: %s [-g] [-r repeats] [-v] [scenario...]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  wav_pcm16 = make_wav_pcm(2, 44100, 16, 44100, &wav_pcm16_len);
+  wav_pcm8  = make_wav_pcm(1, 11025, 8, 11025, &wav_pcm8_len);
+  wav_ima   = make_wav_ima(2, 22050, 22050, &wav_ima_len);
+  xm        = make_xm(&xm_len);
+  mp3       = make_mp3(40, &mp3_len);
+  if (!wav_pcm16 || !wav_pcm8 || !wav_ima || !xm || !mp3) {
+    fprintf(stderr, "Out of memory\n");
+    return 1;
+  }
+  mkdir("out", 0777);
+
+  // Half a second of every scenario
+  int frames  = CONFIG_DRIVER_SNDMIXER_SAMPLE_RATE / 2 / SNDMIXER_BLOCK_SIZE * SNDMIXER_BLOCK_SIZE;
+  int16_t *out = malloc(frames * 2 * sizeof(int16_t));
+  if (!out)
+    return 1;
+  sndmixer_stats_t total[SNDMIXER_STATS_COUNT] = {{0}};
+  uint64_t total_us[SNDMIXER_STATS_COUNT]      = {0};
+  int failed = 0, ran = 0;
+
+  for (unsigned s = 0; s < NO_SCENARIOS; s++) {
+    const scenario_t *sc = &scenarios[s];
+    int selected         = (no_only == 0);
+    for (int i = 0; i < no_only; i++)
+      selected |= (strcmp(only[i], sc->name) == 0);
+    if (!selected)
+      continue;
+    ran++;
+    printf("%s\n", sc->name);
+    sndmixer_stats_t stats[SNDMIXER_STATS_COUNT] = {{0}};
+    uint64_t us[SNDMIXER_STATS_COUNT]            = {0};
+    for (int r = 0; r < repeats; r++) {
+      if (!sndmixer_init(sc->channels, sc->stereo)) {
+        fprintf(stderr, "sndmixer_init failed\n");
+        return 1;
+      }
+      sndmixer_reset_stats();
+      memset(out, 0, frames * 2 * sizeof(int16_t));
+      no_ids = 0;
+      sc->run(out, frames);
+      sndmixer_stats_t st[SNDMIXER_STATS_COUNT];
+      sndmixer_get_stats(st);
+      for (int t = 0; t < SNDMIXER_STATS_COUNT; t++) {
+        stats[t].frames += st[t].frames;
+        us[t] += st[t].time_us;
+      }
+      // Let the sources clean up
+      for (int i = 0; i < no_ids; i++)
+        sndmixer_stop(ids[i]);
+      sndmixer_set_eq(SNDMIXER_EQ_OFF, 0, 0, 0);
+      int16_t rest[SNDMIXER_BLOCK_SIZE * 2];
+      host_render(rest, SNDMIXER_BLOCK_SIZE);
+    }
+    for (int t = 0; t < SNDMIXER_STATS_COUNT; t++) {
+      total[t].frames += stats[t].frames;
+      total_us[t] += us[t];
+    }
+    print_stats("  ", stats, us);
+
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s.wav", generate ? "golden" : "out", sc->name);
+    if (!write_wav(path, out, frames, sc->stereo)) {
+      printf("  FAIL: can't write %s\n", path);
+      failed++;
+    } else if (generate) {
+      printf("  wrote %s\n", path);
+    } else if (!compare(sc, out, frames)) {
+      failed++;
+    }
+  }
+
+  if (ran == 0) {
+    fprintf(stderr, "No such scenario\n");
+    return 2;
+  }
+  printf("\nThroughput per kind of sound, %d Hz output, %d run(s) per scenario:\n",
+         sndmixer_get_samplerate(), repeats);
+  print_stats("  ", total, total_us);
+  if (!generate)
+    printf("\n%d of %d scenarios match the golden output\n", ran - failed, ran);
+  return failed ? 1 : 0;
+}
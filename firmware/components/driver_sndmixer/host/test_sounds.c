@@ -0,0 +1,345 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_sounds.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define SAT(x, min, max) ((x > max) ? max : (x < min) ? min : x)
+
+// Random numbers that are the same on every host
+static uint32_t seed;
+
+static uint32_t rnd(uint32_t range) {
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 8) % range;
+}
+
+static int rnd_between(int min, int max) {
+  return min + (int)rnd(max - min + 1);
+}
+
+static uint8_t *put16(uint8_t *p, uint16_t v) {
+  p[0] = v;
+  p[1] = v >> 8;
+  return p + 2;
+}
+
+static uint8_t *put32(uint8_t *p, uint32_t v) {
+  p = put16(p, v);
+  return put16(p, v >> 16);
+}
+
+static void signal(int16_t *out, int channels, int rate, int frames) {
+  seed = 1;
+  for (int i = 0; i < frames; i++) {
+    for (int c = 0; c < channels; c++) {
+      double t = (double)i / rate;
+      double v = 9000 * sin(2 * M_PI * 440 * (c + 1) * t) + 6000 * sin(2 * M_PI * 1250 * t) +
+                 3000 * sin(2 * M_PI * 5100 * t);
+      v += rnd_between(-1500, 1500);
+      out[i * channels + c] = SAT((int)v, -32768, 32767);
+    }
+  }
+}
+
+static uint8_t *wav_header(uint8_t *p, int format, int channels, int rate, int bits,
+                           int block_align, int extra, int data_len) {
+  int fmt_len = 16 + (extra ? 4 : 0);
+  memcpy(p, "RIFF", 4);
+  put32(p + 4, 4 + 8 + fmt_len + 8 + data_len);
+  memcpy(p + 8, "WAVEfmt ", 8);
+  p = put32(p + 16, fmt_len);
+  p = put16(p, format);
+  p = put16(p, channels);
+  p = put32(p, rate);
+  p = put32(p, rate * block_align / (format == 1 ? 1 : extra));
+  p = put16(p, block_align);
+  p = put16(p, bits);
+  if (extra) {
+    p = put16(p, 2);
+    p = put16(p, extra);  // samples per block
+  }
+  memcpy(p, "data", 4);
+  return put32(p + 4, data_len);
+}
+
+uint8_t *make_wav_pcm(int channels, int rate, int bits, int frames, int *len) {
+  int data_len = frames * channels * bits / 8;
+  uint8_t *wav = malloc(44 + data_len);
+  int16_t *s   = malloc(frames * channels * sizeof(int16_t));
+  if (!wav || !s) {
+    free(wav);
+    free(s);
+    return NULL;
+  }
+  signal(s, channels, rate, frames);
+  uint8_t *p = wav_header(wav, 1, channels, rate, bits, channels * bits / 8, 0, data_len);
+  for (int i = 0; i < frames * channels; i++) {
+    if (bits == 8)
+      *p++ = (s[i] >> 8) + 128;
+    else
+      p = put16(p, s[i]);
+  }
+  free(s);
+  *len = 44 + data_len;
+  return wav;
+}
+
+static const int16_t ima_step[89] = {
+    7,     8,     9,     10,    11,    12,    13,    14,    16,    17,    19,    21,    23,
+    25,    28,    31,    34,    37,    41,    45,    50,    55,    60,    66,    73,    80,
+    88,    97,    107,   118,   130,   143,   157,   173,   190,   209,   230,   253,   279,
+    307,   337,   371,   408,   449,   494,   544,   598,   658,   724,   796,   876,   963,
+    1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,  2272,  2499,  2749,  3024,  3327,
+    3660,  4026,  4428,  4871,  5358,  5894,  6484,  7132,  7845,  8630,  9493,  10442, 11487,
+    12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767};
+
+static const int8_t ima_index[16] = {-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8};
+
+// Encodes one sample, keeping the same predictor as the decoder
+static int ima_encode(int *pred, int *index, int sample) {
+  int step   = ima_step[*index];
+  int diff   = sample - *pred;
+  int nibble = 0;
+  if (diff < 0) {
+    nibble = 8;
+    diff   = -diff;
+  }
+  int delta = step >> 3;
+  if (diff >= step) {
+    nibble |= 4;
+    diff -= step;
+    delta += step;
+  }
+  if (diff >= step >> 1) {
+    nibble |= 2;
+    diff -= step >> 1;
+    delta += step >> 1;
+  }
+  if (diff >= step >> 2) {
+    nibble |= 1;
+    delta += step >> 2;
+  }
+  *pred  = SAT(*pred + ((nibble & 8) ? -delta : delta), -32768, 32767);
+  *index = SAT(*index + ima_index[nibble], 0, 88);
+  return nibble;
+}
+
+uint8_t *make_wav_ima(int channels, int rate, int frames, int *len) {
+  int block_align = 256 * channels;
+  int per_block   = 1 + (block_align - 4 * channels) * 2 / channels;
+  int blocks      = (frames + per_block - 1) / per_block;
+  frames          = blocks * per_block;
+  int data_len    = blocks * block_align;
+  uint8_t *wav    = malloc(48 + data_len);
+  int16_t *s      = malloc(frames * channels * sizeof(int16_t));
+  if (!wav || !s) {
+    free(wav);
+    free(s);
+    return NULL;
+  }
+  signal(s, channels, rate, frames);
+  uint8_t *p = wav_header(wav, 0x11, channels, rate, 4, block_align, per_block, data_len);
+  int index[8] = {0};
+  for (int b = 0; b < blocks; b++) {
+    const int16_t *in = s + b * per_block * channels;
+    for (int c = 0; c < channels; c++) {
+      p    = put16(p, in[c]);
+      *p++ = index[c];
+      *p++ = 0;
+    }
+    uint8_t *data = p;
+    for (int c = 0; c < channels; c++) {
+      int pred = in[c];
+      uint8_t *d = data + 4 * c;
+      for (int i = 1; i < per_block; i += 8, d += 4 * channels) {
+        for (int k = 0; k < 4; k++) {
+          int lo = ima_encode(&pred, &index[c], in[(i + k * 2) * channels + c]);
+          int hi = ima_encode(&pred, &index[c], in[(i + k * 2 + 1) * channels + c]);
+          d[k]   = lo | hi << 4;
+        }
+      }
+    }
+    p = data + block_align - 4 * channels;
+  }
+  free(s);
+  *len = 48 + data_len;
+  return wav;
+}
+
+// Instrument with one sample, stored as deltas
+static uint8_t *xm_instrument(uint8_t *p, const int16_t *s, int n, int loop_start, int loop_len,
+                              int type) {
+  int bytes = (type & 0x10) ? 2 : 1;
+  uint8_t *start = p;
+  p = put32(p, 263);
+  memset(p, 0, 259);
+  memcpy(p, "ins", 3);
+  p[23] = 1;       // samples
+  put32(p + 25, 40);  // sample header size
+  p = start + 263;
+  p = put32(p, n * bytes);
+  p = put32(p, loop_start * bytes);
+  p = put32(p, loop_len * bytes);
+  *p++ = 64;    // volume
+  *p++ = 0;     // finetune
+  *p++ = type;
+  *p++ = 128;   // panning
+  *p++ = 0;     // relative note
+  *p++ = 0;
+  memset(p, 0, 22);
+  memcpy(p, "smp", 3);
+  p += 22;
+  int prev = 0;
+  for (int i = 0; i < n; i++) {
+    int d = s[i] - prev;
+    prev  = s[i];
+    if (bytes == 2)
+      p = put16(p, d);
+    else
+      *p++ = d;
+  }
+  return p;
+}
+
+uint8_t *make_xm(int *len) {
+  const int channels = 8;
+  const uint8_t order[] = {0, 1, 0, 1, 1, 0};
+  uint8_t *xm = calloc(1, 64 * 1024);
+  int16_t *s  = malloc(20000 * sizeof(int16_t));
+  if (!xm || !s) {
+    free(xm);
+    free(s);
+    return NULL;
+  }
+  seed = 1;
+  uint8_t *p = xm;
+  memcpy(p, "Extended Module: test                ", 37);
+  p[37] = 0x1a;
+  memcpy(p + 38, "gen                 ", 20);
+  p = put16(p + 58, 0x0104);
+  p = put32(p, 276);
+  p = put16(p, sizeof(order));
+  p = put16(p, 0);         // restart position
+  p = put16(p, channels);
+  p = put16(p, 2);         // patterns
+  p = put16(p, 3);         // instruments
+  p = put16(p, 1);         // linear frequency table
+  p = put16(p, 6);         // speed
+  p = put16(p, 125);       // bpm
+  memcpy(p, order, sizeof(order));
+  p += 256;
+  for (int pat = 0; pat < 2; pat++) {
+    uint8_t *hdr = p;
+    p = put32(p, 9);
+    *p++ = 0;
+    p = put16(p, 64);
+    uint8_t *size = p;
+    p += 2;
+    for (int row = 0; row < 64; row++) {
+      for (int ch = 0; ch < channels; ch++) {
+        if (row % 4 == ch % 4) {
+          *p++ = 30 + (row * 7 + ch * 5 + pat * 3) % 50;  // note
+          *p++ = 1 + (ch + row / 4) % 3;                  // instrument
+          *p++ = 0;
+          *p++ = 0;
+          *p++ = 0;
+        } else {
+          *p++ = 0x80;  // empty
+        }
+      }
+    }
+    put16(size, p - hdr - 9);
+  }
+  for (int i = 0; i < 2000; i++)
+    s[i] = (int)(100 * sin(i * 2 * M_PI / 50));
+  p = xm_instrument(p, s, 2000, 1000, 1000, 1);
+  for (int i = 0; i < 3000; i++)
+    s[i] = (i % 100) * 600 - 30000;
+  p = xm_instrument(p, s, 3000, 500, 2000, 2 | 0x10);
+  for (int i = 0; i < 20000; i++)
+    s[i] = rnd_between(-120, 120);
+  p = xm_instrument(p, s, 20000, 0, 0, 0);
+  free(s);
+  *len = p - xm;
+  return xm;
+}
+
+typedef struct {
+  uint8_t *p;
+  int bit;
+} bit_writer_t;
+
+static void put_bits(bit_writer_t *w, uint32_t v, int n) {
+  while (n-- > 0) {
+    if (w->bit == 0)
+      *w->p = 0;
+    *w->p |= ((v >> n) & 1) << (7 - w->bit);
+    if (++w->bit == 8) {
+      w->bit = 0;
+      w->p++;
+    }
+  }
+}
+
+uint8_t *make_mp3(int frames, int *len) {
+  const int frame_len = 417;  // 128 kbit/s at 44.1 kHz, no padding
+  const int main_bits = (frame_len - 4 - 32) * 8;
+  uint8_t *mp3 = malloc(frames * frame_len);
+  if (!mp3)
+    return NULL;
+  seed = 3;
+  for (int f = 0; f < frames; f++) {
+    uint8_t *p   = mp3 + f * frame_len;
+    int mode     = rnd(3) ? 1 : 0;  // joint stereo or stereo
+    int mode_ext = mode ? rnd(4) : 0;
+    p[0] = 0xff;
+    p[1] = 0xfb;
+    p[2] = 0x90;
+    p[3] = mode << 6 | mode_ext << 4;
+    bit_writer_t w = {p + 4, 0};
+    put_bits(&w, 0, 9);  // main data begin
+    put_bits(&w, 0, 3);
+    put_bits(&w, 0, 8);  // scale factor selection
+    for (int gr = 0; gr < 2; gr++) {
+      for (int ch = 0; ch < 2; ch++) {
+        put_bits(&w, main_bits / 4 - rnd(51), 12);  // part2_3_length
+        put_bits(&w, 0, 9);                          // big values
+        put_bits(&w, rnd_between(180, 195), 8);     // global gain
+        put_bits(&w, rnd(16), 4);                    // scalefac_compress
+        int window_switching = rnd(4) == 0;
+        put_bits(&w, window_switching, 1);
+        if (window_switching) {
+          static const int block_types[] = {1, 2, 2, 3};
+          int type = block_types[rnd(4)];
+          put_bits(&w, type, 2);
+          put_bits(&w, type == 2 && rnd(10) < 3, 1);  // mixed block
+          for (int i = 0; i < 2; i++) {
+            int t = rnd(30);
+            put_bits(&w, t + (t >= 4) + (t >= 13), 5);  // table, skipping the unused 4 and 14
+          }
+          for (int i = 0; i < 3; i++)
+            put_bits(&w, rnd(3), 3);  // subblock gain
+        } else {
+          for (int i = 0; i < 3; i++) {
+            int t = rnd(30);
+            put_bits(&w, t + (t >= 4) + (t >= 13), 5);
+          }
+          put_bits(&w, rnd(16), 4);  // region0 count
+          put_bits(&w, rnd(8), 3);   // region1 count
+        }
+        put_bits(&w, rnd(2), 1);  // preflag
+        put_bits(&w, 0, 1);       // scalefac_scale
+        put_bits(&w, 1, 1);       // count1 table B
+      }
+    }
+    for (uint8_t *d = p + 36; d < p + frame_len; d++)
+      *d = rnd(256);
+  }
+  *len = frames * frame_len;
+  return mp3;
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <stdint.h>
+
+// Test sounds for the harness. They are generated instead of stored, so that the only files the
+// harness keeps are its golden output. All return a malloc'ed file and set len to its size.
+
+// PCM wav of a chord with some noise, 8 or 16 bit
+uint8_t *make_wav_pcm(int channels, int rate, int bits, int frames, int *len);
+// The same sound, IMA ADPCM compressed with blocks of 256 bytes per channel
+uint8_t *make_wav_ima(int channels, int rate, int frames, int *len);
+// Extended module with 8 channels: a looped 8-bit sine, a ping-pong looped 16-bit saw and
+// unlooped noise, as delta samples
+uint8_t *make_xm(int *len);
+// MPEG-1 layer III, 44.1 kHz, 128 kbit/s, (joint) stereo. Headers and side info are valid, the
+// main data is random. All coefficients are coded with count1 table B, in which every 4 bits are
+// a valid code, so any data decodes to a spectrum with values of -1 to 1.
+uint8_t *make_mp3(int frames, int *len);
@@ -5,6 +5,20 @@
 
 #include "ibxm.h"
 
+#ifdef ESP_PLATFORM
+#include <sdkconfig.h>
+#endif
+#ifdef CONFIG_SPIRAM_SUPPORT
+#include <esp_heap_caps.h>
+/* Decoded samples go to external RAM when there is some. */
+static void *cache_alloc( size_t size ) {
+	void *ptr = heap_caps_malloc( size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT );
+	return ptr ? ptr : malloc( size );
+}
+#else
+#define cache_alloc malloc
+#endif
+
 #if 1
 #define DO_CALLOC calloc
 #else
@@ -214,9 +228,28 @@ static short get_xm_samp(struct sample *sample, int sidx) {
 	return s;
 }
 
+static short get_pcm_samp(struct sample *sample, int idx) {
+	short ret;
+	if (sample->flags & SAMPLE_8BIT) {
+		unsigned char *bdata=(unsigned char*)sample->data;
+		ret=bdata[idx]*256;
+	} else {
+		ret=sample->data[idx];
+	}
+	if (sample->flags & SAMPLE_UNSIGNED) {
+		int v=(unsigned short)ret;
+		ret=v-32768;
+	}
+	return ret;
+}
+
 static short get_sample_data(struct sample *sample, int idx, int channel_no) {
 	if (idx==sample->loop_start + sample->loop_length) idx=sample->loop_start;
-	short ret;
+	if (sample->flags & SAMPLE_PINGPONG) {
+		//The second half of the loop plays the first half backwards.
+		int half = sample->loop_length / 2;
+		if (idx >= sample->loop_start + half) idx = ( sample->loop_start + half ) * 2 - 1 - idx;
+	}
 //	static struct sample *monsample=NULL;
 //	if (monsample==NULL) monsample=sample;
 //	if (monsample==sample) printf("Sample: %d\n", idx);
@@ -270,22 +303,89 @@ static short get_sample_data(struct sample *sample, int idx, int channel_no) {
 		return amp;
 	}
 
-	if (sample->flags & SAMPLE_8BIT) {
-		unsigned char *bdata=(unsigned char*)sample->data;
-		ret=bdata[idx]*256;
-	} else {
-		ret=sample->data[idx];
+	return get_pcm_samp(sample, idx);
+}
+
+static void sample_uncache( struct module *module, struct sample *sample ) {
+	if( sample->cache ) {
+		free( sample->cache );
+		sample->cache = NULL;
+		module->sample_cache_used -= ( sample->loop_start + sample->loop_length + 1 ) * sizeof( short );
 	}
-	if (sample->flags & SAMPLE_UNSIGNED) {
-		int v=(unsigned short)ret;
-		ret=v-32768;
+}
+
+/* Drops the least recently used decoded sample that was not used for the current
+   block of audio. Returns 0 if there is none. */
+static int sample_cache_evict( struct module *module ) {
+	struct sample *sample, *oldest = NULL;
+	int ins, sam;
+	for( ins = 0; ins <= module->num_instruments; ins++ ) {
+		for( sam = 0; sam < module->instruments[ ins ].num_samples; sam++ ) {
+			sample = &module->instruments[ ins ].samples[ sam ];
+			if( sample->cache && sample->cache_tick != module->sample_cache_tick
+				&& ( !oldest || sample->cache_tick - oldest->cache_tick < 0 ) ) {
+				oldest = sample;
+			}
+		}
 	}
+	if( oldest ) {
+		sample_uncache( module, oldest );
+	}
+	return oldest != NULL;
+}
 
-	if (sample->flags & SAMPLE_PINGPONG) {
-		printf("Ping-pong unsupported\n");
+/* Returns the sample as native 16-bit data, decoding it first if needed, or NULL if
+   it does not fit in the cache. */
+static short *sample_get_cache( struct module *module, struct sample *sample ) {
+	int idx, amp, length, end, loop_end, size;
+	short *data;
+	if( sample->cache ) {
+		sample->cache_tick = module->sample_cache_tick;
+		return sample->cache;
+	}
+	end = sample->loop_start + sample->loop_length;
+	size = ( end + 1 ) * sizeof( short );
+	if( size > module->sample_cache_size ) {
+		return NULL;
+	}
+	while( module->sample_cache_used + size > module->sample_cache_size ) {
+		if( !sample_cache_evict( module ) ) {
+			return NULL;
+		}
+	}
+	data = cache_alloc( size );
+	if( !data ) {
+		return NULL;
 	}
+	length = end;
+	if( sample->flags & SAMPLE_PINGPONG ) {
+		length = sample->loop_start + sample->loop_length / 2;
+	}
+	if( sample->flags & SAMPLE_DELTA ) {
+		for( idx = 0, amp = 0; idx < length; idx++ ) {
+			amp += get_xm_samp( sample, idx );
+			data[ idx ] = amp;
+		}
+	} else {
+		for( idx = 0; idx < length; idx++ ) {
+			data[ idx ] = get_pcm_samp( sample, idx );
+		}
+	}
+	/* Unroll ping-pong loops, so they play like normal loops. */
+	for( loop_end = length; idx < end; idx++ ) {
+		data[ idx ] = data[ loop_end * 2 - 1 - idx ];
+	}
+	/* One extra sample, so interpolation never has to check for the loop end. */
+	data[ end ] = sample->loop_length > 0 ? data[ sample->loop_start ] : 0;
+	sample->cache = data;
+	sample->cache_tick = module->sample_cache_tick;
+	module->sample_cache_used += size;
+	return data;
+}
 
-	return ret;
+void module_set_sample_cache( struct module *module, int bytes ) {
+	module->sample_cache_size = bytes;
+	while( module->sample_cache_used > bytes && sample_cache_evict( module ) );
 }
 
 static struct pattern *get_pattern(struct module *module, int idx) {
@@ -322,6 +422,7 @@ void dispose_module( struct module *module ) {
 						 free( instrument->samples[ sam ].data );
 					}
 					free( instrument->samples[ sam ].dcache );
+					free( instrument->samples[ sam ].cache );
 				}
 				free( instrument->samples );
 			}
@@ -550,7 +651,10 @@ static struct module* module_load_xm( struct data *data, char *message ) {
 				sample->loop_length = sam_loop_length;
 				sample->flags = SAMPLE_DONTFREE | SAMPLE_DELTA;
 				if (!sixteen_bit) sample->flags|=SAMPLE_8BIT;
-				if (ping_pong) sample->flags|=SAMPLE_PINGPONG;
+				if (ping_pong && sam_loop_length > 0) {
+					sample->flags|=SAMPLE_PINGPONG;
+					sample->loop_length *= 2;
+				}
 				sample->data=(short*)&data->buffer[offset];
 				offset += sam_data_bytes;
 			}
@@ -1662,12 +1766,83 @@ static void channel_row( struct channel *channel, struct note *note ) {
 	channel_update_envelopes( channel );
 }
 
+/* Resampling from a decoded sample. The output is rendered in runs that end at the
+   loop end, so the inner loops need no checks. */
+static void channel_resample_cached( struct channel *channel, short *data, int *mix_buf,
+		int out_idx, int out_end, int step, int interpolate ) {
+	struct sample *sample = channel->sample;
+	int sam_idx = channel->sample_idx, sam_fra = channel->sample_fra;
+	int loop_len = sample->loop_length, loop_end = sample->loop_start + loop_len;
+	int count, y, c;
+#if IBXM_MONO
+	int gain = channel->ampl;
+#else
+	int l_gain = channel->ampl * ( 255 - channel->pann ) >> 8;
+	int r_gain = channel->ampl * channel->pann >> 8;
+#endif
+	while( out_idx < out_end ) {
+		if( sam_idx >= loop_end ) {
+			if( loop_len > 1 ) {
+				sam_idx = sample->loop_start + ( sam_idx - sample->loop_start ) % loop_len;
+			} else {
+				break;
+			}
+		}
+		count = ( out_end - out_idx ) / ( BYTES_PER_SAMPLE / 2 );
+		if( step > 0 ) {
+			long long left = ( ( ( long long ) ( loop_end - sam_idx ) << FP_SHIFT ) - sam_fra + step - 1 ) / step;
+			if( left < count ) {
+				count = left;
+			}
+		}
+		if( interpolate ) {
+			while( count-- > 0 ) {
+				c = data[ sam_idx ];
+				y = c + ( ( ( data[ sam_idx + 1 ] - c ) * sam_fra ) >> FP_SHIFT );
+#if IBXM_MONO
+				mix_buf[ out_idx++ ] += ( y * gain ) >> FP_SHIFT;
+#else
+				mix_buf[ out_idx++ ] += ( y * l_gain ) >> FP_SHIFT;
+				mix_buf[ out_idx++ ] += ( y * r_gain ) >> FP_SHIFT;
+#endif
+				sam_fra += step;
+				sam_idx += sam_fra >> FP_SHIFT;
+				sam_fra &= FP_MASK;
+			}
+		} else {
+			while( count-- > 0 ) {
+				y = data[ sam_idx ];
+#if IBXM_MONO
+				mix_buf[ out_idx++ ] += ( y * gain ) >> FP_SHIFT;
+#else
+				mix_buf[ out_idx++ ] += ( y * l_gain ) >> FP_SHIFT;
+				mix_buf[ out_idx++ ] += ( y * r_gain ) >> FP_SHIFT;
+#endif
+				sam_fra += step;
+				sam_idx += sam_fra >> FP_SHIFT;
+				sam_fra &= FP_MASK;
+			}
+		}
+	}
+}
+
 static void channel_resample( struct channel *channel, int *mix_buf,
 		int offset, int count, int sample_rate, int interpolate ) {
 	struct sample *sample = channel->sample;
 	int sam_idx, sam_fra, step;
 	int loop_len, loop_end, out_idx, out_end, y, m, c;
-	if( channel->ampl > 0 ) {
+	short *data;
+	if( channel->ampl > 0 && ( data = sample_get_cache( channel->replay->module, sample ) ) ) {
+		step = ( channel->freq << ( FP_SHIFT - 3 ) ) / ( sample_rate >> 3 );
+		channel_resample_cached( channel, data, mix_buf, offset * ( BYTES_PER_SAMPLE / 2 ),
+			( offset + count ) * ( BYTES_PER_SAMPLE / 2 ), step, interpolate );
+	} else if( channel->ampl > 0 ) {
+		/* With a sample cache, interpolation is only used on decoded samples.
+		   Samples that did not fit are played without, as decoding two
+		   input samples per output sample costs too much. */
+		if( channel->replay->module->sample_cache_size > 0 ) {
+			interpolate = 0;
+		}
 #if !IBXM_MONO
 		int l_gain, r_gain;
 		l_gain = channel->ampl * ( 255 - channel->pann ) >> 8;
@@ -2036,6 +2211,7 @@ int replay_get_audio( struct replay *replay, int *mix_buf ) {
 	/* Clear output buffer. */
 	memset( mix_buf, 0, ( tick_len + 65 ) * BYTES_PER_SAMPLE * sizeof( int ) );
 	/* Resample. */
+	replay->module->sample_cache_tick++;
 	num_channels = replay->module->num_channels;
 	for( idx = 0; idx < num_channels; idx++ ) {
 		channel = &replay->channels[ idx ];
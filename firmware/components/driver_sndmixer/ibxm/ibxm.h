@@ -19,6 +19,7 @@ struct data {
 #define SAMPLE_UNSIGNED (1<<1)
 #define SAMPLE_DELTA (1<<2)
 #define SAMPLE_DONTFREE (1<<3)
+//Ping-pong loops: loop_length counts the loop forwards and backwards, i.e. twice the loop in the data.
 #define SAMPLE_PINGPONG (1<<4)
 
 struct delta_cache {
@@ -35,6 +36,9 @@ struct sample {
 	short *data;
 	int flags;
 	struct delta_cache *dcache;
+	//Decoded native samples, loop_start + loop_length + 1 of them, or NULL if not cached.
+	short *cache;
+	int cache_tick;
 };
 
 struct envelope {
@@ -78,6 +82,7 @@ struct module {
 	struct pattern pattern_cache;
 	int pattern_cache_idx;
 	pattern_cache_hdl_t pattern_cache_handler;
+	int sample_cache_size, sample_cache_used, sample_cache_tick;
 };
 
 /* Allocate and initialize a module from the specified data, returns NULL on error.
@@ -85,6 +90,10 @@ struct module {
 struct module* module_load( struct data *data, char *message );
 /* Deallocate the specified module. */
 void dispose_module( struct module *module );
+/* Allow up to the specified amount of bytes to be used for samples decoded to native
+   16-bit data. Samples are decoded when they are first played and are dropped again,
+   least recently used first, when the space is needed. 0 (the default) disables this. */
+void module_set_sample_cache( struct module *module, int bytes );
 /* Allocate and initialize a replay with the specified module and sampling rate. */
 struct replay* new_replay( struct module *module, int sample_rate, int interpolation );
 /* Deallocate the specified replay. */
@@ -101,6 +101,8 @@
 #define	IntensityProcMPEG2	STATNAME(IntensityProcMPEG2)
 #define PolyphaseMono		STATNAME(PolyphaseMono)
 #define PolyphaseStereo		STATNAME(PolyphaseStereo)
+#define PolyphaseMonoHalf	STATNAME(PolyphaseMonoHalf)
+#define PolyphaseStereoHalf	STATNAME(PolyphaseStereoHalf)
 #define FDCT32				STATNAME(FDCT32)
 
 #define	ISFMpeg1			STATNAME(ISFMpeg1)
@@ -293,6 +295,8 @@ extern "C" {
 #endif
 void PolyphaseMono(short *pcm, int *vbuf, const int *coefBase);
 void PolyphaseStereo(short *pcm, int *vbuf, const int *coefBase);
+void PolyphaseMonoHalf(short *pcm, int *vbuf, const int *coefBase);
+void PolyphaseStereoHalf(short *pcm, int *vbuf, const int *coefBase);
 #ifdef __cplusplus
 }
 #endif
@@ -760,6 +760,14 @@ static __inline void imdct12 (int *x, int *out)
 		bc.nBlocksLong = 0;
 		nBfly = 0;
 	}
+
+	/* at half rate, only the lower 16 subbands are synthesized (the last butterfly still
+	 *   contributes to subband 15)
+	 */
+	if (mp3DecInfo->outputMode & MP3_OUTPUT_HALFRATE) {
+		bc.nBlocksLong = MIN(bc.nBlocksLong, NBANDS / 2);
+		nBfly = MIN(nBfly, NBANDS / 2);
+	}
  
 	AntiAlias(hi->huffDecBuf[ch], nBfly);
 	hi->nonZeroBound[ch] = MAX(hi->nonZeroBound[ch], (nBfly * 18) + 8);
@@ -773,6 +781,10 @@ static __inline void imdct12 (int *x, int *out)
 	bc.prevWinSwitch = mi->prevWinSwitch[ch];
 	bc.currWinSwitch = (si->sis[gr][ch].mixedBlock ? blockCutoff : 0);	/* where WINDOW switches (not nec. transform) */
 	bc.gbIn = hi->gb[ch];
+	if (mp3DecInfo->outputMode & MP3_OUTPUT_HALFRATE) {
+		bc.nBlocksTotal = MIN(bc.nBlocksTotal, NBANDS / 2);
+		bc.nBlocksPrev = MIN(bc.nBlocksPrev, NBANDS / 2);
+	}
 
 	mi->numPrevIMDCT[ch] = HybridTransform(hi->huffDecBuf[ch], mi->overBuf[ch], mi->outBuf[ch], &si->sis[gr][ch], &bc);
 	mi->prevType[ch] = si->sis[gr][ch].blockType;
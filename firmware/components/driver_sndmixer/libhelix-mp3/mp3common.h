@@ -91,10 +91,16 @@ typedef struct _MP3DecInfo {
 	int mainDataBegin;
 	int mainDataBytes;
 
+	int outputMode;			/* MP3_OUTPUT_* flags */
+
 	int part23Length[MAX_NGRAN][MAX_NCHAN];
 
 } MP3DecInfo;
 
+/* channels and samples per granule of the decoded PCM data */
+#define OUT_CHANS(di)		(((di)->outputMode & MP3_OUTPUT_MONO) ? 1 : (di)->nChans)
+#define OUT_GRANSAMPS(di)	(((di)->outputMode & MP3_OUTPUT_HALFRATE) ? (di)->nGranSamps / 2 : (di)->nGranSamps)
+
 typedef struct _SFBandTable {
 	int/*short*/ l[23];
 	int/*short*/ s[14];
@@ -94,6 +94,35 @@ void MP3FreeDecoder(HMP3Decoder hMP3Decoder)
 	FreeBuffers(mp3DecInfo);
 }
 
+/**************************************************************************************
+ * Function:    MP3SetOutputMode
+ *
+ * Description: select the format of the decoded PCM data
+ *
+ * Inputs:      valid MP3 decoder instance pointer (HMP3Decoder)
+ *              MP3_OUTPUT_* flags, 0 for full rate and all channels (the default)
+ *
+ * Outputs:     none
+ *
+ * Return:      none
+ *
+ * Notes:       MP3_OUTPUT_MONO averages the channels of stereo streams before the
+ *                synthesis filterbank, which then only has to run once
+ *              MP3_OUTPUT_HALFRATE skips the IMDCT of the upper 16 subbands and only
+ *                computes every other output sample of the polyphase filter
+ *              MP3GetLastFrameInfo() reports channels and sample rate of the output
+ *              set this before decoding the first frame
+ **************************************************************************************/
+void MP3SetOutputMode(HMP3Decoder hMP3Decoder, int mode)
+{
+	MP3DecInfo *mp3DecInfo = (MP3DecInfo *)hMP3Decoder;
+
+	if (!mp3DecInfo)
+		return;
+
+	mp3DecInfo->outputMode = mode;
+}
+
 /**************************************************************************************
  * Function:    MP3FindSyncWord
  *
@@ -201,10 +230,14 @@ void MP3GetLastFrameInfo(HMP3Decoder hMP3Decoder, MP3FrameInfo *mp3FrameInfo)
 		mp3FrameInfo->version = 0;
 	} else {
 		mp3FrameInfo->bitrate = mp3DecInfo->bitrate;
-		mp3FrameInfo->nChans = mp3DecInfo->nChans;
+		mp3FrameInfo->nChans = OUT_CHANS(mp3DecInfo);
 		mp3FrameInfo->samprate = mp3DecInfo->samprate;
 		mp3FrameInfo->bitsPerSample = 16;
-		mp3FrameInfo->outputSamps = mp3DecInfo->nChans * (int)samplesPerFrameTab[mp3DecInfo->version][mp3DecInfo->layer - 1];
+		mp3FrameInfo->outputSamps = OUT_CHANS(mp3DecInfo) * (int)samplesPerFrameTab[mp3DecInfo->version][mp3DecInfo->layer - 1];
+		if (mp3DecInfo->outputMode & MP3_OUTPUT_HALFRATE) {
+			mp3FrameInfo->samprate /= 2;
+			mp3FrameInfo->outputSamps /= 2;
+		}
 		mp3FrameInfo->layer = mp3DecInfo->layer;
 		mp3FrameInfo->version = mp3DecInfo->version;
 	}
@@ -258,7 +291,7 @@ static void MP3ClearBadFrame(MP3DecInfo *mp3DecInfo, short *outbuf)
 	if (!mp3DecInfo)
 		return;
 
-	for (i = 0; i < mp3DecInfo->nGrans * mp3DecInfo->nGranSamps * mp3DecInfo->nChans; i++)
+	for (i = 0; i < mp3DecInfo->nGrans * OUT_GRANSAMPS(mp3DecInfo) * OUT_CHANS(mp3DecInfo); i++)
 		outbuf[i] = 0;
 }
 
@@ -470,7 +503,7 @@ int MP3Decode(HMP3Decoder hMP3Decoder, unsigned char **inbuf, int *bytesLeft, sh
 			time = systime_get();
 		#endif
 		/* subband transform - if stereo, interleaves pcm LRLRLR */
-		if (Subband(mp3DecInfo, outbuf + gr*mp3DecInfo->nGranSamps*mp3DecInfo->nChans) < 0) {
+		if (Subband(mp3DecInfo, outbuf + gr*OUT_GRANSAMPS(mp3DecInfo)*OUT_CHANS(mp3DecInfo)) < 0) {
 			MP3ClearBadFrame(mp3DecInfo, outbuf);
 			return ERR_MP3_INVALID_SUBBAND;			
 		}
@@ -99,9 +99,14 @@ typedef struct _MP3FrameInfo {
 	int version;
 } MP3FrameInfo;
 
+/* output modes, see MP3SetOutputMode() */
+#define MP3_OUTPUT_MONO			0x01	/* downmix stereo to one channel */
+#define MP3_OUTPUT_HALFRATE		0x02	/* half the sample rate, upper half of the spectrum is dropped */
+
 /* public API */
 HMP3Decoder MP3InitDecoder(void);
 void MP3FreeDecoder(HMP3Decoder hMP3Decoder);
+void MP3SetOutputMode(HMP3Decoder hMP3Decoder, int mode);
 int MP3Decode(HMP3Decoder hMP3Decoder, unsigned char **inbuf, int *bytesLeft, short *outbuf, int useSize);
 
 void MP3GetLastFrameInfo(HMP3Decoder hMP3Decoder, MP3FrameInfo *mp3FrameInfo);
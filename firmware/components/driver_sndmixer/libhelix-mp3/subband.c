@@ -53,13 +53,17 @@
  * Inputs:      filled MP3DecInfo structure, after calling IMDCT for all channels
  *              vbuf[ch] and vindex[ch] must be preserved between calls
  *
- * Outputs:     decoded PCM data, interleaved LRLRLR... if stereo
+ * Outputs:     decoded PCM data, interleaved LRLRLR... if stereo output
+ *
+ * Notes:       with MP3_OUTPUT_MONO, stereo is averaged before the synthesis filterbank,
+ *                which is linear, so it only runs once
+ *              with MP3_OUTPUT_HALFRATE, produces 16 samples per block instead of 32
  *
  * Return:      0 on success,  -1 if null input pointers
  **************************************************************************************/
 /*__attribute__ ((section (".data"))) */ int Subband(MP3DecInfo *mp3DecInfo, short *pcmBuf)
 {
-	int b;
+	int b, i, gb, nOut;
 	//HuffmanInfo *hi;
 	IMDCTInfo *mi;
 	SubbandInfo *sbi;
@@ -72,22 +76,40 @@
 	mi = (IMDCTInfo *)(mp3DecInfo->IMDCTInfoPS);
 	sbi = (SubbandInfo*)(mp3DecInfo->SubbandInfoPS);
 
-	if (mp3DecInfo->nChans == 2) {
+	nOut = (mp3DecInfo->outputMode & MP3_OUTPUT_HALFRATE) ? NBANDS / 2 : NBANDS;
+
+	if (OUT_CHANS(mp3DecInfo) == 2) {
 		/* stereo */
 		for (b = 0; b < BLOCK_SIZE; b++) {
 			FDCT32(mi->outBuf[0][b], sbi->vbuf + 0*32, sbi->vindex, (b & 0x01), mi->gb[0]);
 			FDCT32(mi->outBuf[1][b], sbi->vbuf + 1*32, sbi->vindex, (b & 0x01), mi->gb[1]);
-			PolyphaseStereo(pcmBuf, sbi->vbuf + sbi->vindex + VBUF_LENGTH * (b & 0x01), polyCoef);
+			if (nOut == NBANDS)
+				PolyphaseStereo(pcmBuf, sbi->vbuf + sbi->vindex + VBUF_LENGTH * (b & 0x01), polyCoef);
+			else
+				PolyphaseStereoHalf(pcmBuf, sbi->vbuf + sbi->vindex + VBUF_LENGTH * (b & 0x01), polyCoef);
 			sbi->vindex = (sbi->vindex - (b & 0x01)) & 7;
-			pcmBuf += (2 * NBANDS);
+			pcmBuf += (2 * nOut);
 		}
 	} else {
-		/* mono */
+		/* mono, or stereo downmixed to mono: (L+R)/2 can not gain bits, so the guard bits
+		 *   of the channel with the fewest are enough
+		 */
+		gb = mi->gb[0];
+		if (mp3DecInfo->nChans == 2) {
+			for (b = 0; b < BLOCK_SIZE; b++) {
+				for (i = 0; i < nOut; i++)
+					mi->outBuf[0][b][i] = (mi->outBuf[0][b][i] >> 1) + (mi->outBuf[1][b][i] >> 1);
+			}
+			gb = MIN(mi->gb[0], mi->gb[1]);
+		}
 		for (b = 0; b < BLOCK_SIZE; b++) {
-			FDCT32(mi->outBuf[0][b], sbi->vbuf + 0*32, sbi->vindex, (b & 0x01), mi->gb[0]);
-			PolyphaseMono(pcmBuf, sbi->vbuf + sbi->vindex + VBUF_LENGTH * (b & 0x01), polyCoef);
+			FDCT32(mi->outBuf[0][b], sbi->vbuf + 0*32, sbi->vindex, (b & 0x01), gb);
+			if (nOut == NBANDS)
+				PolyphaseMono(pcmBuf, sbi->vbuf + sbi->vindex + VBUF_LENGTH * (b & 0x01), polyCoef);
+			else
+				PolyphaseMonoHalf(pcmBuf, sbi->vbuf + sbi->vindex + VBUF_LENGTH * (b & 0x01), polyCoef);
 			sbi->vindex = (sbi->vindex - (b & 0x01)) & 7;
-			pcmBuf += NBANDS;
+			pcmBuf += nOut;
 		}
 	}
 
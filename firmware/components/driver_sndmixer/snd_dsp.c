@@ -0,0 +1,157 @@
+#include <sdkconfig.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "sndmixer.h"
+#include "snd_dsp.h"
+
+#ifdef CONFIG_DRIVER_SNDMIXER_ENABLE
+
+#define BIQUAD_SHIFT 26  // fractional bits of the filter coefficients
+
+#define LIMITER_THRESHOLD     32000
+#define LIMITER_UNITY         (1 << 16)
+#define LIMITER_RELEASE_SHIFT 12  // release time constant in samples, log2
+
+// Filter formulas from the Audio EQ Cookbook by Robert Bristow-Johnson
+int dsp_biquad_design(int32_t coef[5], int type, float frequency, float q, float gain_db,
+                      int samplerate) {
+  if (type == SNDMIXER_EQ_OFF || frequency <= 0 || frequency >= samplerate / 2 || q <= 0)
+    return 0;
+  float w0    = 2 * (float)M_PI * frequency / samplerate;
+  float cosw  = cosf(w0);
+  float alpha = sinf(w0) / (2 * q);
+  float A     = powf(10, gain_db / 40);
+  float sq    = 2 * sqrtf(A) * alpha;
+  float b0, b1, b2, a0, a1, a2;
+  switch (type) {
+    case SNDMIXER_EQ_LOWPASS:
+      b0 = b2 = (1 - cosw) / 2;
+      b1      = 1 - cosw;
+      a0      = 1 + alpha;
+      a1      = -2 * cosw;
+      a2      = 1 - alpha;
+      break;
+    case SNDMIXER_EQ_HIGHPASS:
+      b0 = b2 = (1 + cosw) / 2;
+      b1      = -(1 + cosw);
+      a0      = 1 + alpha;
+      a1      = -2 * cosw;
+      a2      = 1 - alpha;
+      break;
+    case SNDMIXER_EQ_PEAK:
+      b0 = 1 + alpha * A;
+      b1 = -2 * cosw;
+      b2 = 1 - alpha * A;
+      a0 = 1 + alpha / A;
+      a1 = -2 * cosw;
+      a2 = 1 - alpha / A;
+      break;
+    case SNDMIXER_EQ_LOWSHELF:
+      b0 = A * ((A + 1) - (A - 1) * cosw + sq);
+      b1 = 2 * A * ((A - 1) - (A + 1) * cosw);
+      b2 = A * ((A + 1) - (A - 1) * cosw - sq);
+      a0 = (A + 1) + (A - 1) * cosw + sq;
+      a1 = -2 * ((A - 1) + (A + 1) * cosw);
+      a2 = (A + 1) + (A - 1) * cosw - sq;
+      break;
+    case SNDMIXER_EQ_HIGHSHELF:
+      b0 = A * ((A + 1) + (A - 1) * cosw + sq);
+      b1 = -2 * A * ((A - 1) + (A + 1) * cosw);
+      b2 = A * ((A + 1) + (A - 1) * cosw - sq);
+      a0 = (A + 1) - (A - 1) * cosw + sq;
+      a1 = 2 * ((A - 1) - (A + 1) * cosw);
+      a2 = (A + 1) - (A - 1) * cosw - sq;
+      break;
+    default:
+      return 0;
+  }
+  float c[5] = {b0 / a0, b1 / a0, b2 / a0, a1 / a0, a2 / a0};
+  for (int i = 0; i < 5; i++) {
+    // Coefficients have 5 integer bits; that is enough for gains up to about 30 dB.
+    if (fabsf(c[i]) >= (1 << (31 - BIQUAD_SHIFT)))
+      return 0;
+    coef[i] = lrintf(c[i] * (1 << BIQUAD_SHIFT));
+  }
+  return 1;
+}
+
+void dsp_biquad(const int32_t coef[5], int32_t state[4], int32_t *buf, int n, int stride) {
+  int32_t x1 = state[0], x2 = state[1], y1 = state[2], y2 = state[3];
+  for (int i = 0; i < n; i++) {
+    int32_t x   = buf[i * stride];
+    int64_t acc = (int64_t)coef[0] * x + (int64_t)coef[1] * x1 + (int64_t)coef[2] * x2 -
+                  (int64_t)coef[3] * y1 - (int64_t)coef[4] * y2;
+    int32_t y   = acc >> BIQUAD_SHIFT;
+    x2          = x1;
+    x1          = x;
+    y2          = y1;
+    y1          = y;
+    buf[i * stride] = y;
+  }
+  state[0] = x1;
+  state[1] = x2;
+  state[2] = y1;
+  state[3] = y2;
+}
+
+void dsp_limiter_init(dsp_limiter_t *lim) {
+  memset(lim, 0, sizeof(*lim));
+  lim->gain   = LIMITER_UNITY;
+  lim->target = LIMITER_UNITY;
+}
+
+#define SAT(x, min, max) ((x > max) ? max : (x < min) ? min : x)
+
+void dsp_limiter(dsp_limiter_t *lim, const int32_t *in, int16_t *out, int n, int stereo) {
+  int channels = stereo ? 2 : 1;
+  for (int i = 0; i < n; i++) {
+    int32_t peak = 0;
+    for (int c = 0; c < channels; c++) {
+      int32_t s = in[i * channels + c];
+      if (s < 0)
+        s = -s;
+      if (s > peak)
+        peak = s;
+    }
+
+    // A sample that is too loud; make sure the gain is low enough when it leaves the delay line,
+    // and keep it there until then.
+    if (peak > LIMITER_THRESHOLD) {
+      int32_t needed = ((int64_t)LIMITER_THRESHOLD << 16) / peak;
+      lim->hold      = DSP_LIMITER_LOOKAHEAD + 1;
+      if (needed < lim->target) {
+        int32_t step = (lim->gain - needed + DSP_LIMITER_LOOKAHEAD - 1) / DSP_LIMITER_LOOKAHEAD;
+        if (step > lim->step)
+          lim->step = step;
+        lim->target = needed;
+      }
+    }
+
+    if (lim->gain > lim->target) {
+      lim->gain -= lim->step;
+      if (lim->gain < lim->target)
+        lim->gain = lim->target;
+    } else if (lim->hold == 0 && lim->gain < LIMITER_UNITY) {
+      lim->gain += ((LIMITER_UNITY - lim->gain) >> LIMITER_RELEASE_SHIFT) + 1;
+      if (lim->gain > LIMITER_UNITY)
+        lim->gain = LIMITER_UNITY;
+      lim->target = lim->gain;
+      lim->step   = 0;
+    }
+    if (lim->hold > 0)
+      lim->hold--;
+
+    int32_t *d = &lim->delay[lim->pos * channels];
+    for (int c = 0; c < channels; c++) {
+      int32_t s             = ((int64_t)d[c] * lim->gain) >> 16;
+      out[i * channels + c] = SAT(s, INT16_MIN, INT16_MAX);
+      d[c]                  = in[i * channels + c];
+    }
+    if (++lim->pos == DSP_LIMITER_LOOKAHEAD)
+      lim->pos = 0;
+  }
+}
+
+#endif
@@ -0,0 +1,58 @@
+#pragma once
+#include <stdint.h>
+
+// Samples the limiter looks ahead, i.e. the time it has to turn the gain down before a peak
+#define DSP_LIMITER_LOOKAHEAD 32
+
+/**
+ * @brief Calculate biquad filter coefficients
+ *
+ * @param coef Receives b0, b1, b2, a1 and a2 in 5.26 fixed point
+ * @param type One of the sndmixer_eq_t types
+ * @param frequency Corner or center frequency in Hz
+ * @param q Quality factor; 0.707 gives a flat response for low- and highpass filters
+ * @param gain_db Gain for the peak and shelf filters
+ * @param samplerate Sample rate the filter runs at
+ * @return 0 if the filter does nothing (SNDMIXER_EQ_OFF or invalid parameters), 1 otherwise
+ */
+int dsp_biquad_design(int32_t coef[5], int type, float frequency, float q, float gain_db,
+                      int samplerate);
+
+/**
+ * @brief Run a biquad filter over n samples in place
+ *
+ * @param coef Coefficients from dsp_biquad_design
+ * @param state Filter state, 4 values, zero initially
+ * @param buf First sample
+ * @param n Amount of samples
+ * @param stride Distance between samples, 2 to filter one channel of interleaved stereo
+ */
+void dsp_biquad(const int32_t coef[5], int32_t state[4], int32_t *buf, int n, int stride);
+
+typedef struct {
+  int32_t delay[DSP_LIMITER_LOOKAHEAD * 2];
+  int pos;
+  int32_t gain;    // current gain, 16.16 fixed
+  int32_t target;  // lowest gain needed for the samples in the delay line
+  int32_t step;    // gain decrease per sample while attacking
+  int hold;        // samples until the last loud sample has left the delay line
+} dsp_limiter_t;
+
+/**
+ * @brief Initialize limiter state
+ */
+void dsp_limiter_init(dsp_limiter_t *lim);
+
+/**
+ * @brief Limit n frames to the 16-bit range
+ *
+ * The gain is lowered gradually before a peak comes out of the delay line and raised slowly
+ * afterwards, instead of clipping the peak. Output lags the input by DSP_LIMITER_LOOKAHEAD frames.
+ *
+ * @param lim Limiter state
+ * @param in Input frames, interleaved if stereo
+ * @param out Output frames
+ * @param n Amount of frames
+ * @param stereo Whether in and out hold stereo frames
+ */
+void dsp_limiter(dsp_limiter_t *lim, const int32_t *in, int16_t *out, int n, int stereo);
@@ -0,0 +1,122 @@
+#include <sdkconfig.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "snd_resample.h"
+
+#ifdef CONFIG_DRIVER_SNDMIXER_ENABLE
+
+#define PHASE_SHIFT (16 - RESAMPLE_SINC_PHASE_BITS)
+
+int16_t *resample_sinc_table(uint32_t rate) {
+  int16_t *table = malloc(RESAMPLE_SINC_PHASES * RESAMPLE_SINC_TAPS * sizeof(int16_t));
+  if (!table)
+    return NULL;
+  // Cut off a bit below the Nyquist frequency of the source or the output, whichever is lower.
+  float cutoff = 0.9f;
+  if (rate > 0x10000)
+    cutoff = 0.9f * 0x10000 / rate;
+  for (int phase = 0; phase < RESAMPLE_SINC_PHASES; phase++) {
+    float t = (float)phase / RESAMPLE_SINC_PHASES;
+    float coef[RESAMPLE_SINC_TAPS];
+    float sum = 0;
+    for (int k = 0; k < RESAMPLE_SINC_TAPS; k++) {
+      // Distance between the output position and this tap, in source samples
+      float d = RESAMPLE_SINC_TAPS / 2 - 1 + t - k;
+      float x = (float)M_PI * cutoff * d;
+      float s = (x == 0) ? 1.0f : sinf(x) / x;
+      // Blackman window
+      float w = 0.42f + 0.5f * cosf((float)M_PI * d / (RESAMPLE_SINC_TAPS / 2)) +
+                0.08f * cosf(2 * (float)M_PI * d / (RESAMPLE_SINC_TAPS / 2));
+      coef[k] = s * w;
+      sum += coef[k];
+    }
+    // Normalize, so a constant signal passes unchanged.
+    for (int k = 0; k < RESAMPLE_SINC_TAPS; k++) {
+      table[phase * RESAMPLE_SINC_TAPS + k] = lrintf(coef[k] * (1 << 14) / sum);
+    }
+  }
+  return table;
+}
+
+void resample_nearest(const int16_t *buffer, int stereo, uint32_t *acc, uint32_t rate, int32_t *out,
+                      int n) {
+  uint32_t a = *acc;
+  if (stereo) {
+    for (int i = 0; i < n; i++) {
+      a += rate;
+      int pos        = a >> 16;
+      out[i * 2 + 0] = buffer[pos * 2 + 0];
+      out[i * 2 + 1] = buffer[pos * 2 + 1];
+    }
+  } else {
+    for (int i = 0; i < n; i++) {
+      a += rate;
+      out[i] = buffer[a >> 16];
+    }
+  }
+  *acc = a;
+}
+
+// Interpolates between the current and the previous source sample.
+void resample_linear(const int16_t *buffer, int stereo, uint32_t *acc, uint32_t rate, int32_t *out,
+                     int n) {
+  uint32_t a = *acc;
+  if (stereo) {
+    for (int i = 0; i < n; i++) {
+      a += rate;
+      int pos          = a >> 16;
+      int32_t frac     = (a & 0xFFFF) >> 1;
+      const int16_t *s = &buffer[pos * 2 - 2];
+      out[i * 2 + 0]   = s[0] + (((s[2] - s[0]) * frac) >> 15);
+      out[i * 2 + 1]   = s[1] + (((s[3] - s[1]) * frac) >> 15);
+    }
+  } else {
+    for (int i = 0; i < n; i++) {
+      a += rate;
+      int pos          = a >> 16;
+      int32_t frac     = (a & 0xFFFF) >> 1;
+      const int16_t *s = &buffer[pos - 1];
+      out[i]           = s[0] + (((s[1] - s[0]) * frac) >> 15);
+    }
+  }
+  *acc = a;
+}
+
+// Windowed sinc interpolation over the last RESAMPLE_SINC_TAPS source samples. The output lags
+// RESAMPLE_SINC_TAPS / 2 samples behind the source position.
+void resample_sinc(const int16_t *table, const int16_t *buffer, int stereo, uint32_t *acc,
+                   uint32_t rate, int32_t *out, int n) {
+  uint32_t a = *acc;
+  if (stereo) {
+    for (int i = 0; i < n; i++) {
+      a += rate;
+      int pos          = a >> 16;
+      const int16_t *c = &table[((a & 0xFFFF) >> PHASE_SHIFT) * RESAMPLE_SINC_TAPS];
+      const int16_t *s = &buffer[(pos - RESAMPLE_SINC_TAPS + 1) * 2];
+      int32_t l = 0, r = 0;
+      for (int k = 0; k < RESAMPLE_SINC_TAPS; k++) {
+        l += s[k * 2 + 0] * c[k];
+        r += s[k * 2 + 1] * c[k];
+      }
+      out[i * 2 + 0] = l >> 14;
+      out[i * 2 + 1] = r >> 14;
+    }
+  } else {
+    for (int i = 0; i < n; i++) {
+      a += rate;
+      int pos          = a >> 16;
+      const int16_t *c = &table[((a & 0xFFFF) >> PHASE_SHIFT) * RESAMPLE_SINC_TAPS];
+      const int16_t *s = &buffer[pos - RESAMPLE_SINC_TAPS + 1];
+      int32_t v        = 0;
+      for (int k = 0; k < RESAMPLE_SINC_TAPS; k++) {
+        v += s[k] * c[k];
+      }
+      out[i] = v >> 14;
+    }
+  }
+  *acc = a;
+}
+
+#endif
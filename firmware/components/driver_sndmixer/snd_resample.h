@@ -0,0 +1,36 @@
+#pragma once
+#include <stdint.h>
+
+// Amount of previous source frames the resamplers look at. Channel buffers keep this many frames
+// of the previous chunk in front of the current one.
+#define RESAMPLE_HISTORY 16
+
+// Sinc filter: taps per output sample and amount of precomputed fractional positions
+#define RESAMPLE_SINC_TAPS       16
+#define RESAMPLE_SINC_PHASE_BITS 6
+#define RESAMPLE_SINC_PHASES     (1 << RESAMPLE_SINC_PHASE_BITS)
+
+/**
+ * @brief Build the coefficient table for the sinc resampler
+ *
+ * The cutoff frequency follows from the rate, so that sources that are played back at a lower rate
+ * than they were recorded at are low-pass filtered instead of aliased.
+ *
+ * @param rate Source samples per output sample, 16.16 fixed
+ * @return RESAMPLE_SINC_PHASES * RESAMPLE_SINC_TAPS coefficients (1.14 fixed) or NULL if out of
+ * memory. Free with free().
+ */
+int16_t *resample_sinc_table(uint32_t rate);
+
+/*
+ * The resamplers below produce n output frames from buffer into out, advancing the 16.16 fixed
+ * position *acc by rate for every frame. Frame (*acc + rate) >> 16 and the RESAMPLE_HISTORY frames
+ * before it, which may lie before the start of buffer, must be valid for every output frame.
+ * Stereo buffers and outputs are interleaved.
+ */
+void resample_nearest(const int16_t *buffer, int stereo, uint32_t *acc, uint32_t rate, int32_t *out,
+                      int n);
+void resample_linear(const int16_t *buffer, int stereo, uint32_t *acc, uint32_t rate, int32_t *out,
+                     int n);
+void resample_sinc(const int16_t *table, const int16_t *buffer, int stereo, uint32_t *acc,
+                   uint32_t rate, int32_t *out, int n);
@@ -2,11 +2,23 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <esp_heap_caps.h>
 #include <ibxm/ibxm.h>
 #include "snd_source_mod.h"
 
 #ifdef CONFIG_DRIVER_SNDMIXER_ENABLE
 
+#ifdef CONFIG_DRIVER_SNDMIXER_MOD_SAMPLE_CACHE
+#define SAMPLE_CACHE_SIZE (CONFIG_DRIVER_SNDMIXER_MOD_SAMPLE_CACHE * 1024)
+#elif defined(CONFIG_SPIRAM_SUPPORT)
+#define SAMPLE_CACHE_SIZE (128 * 1024)
+#else
+#define SAMPLE_CACHE_SIZE 0
+#endif
+
+// Never let one module's cache take more than this part of the free memory.
+#define SAMPLE_CACHE_FREE_DIV 4
+
 typedef struct {
   struct module *module;
   struct replay *replay;
@@ -26,7 +38,20 @@ int mod_init_source(const void *data_start, const void *data_end, int req_sample
     printf("Failed loading mod: %s\n", error);
     goto err;
   }
-  mod->replay = new_replay(mod->module, req_sample_rate, 0);
+  int cache_size = SAMPLE_CACHE_SIZE;
+#ifdef CONFIG_SPIRAM_SUPPORT
+  size_t free_mem = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+  if (free_mem == 0)
+    free_mem = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+#else
+  size_t free_mem = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+#endif
+  if ((size_t)cache_size > free_mem / SAMPLE_CACHE_FREE_DIV)
+    cache_size = free_mem / SAMPLE_CACHE_FREE_DIV;
+  // Interpolation is cheap on decoded samples, so use it when they can be cached.
+  // Samples that do not fit in the cache are played without it.
+  module_set_sample_cache(mod->module, cache_size);
+  mod->replay = new_replay(mod->module, req_sample_rate, cache_size > 0);
   if (!mod->replay)
     goto err;
   mod->sample_rate = req_sample_rate;
@@ -7,16 +7,34 @@
 #include <stdio.h>
 #include <stdbool.h>
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
 #include "sndmixer.h"
 #include "libhelix-mp3/mp3dec.h"
 
 #ifdef CONFIG_DRIVER_SNDMIXER_ENABLE
 
 #define MAX_SAMPLES_PER_FRAME (1152 * 2)
-#define CHUNK_SIZE            32
-#define INTERNAL_BUFFER_SIZE  1024 * 40
-#define INTERNAL_BUFFER_FETCH_WHEN \
-  8192  // new data will be fetched when there is less than this amount of data
+#define CHUNK_SIZE            SNDMIXER_BLOCK_SIZE
+
+#ifdef CONFIG_DRIVER_SNDMIXER_MP3_STREAM_BUFFER
+#define STREAM_BUFFER_SIZE CONFIG_DRIVER_SNDMIXER_MP3_STREAM_BUFFER
+#else
+#define STREAM_BUFFER_SIZE 16384
+#endif
+
+#ifdef CONFIG_DRIVER_SNDMIXER_MP3_HALF_RATE
+#define HALF_RATE 1
+#else
+#define HALF_RATE 0
+#endif
+
+#ifdef CONFIG_DRIVER_SNDMIXER_MP3_DECODE_AHEAD
+#define RING_FRAMES CONFIG_DRIVER_SNDMIXER_MP3_RING_SIZE
+// Decode on the core the mixer does not run on, if there is one.
+#define DECODE_CORE 0
+#endif
 
 typedef struct {
   HMP3Decoder hMP3Decoder;
@@ -28,43 +46,87 @@ typedef struct {
   short *buffer;
   int bufferValid;
   int bufferOffset;
+  int reqRate;     // Sample rate of the mixer
+  int wantStereo;  // Whether the mixer plays stereo
+  int modeSet;     // Whether the decoder output mode has been chosen
 
   unsigned char *dataPtr;  // Pointer to internal buffer (if applicable)
   stream_read_type stream_read;
-  void *stream;  // Pointer to stream
+  void *stream;     // Pointer to stream
+  int streamRead;   // Offset of the next byte to decode in the internal buffer
+  int streamFill;   // Amount of bytes in the internal buffer
+
+#ifdef CONFIG_DRIVER_SNDMIXER_MP3_DECODE_AHEAD
+  // Decoded frames, written by the decoder task and read by the mixer. Both counters only ever
+  // increase and are each written by one side only. They run on different cores, so a side
+  // publishes its counter with a release store after touching the ring and reads the other
+  // side's counter with an acquire load before touching it.
+  int16_t *ring;
+  int ringChannels;
+  uint32_t ringHead;  // frames written
+  uint32_t ringTail;  // frames read
+  int eof;            // set after the last frame has been pushed
+  volatile int stop;
+  TaskHandle_t task;
+  int underruns;
+#endif
 } mp3_ctx_t;
 
 void mp3_deinit_source(void *ctx);
-
-inline void _readData(mp3_ctx_t *mp3) {
-  // Fetch data for internal buffer
-  int dataAvailable   = mp3->dataEnd - mp3->dataCurr;
-  int bufferAvailable = INTERNAL_BUFFER_SIZE - (mp3->dataEnd - mp3->dataStart);
-  int amountFetched   = 0;
-
-  if (dataAvailable < INTERNAL_BUFFER_FETCH_WHEN) {
-    // 1) Get rid of old data
-    if (mp3->dataCurr != mp3->dataStart) {
-      // Move available data to the begin of the buffer
-      // printf("Moving %d bytes of data from %p to %p.\n", dataAvailable, mp3->dataCurr,
-      // mp3->dataStart);
-      memmove(mp3->dataStart, mp3->dataCurr, dataAvailable);
-      mp3->dataCurr = mp3->dataStart;
-      mp3->dataEnd  = mp3->dataStart + dataAvailable;
+static void mp3_free(mp3_ctx_t *mp3);
+
+// Fetch data for the internal buffer of a stream. The buffer is circular; its first MAINBUF_SIZE
+// bytes are mirrored behind the end, so that a frame that wraps around can be decoded in one piece.
+static void _readData(mp3_ctx_t *mp3) {
+  // Wait until half of the buffer is free, so that reads are large.
+  if (mp3->streamFill > STREAM_BUFFER_SIZE / 2)
+    return;
+  while (mp3->streamFill < STREAM_BUFFER_SIZE) {
+    int pos = (mp3->streamRead + mp3->streamFill) % STREAM_BUFFER_SIZE;
+    int len = STREAM_BUFFER_SIZE - mp3->streamFill;
+    if (len > STREAM_BUFFER_SIZE - pos)
+      len = STREAM_BUFFER_SIZE - pos;  // up to the end of the buffer, the rest in the next read
+    ssize_t amountFetched = mp3->stream_read(mp3->stream, mp3->dataPtr + pos, len);
+    if (amountFetched <= 0)
+      break;
+    if (pos < MAINBUF_SIZE) {
+      int mirror = MAINBUF_SIZE - pos;
+      if (mirror > amountFetched)
+        mirror = amountFetched;
+      memcpy(mp3->dataPtr + STREAM_BUFFER_SIZE + pos, mp3->dataPtr + pos, mirror);
     }
-
-    amountFetched = mp3->stream_read(mp3->stream, mp3->dataEnd, bufferAvailable);
-    mp3->dataEnd += amountFetched;  // Our buffer now (hopefully) contains more data
+    mp3->streamFill += amountFetched;
+    if (amountFetched < len)
+      break;  // no more data available right now
   }
+}
 
-  // printf("_readData: %d, %d, %d\n", dataAvailable, bufferAvailable, amountFetched);
+// Lets the decoder skip work whose result would be thrown away: the second channel when the mixer
+// is mono, and the upper half of the spectrum when the mixer rate is at most half the file rate.
+static void mp3_set_output_mode(mp3_ctx_t *mp3) {
+  MP3FrameInfo fi;
+  if (MP3GetNextFrameInfo(mp3->hMP3Decoder, &fi, mp3->dataCurr))
+    return;  // not a valid header, try again at the next sync word
+  int mode = 0;
+  if (!mp3->wantStereo && fi.nChans == 2)
+    mode |= MP3_OUTPUT_MONO;
+  if (HALF_RATE && mp3->reqRate > 0 && fi.samprate >= 2 * mp3->reqRate)
+    mode |= MP3_OUTPUT_HALFRATE;
+  MP3SetOutputMode(mp3->hMP3Decoder, mode);
+  mp3->modeSet = 1;
 }
 
 int mp3_decode(void *ctx) {
   mp3_ctx_t *mp3 = (mp3_ctx_t *)ctx;
 
-  if (mp3->stream)
+  if (mp3->stream) {
     _readData(mp3);
+    // Decode from the internal buffer, up to the end of the mirrored part
+    int contiguous = STREAM_BUFFER_SIZE + MAINBUF_SIZE - mp3->streamRead;
+    mp3->dataStart = mp3->dataPtr + mp3->streamRead;
+    mp3->dataCurr  = mp3->dataStart;
+    mp3->dataEnd   = mp3->dataStart + (mp3->streamFill < contiguous ? mp3->streamFill : contiguous);
+  }
 
   int available = mp3->dataEnd - mp3->dataCurr;
   int nextSync  = MP3FindSyncWord(mp3->dataCurr, available);
@@ -72,10 +134,18 @@ int mp3_decode(void *ctx) {
   if (nextSync >= 0) {
     mp3->dataCurr += nextSync;
     available = mp3->dataEnd - mp3->dataCurr;
+    if (!mp3->modeSet)
+      mp3_set_output_mode(mp3);
 
     // printf("Next syncword @ %d, available = %d\n", nextSync, available);
     int ret = MP3Decode(mp3->hMP3Decoder, &mp3->dataCurr, &available, mp3->buffer, 0);
 
+    if (mp3->stream) {
+      int consumed    = mp3->dataCurr - mp3->dataStart;
+      mp3->streamRead = (mp3->streamRead + consumed) % STREAM_BUFFER_SIZE;
+      mp3->streamFill -= consumed;
+    }
+
     if (ret) {
       printf("MP3Decode error %d\n", ret);
       return 0;
@@ -99,6 +169,93 @@ int mp3_decode(void *ctx) {
   }
 }
 
+#ifdef CONFIG_DRIVER_SNDMIXER_MP3_DECODE_AHEAD
+// Moves the frame decoded last into the ring. Returns 0 if it does not fit yet.
+static int mp3_push_frame(mp3_ctx_t *mp3) {
+  uint32_t head = mp3->ringHead;
+  if (RING_FRAMES - (head - __atomic_load_n(&mp3->ringTail, __ATOMIC_ACQUIRE)) < mp3->bufferValid)
+    return 0;
+  const short *src = mp3->buffer + mp3->bufferOffset;
+  for (int i = 0; i < mp3->bufferValid; i++) {
+    int16_t *dst = &mp3->ring[((head + i) % RING_FRAMES) * mp3->ringChannels];
+    if (mp3->ringChannels == 2) {
+      dst[0] = src[i * mp3->lastChannels];
+      dst[1] = src[i * mp3->lastChannels + mp3->lastChannels - 1];
+    } else {
+      dst[0] = src[i * mp3->lastChannels];
+    }
+  }
+  __atomic_store_n(&mp3->ringHead, head + mp3->bufferValid, __ATOMIC_RELEASE);
+  mp3->bufferValid = 0;
+  return 1;
+}
+
+// Keeps the ring filled until the end of the file or until the source is stopped.
+static void mp3_decode_task(void *arg) {
+  mp3_ctx_t *mp3 = (mp3_ctx_t *)arg;
+  while (!mp3->stop) {
+    if (mp3->bufferValid <= 0 && !mp3->eof && !mp3_decode(mp3))
+      __atomic_store_n(&mp3->eof, 1, __ATOMIC_RELEASE);
+    if (mp3->eof || !mp3_push_frame(mp3)) {
+      // Wait for the mixer to take data out of the ring, or to stop us.
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+  }
+  mp3_free(mp3);
+  vTaskDelete(NULL);
+}
+
+static int mp3_start_decoder(mp3_ctx_t *mp3) {
+  mp3->ringChannels = (mp3->lastChannels == 2) ? 2 : 1;
+  mp3->ring         = malloc(RING_FRAMES * mp3->ringChannels * sizeof(int16_t));
+  if (!mp3->ring)
+    return 0;
+  mp3->eof = (mp3->bufferValid <= 0);
+  mp3_push_frame(mp3);
+  if (!xTaskCreatePinnedToCore(&mp3_decode_task, "mp3dec", 3072, mp3, 4, &mp3->task,
+                               DECODE_CORE)) {
+    mp3->task = NULL;
+    return 0;
+  }
+  return 1;
+}
+
+static int mp3_fill_buffer_ring(mp3_ctx_t *mp3, int16_t *buffer, int stereo) {
+  int channels  = (stereo && mp3->ringChannels == 2) ? 2 : 1;
+  uint32_t tail = mp3->ringTail;
+  // Check for the end first; once it is seen, all frames are visible too.
+  int eof = __atomic_load_n(&mp3->eof, __ATOMIC_ACQUIRE);
+  int len = __atomic_load_n(&mp3->ringHead, __ATOMIC_ACQUIRE) - tail;
+  if (len == 0) {
+    if (eof)
+      return 0;
+    // The decoder did not keep up. Play silence instead of waiting for it.
+    mp3->underruns++;
+    memset(buffer, 0, CHUNK_SIZE * channels * sizeof(int16_t));
+    return CHUNK_SIZE;
+  }
+  if (len > CHUNK_SIZE)
+    len = CHUNK_SIZE;
+  for (int i = 0; i < len; i++) {
+    const int16_t *src = &mp3->ring[((tail + i) % RING_FRAMES) * mp3->ringChannels];
+    if (channels == 2) {
+      buffer[i * 2 + 0] = src[0];
+      buffer[i * 2 + 1] = src[1];
+    } else {
+      buffer[i] = src[0];
+    }
+  }
+  __atomic_store_n(&mp3->ringTail, tail + len, __ATOMIC_RELEASE);
+  xTaskNotifyGive(mp3->task);
+  return len;
+}
+
+int mp3_get_underruns(void *ctx) {
+  mp3_ctx_t *mp3 = (mp3_ctx_t *)ctx;
+  return mp3->underruns;
+}
+#endif
+
 int mp3_init_source(const void *data_start, const void *data_end, int req_sample_rate, void **ctx,
                     int *stereo) {
   // Allocate space for the information struct
@@ -122,6 +279,8 @@ int mp3_init_source(const void *data_start, const void *data_end, int req_sample
   mp3->buffer       = calloc(MAX_SAMPLES_PER_FRAME, sizeof(short));
   mp3->bufferValid  = 0;
   mp3->bufferOffset = 0;
+  mp3->reqRate      = req_sample_rate;
+  mp3->wantStereo   = *stereo;
   mp3->dataPtr      = NULL;
   mp3->stream_read  = NULL;
   mp3->stream       = NULL;
@@ -130,11 +289,15 @@ int mp3_init_source(const void *data_start, const void *data_end, int req_sample
 
   printf("MP3 source started, data at %p with size %u!\n", mp3->dataStart, length);
 
-  *ctx    = (void *)mp3;
-  *stereo = (mp3->lastChannels == 2);
+  *ctx = (void *)mp3;
 
   mp3_decode(*ctx);  // Decode first part
 
+  *stereo = (mp3->lastChannels == 2);
+#ifdef CONFIG_DRIVER_SNDMIXER_MP3_DECODE_AHEAD
+  if (!mp3_start_decoder(mp3))
+    goto err;
+#endif
   return CHUNK_SIZE;  // Chunk size
 
 err:
@@ -162,11 +325,13 @@ int mp3_init_source_stream(const void *stream_read_fn, const void *stream, int r
   mp3->buffer       = calloc(MAX_SAMPLES_PER_FRAME, sizeof(short));
   mp3->bufferValid  = 0;
   mp3->bufferOffset = 0;
+  mp3->reqRate      = req_sample_rate;
+  mp3->wantStereo   = *stereo;
 
   mp3->stream_read = (stream_read_type)stream_read_fn;
   mp3->stream      = (void *)stream;
   printf("COMPARE: stream read fn @ %p and stream at %p\n", mp3->stream_read, mp3->stream);
-  mp3->dataPtr   = malloc(INTERNAL_BUFFER_SIZE);
+  mp3->dataPtr   = malloc(STREAM_BUFFER_SIZE + MAINBUF_SIZE);
   mp3->dataStart = mp3->dataPtr;
   mp3->dataCurr  = mp3->dataPtr;
   mp3->dataEnd   = mp3->dataPtr;
@@ -188,6 +353,10 @@ int mp3_init_source_stream(const void *stream_read_fn, const void *stream, int r
          mp3->lastRate, mp3->lastChannels);
 
   *stereo = mp3->lastChannels == 2;
+#ifdef CONFIG_DRIVER_SNDMIXER_MP3_DECODE_AHEAD
+  if (!mp3_start_decoder(mp3))
+    goto err;
+#endif
   return CHUNK_SIZE;  // Chunk size
 
 err:
@@ -203,6 +372,9 @@ int mp3_get_sample_rate(void *ctx) {
 
 int mp3_fill_buffer(void *ctx, int16_t *buffer, int stereo) {
   mp3_ctx_t *mp3 = (mp3_ctx_t *)ctx;
+#ifdef CONFIG_DRIVER_SNDMIXER_MP3_DECODE_AHEAD
+  return mp3_fill_buffer_ring(mp3, buffer, stereo);
+#else
   if (mp3->bufferValid <= 0)
     mp3_decode(ctx);
   if (mp3->bufferValid > 0) {
@@ -223,28 +395,50 @@ int mp3_fill_buffer(void *ctx, int16_t *buffer, int stereo) {
   }
 
   return 0;
+#endif
+}
+
+static void mp3_free(mp3_ctx_t *mp3) {
+  MP3FreeDecoder(mp3->hMP3Decoder);
+  if (mp3->buffer)
+    free(mp3->buffer);
+  if (mp3->dataPtr)
+    free(mp3->dataPtr);  // Stream
+#ifdef CONFIG_DRIVER_SNDMIXER_MP3_DECODE_AHEAD
+  free(mp3->ring);
+#endif
+  free(mp3);
 }
 
 void mp3_deinit_source(void *ctx) {
   mp3_ctx_t *mp3 = (mp3_ctx_t *)ctx;
   if (mp3) {
-    MP3FreeDecoder(mp3->hMP3Decoder);
-    if (mp3->buffer)
-      free(mp3->buffer);
-    if (mp3->dataPtr)
-      free(mp3->dataPtr);  // Stream
-    free(mp3);
+#ifdef CONFIG_DRIVER_SNDMIXER_MP3_DECODE_AHEAD
+    if (mp3->task) {
+      // The decoder task may be busy; it frees everything when it notices it has to stop.
+      mp3->stop = 1;
+      xTaskNotifyGive(mp3->task);
+      return;
+    }
+#endif
+    mp3_free(mp3);
   }
 }
 
 const sndmixer_source_t sndmixer_source_mp3 = {.init_source     = mp3_init_source,
                                                .get_sample_rate = mp3_get_sample_rate,
                                                .fill_buffer     = mp3_fill_buffer,
+#ifdef CONFIG_DRIVER_SNDMIXER_MP3_DECODE_AHEAD
+                                               .get_underruns   = mp3_get_underruns,
+#endif
                                                .deinit_source   = mp3_deinit_source};
 
 const sndmixer_source_t sndmixer_source_mp3_stream = {.init_source     = mp3_init_source_stream,
                                                       .get_sample_rate = mp3_get_sample_rate,
                                                       .fill_buffer     = mp3_fill_buffer,
+#ifdef CONFIG_DRIVER_SNDMIXER_MP3_DECODE_AHEAD
+                                                      .get_underruns   = mp3_get_underruns,
+#endif
                                                       .deinit_source   = mp3_deinit_source};
 
 #endif
@@ -0,0 +1,298 @@
+#include <sdkconfig.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "sndmixer.h"
+
+#ifdef CONFIG_DRIVER_SNDMIXER_ENABLE
+
+#define CHUNK_SIZE SNDMIXER_BLOCK_SIZE
+
+#ifdef CONFIG_DRIVER_SNDMIXER_SYNTH_VOICES
+#define VOICES CONFIG_DRIVER_SNDMIXER_SYNTH_VOICES
+#else
+#define VOICES 16
+#endif
+
+#define ENV_MAX        (1 << 24)  // envelope level at full volume
+#define HEADROOM_SHIFT 2          // a single voice plays at 1/4 of full scale, so chords fit
+#define SINE_BITS      8
+#define SINE_SIZE      (1 << SINE_BITS)
+
+// Waveforms, same numbers as the basic synthesizer
+#define WAVE_SINE     0
+#define WAVE_SQUARE   1
+#define WAVE_TRIANGLE 2
+#define WAVE_SAW      3
+#define WAVE_NOISE    4
+
+typedef enum { STAGE_IDLE = 0, STAGE_ATTACK, STAGE_DECAY, STAGE_SUSTAIN, STAGE_RELEASE } stage_t;
+
+typedef struct {
+  stage_t stage;
+  int32_t level;      // envelope level, 0 to ENV_MAX
+  int32_t delta;      // envelope change per sample in this stage
+  int32_t remaining;  // samples until the next stage, or -1 to stay
+  uint32_t phase;     // oscillator phase, a full period is 2^32
+  uint32_t inc;       // phase increase per sample
+  uint32_t noise;     // noise generator state
+  int32_t velocity;   // 15 bit fixed gain
+  uint8_t note;
+  uint32_t started;   // serial of the note on, to find the oldest voice
+} voice_t;
+
+typedef struct {
+  int sampleRate;
+  uint8_t waveform;
+  int32_t attack, decay, release;  // in samples
+  int32_t sustain;                 // envelope level
+  uint32_t serial;
+  int32_t mix[CHUNK_SIZE];
+  voice_t voice[VOICES];
+} poly_ctx_t;
+
+static int16_t sine[SINE_SIZE + 1];  // one extra entry, so interpolation needs no wrap-around
+
+static int32_t ms_to_samples(poly_ctx_t *poly, int ms) {
+  int32_t samples = (int64_t)ms * poly->sampleRate / 1000;
+  return (samples < 1) ? 1 : samples;
+}
+
+int poly_init_source(const void *data_start, const void *data_end, int req_sample_rate, void **ctx,
+                     int *stereo) {
+  poly_ctx_t *poly = calloc(sizeof(poly_ctx_t), 1);
+  if (!poly)
+    return -1;
+  if (sine[SINE_SIZE / 4] == 0) {
+    for (int i = 0; i <= SINE_SIZE; i++)
+      sine[i] = lrintf(32767 * sinf(2 * (float)M_PI * i / SINE_SIZE));
+  }
+  poly->sampleRate = req_sample_rate;
+  poly->attack     = ms_to_samples(poly, 5);
+  poly->decay      = ms_to_samples(poly, 100);
+  poly->sustain    = ENV_MAX / 2;
+  poly->release    = ms_to_samples(poly, 200);
+  for (int v = 0; v < VOICES; v++)
+    poly->voice[v].noise = 0x12345678 + v;
+
+  *ctx    = (void *)poly;
+  *stereo = 0;
+  return CHUNK_SIZE;
+}
+
+int poly_get_sample_rate(void *ctx) {
+  poly_ctx_t *poly = (poly_ctx_t *)ctx;
+  return poly->sampleRate;
+}
+
+static void start_stage(poly_ctx_t *poly, voice_t *voice, stage_t stage) {
+  voice->stage = stage;
+  switch (stage) {
+    case STAGE_ATTACK:
+      // Start from the current level, so retriggered and stolen voices do not click.
+      voice->delta     = ENV_MAX / poly->attack + 1;
+      voice->remaining = (ENV_MAX - voice->level) / voice->delta + 1;
+      break;
+    case STAGE_DECAY:
+      voice->level     = ENV_MAX;
+      voice->delta     = -(ENV_MAX - poly->sustain) / poly->decay;
+      voice->remaining = poly->decay;
+      break;
+    case STAGE_SUSTAIN:
+      voice->level     = poly->sustain;
+      voice->delta     = 0;
+      voice->remaining = -1;
+      if (voice->level == 0)
+        voice->stage = STAGE_IDLE;
+      break;
+    case STAGE_RELEASE:
+      voice->delta     = -(ENV_MAX / poly->release + 1);
+      voice->remaining = voice->level / -voice->delta + 1;
+      break;
+    default:
+      voice->level = 0;
+      break;
+  }
+}
+
+// PolyBLEP correction around a jump of the waveform at phase 0, in 15 bit fixed point. Smooths
+// the step over one sample on either side to remove most of the aliasing.
+static inline int32_t polyblep(uint32_t phase, uint32_t inc) {
+  uint32_t t  = phase >> 16;
+  uint32_t dt = inc >> 16;
+  if (t < dt) {
+    int32_t x = (t << 15) / dt;
+    return x * 2 - ((x * x) >> 15) - 32768;
+  } else if (t > 65535 - dt) {
+    int32_t x = -(int32_t)(((65536 - t) << 15) / dt);
+    return ((x * x) >> 15) + x * 2 + 32768;
+  }
+  return 0;
+}
+
+static inline int32_t oscillator(voice_t *voice, int waveform) {
+  uint32_t p = voice->phase;
+  int32_t s;
+  switch (waveform) {
+    case WAVE_SINE: {
+      int32_t frac     = (p >> (16 - SINE_BITS)) & 0xFFFF;
+      const int16_t *t = &sine[p >> (32 - SINE_BITS)];
+      return t[0] + (((t[1] - t[0]) * (frac >> 1)) >> 15);
+    }
+    case WAVE_SQUARE:
+      s = (p < 0x80000000) ? 32767 : -32767;
+      if (voice->inc >= 0x10000)
+        s += polyblep(p, voice->inc) - polyblep(p + 0x80000000, voice->inc);
+      return s;
+    case WAVE_TRIANGLE:
+      s = (int32_t)(p >> 15);  // 0 to 131071
+      return (s < 65536) ? s - 32768 : 98303 - s;
+    case WAVE_SAW:
+      s = (int32_t)(p >> 16) - 32768;
+      if (voice->inc >= 0x10000)
+        s -= polyblep(p, voice->inc);
+      return s;
+    case WAVE_NOISE:
+      voice->noise ^= voice->noise << 13;
+      voice->noise ^= voice->noise >> 17;
+      voice->noise ^= voice->noise << 5;
+      return (int16_t)(voice->noise >> 16);
+    default:
+      return 0;
+  }
+}
+
+// Adds one chunk of a voice to the mix buffer.
+static void render_voice(poly_ctx_t *poly, voice_t *voice) {
+  int waveform = poly->waveform;
+  for (int i = 0; i < CHUNK_SIZE; i++) {
+    int32_t s = oscillator(voice, waveform);
+    voice->phase += voice->inc;
+    int32_t amp = ((voice->level >> 9) * voice->velocity) >> 15;
+    poly->mix[i] += (s * amp) >> 15;
+    voice->level += voice->delta;
+    if (voice->remaining > 0 && --voice->remaining == 0) {
+      if (voice->stage == STAGE_ATTACK) {
+        start_stage(poly, voice, STAGE_DECAY);
+      } else if (voice->stage == STAGE_DECAY) {
+        start_stage(poly, voice, STAGE_SUSTAIN);
+      } else {
+        start_stage(poly, voice, STAGE_IDLE);
+      }
+      if (voice->stage == STAGE_IDLE)
+        break;
+    }
+  }
+}
+
+int poly_fill_buffer(void *ctx, int16_t *buffer, int stereo) {
+  poly_ctx_t *poly = (poly_ctx_t *)ctx;
+  (void)stereo;
+
+  int active = 0;
+  memset(poly->mix, 0, sizeof(poly->mix));
+  for (int v = 0; v < VOICES; v++) {
+    if (poly->voice[v].stage != STAGE_IDLE) {
+      render_voice(poly, &poly->voice[v]);
+      active++;
+    }
+  }
+  if (!active) {
+    memset(buffer, 0, CHUNK_SIZE * sizeof(buffer[0]));
+    return CHUNK_SIZE;
+  }
+  for (int i = 0; i < CHUNK_SIZE; i++) {
+    int32_t s = poly->mix[i] >> HEADROOM_SHIFT;
+    buffer[i] = (s > INT16_MAX) ? INT16_MAX : (s < INT16_MIN) ? INT16_MIN : s;
+  }
+  return CHUNK_SIZE;
+}
+
+void poly_deinit_source(void *ctx) {
+  free(ctx);
+}
+
+// Picks the voice for a new note. In order of preference: the voice already playing this note, a
+// silent voice, the quietest released voice and finally the voice that was started first.
+static voice_t *find_voice(poly_ctx_t *poly, uint8_t note) {
+  voice_t *best = NULL;
+  for (int v = 0; v < VOICES; v++) {
+    voice_t *voice = &poly->voice[v];
+    if (voice->stage != STAGE_IDLE && voice->note == note)
+      return voice;
+  }
+  for (int v = 0; v < VOICES; v++) {
+    voice_t *voice = &poly->voice[v];
+    if (voice->stage == STAGE_IDLE)
+      return voice;
+    if (voice->stage == STAGE_RELEASE && (!best || voice->level < best->level))
+      best = voice;
+  }
+  if (best)
+    return best;
+  best = &poly->voice[0];
+  for (int v = 1; v < VOICES; v++) {
+    if ((int32_t)(poly->voice[v].started - best->started) < 0)
+      best = &poly->voice[v];
+  }
+  return best;
+}
+
+void poly_note_off(void *ctx, uint8_t note) {
+  poly_ctx_t *poly = (poly_ctx_t *)ctx;
+  for (int v = 0; v < VOICES; v++) {
+    voice_t *voice = &poly->voice[v];
+    if (voice->note == note && voice->stage != STAGE_IDLE && voice->stage != STAGE_RELEASE)
+      start_stage(poly, voice, STAGE_RELEASE);
+  }
+}
+
+void poly_note_on(void *ctx, uint8_t note, uint8_t velocity) {
+  poly_ctx_t *poly = (poly_ctx_t *)ctx;
+  if (note > 127)
+    return;
+  if (velocity == 0) {  // as in MIDI
+    poly_note_off(ctx, note);
+    return;
+  }
+  if (velocity > 127)
+    velocity = 127;
+  voice_t *voice  = find_voice(poly, note);
+  float freq      = 440.0f * powf(2.0f, (note - 69) / 12.0f);
+  voice->inc      = (uint32_t)(freq * 4294967296.0f / poly->sampleRate);
+  voice->note     = note;
+  voice->velocity = (velocity * 32767) / 127;
+  voice->started  = poly->serial++;
+  start_stage(poly, voice, STAGE_ATTACK);
+}
+
+void poly_set_envelope(void *ctx, int attack, int decay, int sustain, int release) {
+  poly_ctx_t *poly = (poly_ctx_t *)ctx;
+  if (sustain < 0)
+    sustain = 0;
+  if (sustain > 127)
+    sustain = 127;
+  poly->attack  = ms_to_samples(poly, attack);
+  poly->decay   = ms_to_samples(poly, decay);
+  poly->sustain = (int64_t)sustain * ENV_MAX / 127;
+  poly->release = ms_to_samples(poly, release);
+}
+
+void poly_set_waveform(void *ctx, uint8_t waveform) {
+  poly_ctx_t *poly = (poly_ctx_t *)ctx;
+  poly->waveform   = waveform;
+}
+
+const sndmixer_source_t sndmixer_source_poly = {.init_source     = poly_init_source,
+                                                .get_sample_rate = poly_get_sample_rate,
+                                                .fill_buffer     = poly_fill_buffer,
+                                                .deinit_source   = poly_deinit_source,
+                                                .set_waveform    = poly_set_waveform,
+                                                .note_on         = poly_note_on,
+                                                .note_off        = poly_note_off,
+                                                .set_envelope    = poly_set_envelope};
+
+#endif
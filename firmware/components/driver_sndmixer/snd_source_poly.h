@@ -0,0 +1,4 @@
+#pragma once
+#include "sndmixer.h"
+
+extern const sndmixer_source_t sndmixer_source_poly;
@@ -11,7 +11,7 @@
 
 #ifdef CONFIG_DRIVER_SNDMIXER_ENABLE
 
-#define CHUNK_SIZE 32
+#define CHUNK_SIZE SNDMIXER_BLOCK_SIZE
 
 typedef struct {
   int sampleRate;
@@ -8,14 +8,35 @@
 
 #ifdef CONFIG_DRIVER_SNDMIXER_ENABLE
 
-#define CHUNK_SIZE 32
+#define CHUNK_SIZE SNDMIXER_BLOCK_SIZE
+
+#ifdef CONFIG_DRIVER_SNDMIXER_WAV_STREAM_BUFFER
+#define STREAM_BUFFER_SIZE CONFIG_DRIVER_SNDMIXER_WAV_STREAM_BUFFER
+#else
+#define STREAM_BUFFER_SIZE 8192
+#endif
+
+#define FORMAT_PCM       0x0001
+#define FORMAT_IMA_ADPCM 0x0011
+
+#define MAX_CHANNELS 8
 
 typedef struct {
-  const uint8_t *data;
-  int pos;
-  int data_len;
+  const uint8_t *data;  // data chunk, or for streams the read-ahead buffer
+  int pos;              // offset of the next byte in data
+  int data_len;         // bytes in data
   int rate;
-  uint16_t channels, bits;
+  uint16_t format, channels, bits, block_align;
+
+  // IMA ADPCM: the decoded frames of the current block
+  int16_t *block;
+  int block_samples;  // frames per block
+  int block_pos, block_len;
+
+  stream_read_type stream_read;
+  void *stream;
+  uint8_t *buffer;     // read-ahead buffer of a stream
+  uint32_t remaining;  // bytes of the data chunk that are not in the buffer yet
 } wav_ctx_t;
 
 typedef struct __attribute__((packed)) {
@@ -46,6 +67,67 @@ typedef struct __attribute__((packed)) {
   };
 } chunk_hdr_t;
 
+static const int16_t ima_step[89] = {
+    7,     8,     9,     10,    11,    12,    13,    14,    16,    17,    19,    21,    23,
+    25,    28,    31,    34,    37,    41,    45,    50,    55,    60,    66,    73,    80,
+    88,    97,    107,   118,   130,   143,   157,   173,   190,   209,   230,   253,   279,
+    307,   337,   371,   408,   449,   494,   544,   598,   658,   724,   796,   876,   963,
+    1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,  2272,  2499,  2749,  3024,  3327,
+    3660,  4026,  4428,  4871,  5358,  5894,  6484,  7132,  7845,  8630,  9493,  10442, 11487,
+    12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767};
+
+static const int8_t ima_index[16] = {-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8};
+
+#define SAT(x, min, max) ((x > max) ? max : (x < min) ? min : x)
+
+// Takes the format of the sound from its fmt chunk. Returns 0 if the format is not supported.
+static int wav_set_format(wav_ctx_t *wav, const fmt_data_t *fmt) {
+  wav->format      = fmt->fmtcode;
+  wav->rate        = fmt->samplespersec;
+  wav->bits        = fmt->bitspersample;
+  wav->channels    = fmt->channels;
+  wav->block_align = fmt->blockalign;
+  if (wav->channels == 0)
+    wav->channels = 1;
+  if (wav->channels > MAX_CHANNELS) {
+    printf("Unsupported amount of wav channels: %d\n", wav->channels);
+    return 0;
+  }
+  if (wav->format == FORMAT_PCM) {
+    if (wav->bits != 8 && wav->bits != 16) {
+      printf("Unsupported bits/sample: %d\n", wav->bits);
+      return 0;
+    }
+  } else if (wav->format == FORMAT_IMA_ADPCM) {
+    // A block starts with a 4 byte header per channel, that holds the first sample. After that,
+    // the channels take turns with 4 bytes (8 samples) each.
+    if (wav->bits != 4 || wav->block_align <= 4 * wav->channels ||
+        wav->block_align % (4 * wav->channels) != 0) {
+      printf("Unsupported ADPCM block layout: %d bytes\n", wav->block_align);
+      return 0;
+    }
+    wav->block_samples = 1 + (wav->block_align - 4 * wav->channels) * 2 / wav->channels;
+  } else {
+    printf("Unsupported wav format: %d\n", wav->format);
+    return 0;
+  }
+  return 1;
+}
+
+// Allocates what is needed to decode the data and reports the source properties.
+static int wav_start(wav_ctx_t *wav, void **ctx, int *stereo) {
+  if (wav->format == FORMAT_IMA_ADPCM) {
+    wav->block = malloc(wav->block_samples * wav->channels * sizeof(wav->block[0]));
+    if (!wav->block)
+      return -1;
+  }
+  printf("Wav: format %d, %d bit/sample, %d Hz\n", wav->format, wav->bits, wav->rate);
+  wav->pos = 0;
+  *ctx     = (void *)wav;
+  *stereo  = (wav->channels >= 2);
+  return CHUNK_SIZE;
+}
+
 int wav_init_source(const void *data_start, const void *data_end, int req_sample_rate, void **ctx,
                     int *stereo) {
   // Check sanity first
@@ -62,34 +144,118 @@ int wav_init_source(const void *data_start, const void *data_end, int req_sample
   while (p < (char *)data_end) {
     chunk_hdr_t *ch = (chunk_hdr_t *)p;
     if (memcmp(ch->magic, "fmt ", 4) == 0) {
-      if (ch->fmt.fmtcode != 0x0001) {
-        printf("Unsupported wav format: %d\n", ch->fmt.fmtcode);
+      if (!wav_set_format(wav, &ch->fmt))
         goto err;
-      }
-      wav->rate     = ch->fmt.samplespersec;
-      wav->bits     = ch->fmt.bitspersample;
-      wav->channels = ch->fmt.channels;
-      if (wav->channels == 0)
-        wav->channels = 1;
     } else if (memcmp(ch->magic, "data", 4) == 0) {
       wav->data_len = ch->size;
       wav->data     = (uint8_t *)ch->data;
+      if (wav->data_len > (char *)data_end + 1 - (char *)wav->data)
+        wav->data_len = (char *)data_end + 1 - (char *)wav->data;  // truncated file
     }
     p += 8 + ch->size;
     if (ch->size & 1)
       p++;  // pad to even address
   }
 
-  if (wav->bits != 8 && wav->bits != 16) {
-    printf("No fmt chunk or unsupported bits/sample: %d\n", wav->bits);
+  if (!wav->format || !wav->data) {
+    printf("No fmt or data chunk\n");
     goto err;
   }
-  printf("Wav: %d bit/sample, %d Hz, %d bytes long\n", wav->bits, wav->rate, wav->data_len);
-  wav->pos = 0;
-  *ctx     = (void *)wav;
-  *stereo  = (wav->channels >= 2);
+  printf("Wav: %d bytes long\n", wav->data_len);
+  if (wav_start(wav, ctx, stereo) < 0)
+    goto err;
+  return CHUNK_SIZE;
+err:
+  if (wav)
+    free(wav->block);
+  free(wav);
+  return -1;
+}
+
+// Reads len bytes from the stream, or less at the end of it.
+static int stream_read_all(wav_ctx_t *wav, void *buf, int len) {
+  int done = 0;
+  while (done < len) {
+    ssize_t r = wav->stream_read(wav->stream, (uint8_t *)buf + done, len - done);
+    if (r <= 0)
+      break;
+    done += r;
+  }
+  return done;
+}
+
+// Skips len bytes of the stream. Returns 0 if it ended first.
+static int stream_skip(wav_ctx_t *wav, uint32_t len) {
+  while (len > 0) {
+    int n = (len < STREAM_BUFFER_SIZE) ? len : STREAM_BUFFER_SIZE;
+    if (stream_read_all(wav, wav->buffer, n) != n)
+      return 0;
+    len -= n;
+  }
+  return 1;
+}
+
+// Same as wav_init_source, but reads the file through read_func from stream, which is passed as
+// data_start and data_end. Only the headers up to the start of the data are read here.
+int wav_init_source_stream(const void *read_func, const void *stream, int req_sample_rate,
+                           void **ctx, int *stereo) {
+  riff_hdr_t riff;
+  struct __attribute__((packed)) {
+    int8_t magic[4];
+    uint32_t size;
+  } ch;
+  fmt_data_t fmt;
+
+  wav_ctx_t *wav = calloc(sizeof(wav_ctx_t), 1);
+  if (!wav)
+    goto err;
+  wav->stream_read = (stream_read_type)read_func;
+  wav->stream      = (void *)stream;
+  wav->buffer      = malloc(STREAM_BUFFER_SIZE);
+  if (!wav->buffer)
+    goto err;
+  if (stream_read_all(wav, &riff, sizeof(riff)) != sizeof(riff))
+    goto err;
+  if (memcmp(riff.riffmagic, "RIFF", 4) != 0 || memcmp(riff.wavemagic, "WAVE", 4) != 0)
+    goto err;
+  while (1) {
+    if (stream_read_all(wav, &ch, sizeof(ch)) != sizeof(ch)) {
+      printf("No data chunk\n");
+      goto err;
+    }
+    if (memcmp(ch.magic, "data", 4) == 0)
+      break;
+    uint32_t skip = ch.size + (ch.size & 1);
+    if (memcmp(ch.magic, "fmt ", 4) == 0) {
+      int n = (ch.size < sizeof(fmt)) ? ch.size : sizeof(fmt);
+      memset(&fmt, 0, sizeof(fmt));
+      if (stream_read_all(wav, &fmt, n) != n || !wav_set_format(wav, &fmt))
+        goto err;
+      skip -= n;
+    }
+    if (!stream_skip(wav, skip))
+      goto err;
+  }
+
+  if (!wav->format) {
+    printf("No fmt chunk before the data\n");
+    goto err;
+  }
+  if (wav->format == FORMAT_IMA_ADPCM && wav->block_align > STREAM_BUFFER_SIZE / 2) {
+    printf("ADPCM blocks too large for the stream buffer: %d bytes\n", wav->block_align);
+    goto err;
+  }
+  // Recorders that can not seek back leave the size at 0 or at its maximum; play until the end.
+  wav->remaining = ch.size ? ch.size : UINT32_MAX;
+  wav->data      = wav->buffer;
+  if (wav_start(wav, ctx, stereo) < 0)
+    goto err;
   return CHUNK_SIZE;
 err:
+  if (wav) {
+    free(wav->buffer);
+    free(wav->block);
+  }
   free(wav);
   return -1;
 }
@@ -99,43 +265,151 @@ int wav_get_sample_rate(void *ctx) {
   return wav->rate;
 }
 
-int16_t get_sample(wav_ctx_t *wav) {
-  int16_t rv = 0;
-  if (wav->bits == 8) {
-    rv = (wav->data[wav->pos] - 128) << 8;
-    wav->pos += 1;
+// Returns the amount of bytes available at wav->data + wav->pos. A stream buffer is topped up
+// once it is less than half full, so that the stream is read in large pieces.
+static int wav_available(wav_ctx_t *wav) {
+  int avail = wav->data_len - wav->pos;
+  if (!wav->stream_read || avail >= STREAM_BUFFER_SIZE / 2 || wav->remaining == 0)
+    return avail;
+  memmove(wav->buffer, wav->buffer + wav->pos, avail);
+  wav->pos      = 0;
+  wav->data_len = avail;
+  while (wav->data_len < STREAM_BUFFER_SIZE && wav->remaining > 0) {
+    uint32_t len = STREAM_BUFFER_SIZE - wav->data_len;
+    if (len > wav->remaining)
+      len = wav->remaining;
+    ssize_t r = wav->stream_read(wav->stream, wav->buffer + wav->data_len, len);
+    if (r <= 0)
+      break;  // no more data available right now
+    wav->data_len += r;
+    wav->remaining -= r;
+  }
+  return wav->data_len;
+}
+
+static inline int16_t ima_sample(int *pred, int *index, int nibble) {
+  int step = ima_step[*index];
+  int diff = step >> 3;
+  if (nibble & 1)
+    diff += step >> 2;
+  if (nibble & 2)
+    diff += step >> 1;
+  if (nibble & 4)
+    diff += step;
+  if (nibble & 8)
+    diff = -diff;
+  *pred  = SAT(*pred + diff, INT16_MIN, INT16_MAX);
+  *index = SAT(*index + ima_index[nibble], 0, 88);
+  return *pred;
+}
+
+// Decodes the next IMA ADPCM block into wav->block. The last block of a file may be shorter.
+// Returns the amount of frames decoded.
+static int adpcm_next_block(wav_ctx_t *wav) {
+  int channels  = wav->channels;
+  int len       = wav_available(wav);
+  const uint8_t *p = wav->data + wav->pos;
+  if (len > wav->block_align)
+    len = wav->block_align;
+  wav->pos += len;
+  wav->block_pos = 0;
+  wav->block_len = 0;
+  if (len <= 4 * channels)
+    return 0;
+  int groups = (len - 4 * channels) / (4 * channels);  // 8 frames each
+  for (int c = 0; c < channels; c++) {
+    const uint8_t *h = p + 4 * c;
+    int pred         = (int16_t)(h[0] | h[1] << 8);
+    int index        = (h[2] > 88) ? 88 : h[2];
+    int16_t *out     = wav->block + c;
+    *out             = pred;
+    out += channels;
+    const uint8_t *d = p + 4 * channels + 4 * c;
+    for (int g = 0; g < groups; g++, d += 4 * channels) {
+      for (int b = 0; b < 4; b++) {
+        out[0] = ima_sample(&pred, &index, d[b] & 15);
+        out[channels] = ima_sample(&pred, &index, d[b] >> 4);
+        out += 2 * channels;
+      }
+    }
+  }
+  wav->block_len = 1 + groups * 8;
+  return wav->block_len;
+}
+
+// Writes a frame of the source to the output, averaging all channels for mono output.
+static inline void put_frame(int16_t *out, int out_channels, const int16_t *in, int channels) {
+  if (out_channels == 2) {
+    out[0] = in[0];
+    out[1] = in[1];
+  } else if (channels == 1) {
+    out[0] = in[0];
   } else {
-    rv = wav->data[wav->pos] | wav->data[wav->pos + 1] << 8;
-    wav->pos += 2;
+    int32_t sum = 0;
+    for (int k = 0; k < channels; k++)
+      sum += in[k];
+    out[0] = sum / channels;
   }
-  return rv;
+}
+
+// Converts up to n frames of PCM data. Returns the amount of frames converted.
+static int pcm_frames(wav_ctx_t *wav, int16_t *out, int out_channels, int n) {
+  int frame_bytes = wav->channels * wav->bits / 8;
+  int avail       = wav_available(wav) / frame_bytes;
+  if (n > avail)
+    n = avail;
+  const uint8_t *p = wav->data + wav->pos;
+  wav->pos += n * frame_bytes;
+  if (wav->bits == 16 && out_channels == wav->channels) {
+    memcpy(out, p, n * frame_bytes);  // already in the output format
+    return n;
+  }
+  int16_t frame[MAX_CHANNELS];
+  for (int i = 0; i < n; i++) {
+    for (int k = 0; k < wav->channels; k++) {
+      if (wav->bits == 8) {
+        frame[k] = (*p++ - 128) << 8;
+      } else {
+        frame[k] = p[0] | p[1] << 8;
+        p += 2;
+      }
+    }
+    put_frame(out + i * out_channels, out_channels, frame, wav->channels);
+  }
+  return n;
 }
 
 int wav_fill_buffer(void *ctx, int16_t *buffer, int stereo) {
-  wav_ctx_t *wav = (wav_ctx_t *)ctx;
-  int channels   = 1;
-  if (wav->channels == 2 && stereo) {
-    channels = 2;
-  }
-  for (int i = 0; i < CHUNK_SIZE; i++) {
-    if (wav->pos >= wav->data_len)
-      return i;
-    if (channels == 2) {
-      buffer[i * 2 + 0] = get_sample(wav);
-      buffer[i * 2 + 1] = get_sample(wav);
+  wav_ctx_t *wav   = (wav_ctx_t *)ctx;
+  int out_channels = (wav->channels >= 2 && stereo) ? 2 : 1;
+  int i            = 0;
+  while (i < CHUNK_SIZE) {
+    int n;
+    if (wav->format == FORMAT_IMA_ADPCM) {
+      if (wav->block_pos == wav->block_len && !adpcm_next_block(wav))
+        break;
+      n = wav->block_len - wav->block_pos;
+      if (n > CHUNK_SIZE - i)
+        n = CHUNK_SIZE - i;
+      const int16_t *in = wav->block + wav->block_pos * wav->channels;
+      for (int k = 0; k < n; k++)
+        put_frame(buffer + (i + k) * out_channels, out_channels, in + k * wav->channels,
+                  wav->channels);
+      wav->block_pos += n;
     } else {
-      int32_t sum = 0;
-      for (int k = 0; k < wav->channels; k++) {
-        sum += get_sample(wav);
-      }
-      buffer[i] = sum / wav->channels;
+      n = pcm_frames(wav, buffer + i * out_channels, out_channels, CHUNK_SIZE - i);
+      if (n == 0)
+        break;
     }
+    i += n;
   }
-  return CHUNK_SIZE;
+  return i;
 }
 
 void wav_deinit_source(void *ctx) {
   wav_ctx_t *wav = (wav_ctx_t *)ctx;
+  free(wav->buffer);
+  free(wav->block);
   free(wav);
 }
 
@@ -144,4 +418,9 @@ const sndmixer_source_t sndmixer_source_wav = {.init_source     = wav_init_sourc
                                                .fill_buffer     = wav_fill_buffer,
                                                .deinit_source   = wav_deinit_source};
 
+const sndmixer_source_t sndmixer_source_wav_stream = {.init_source     = wav_init_source_stream,
+                                                      .get_sample_rate = wav_get_sample_rate,
+                                                      .fill_buffer     = wav_fill_buffer,
+                                                      .deinit_source   = wav_deinit_source};
+
 #endif
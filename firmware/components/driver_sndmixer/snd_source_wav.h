@@ -2,4 +2,5 @@
 #include "sndmixer.h"
 
 extern const sndmixer_source_t sndmixer_source_wav;
+extern const sndmixer_source_t sndmixer_source_wav_stream;
 
@@ -3,18 +3,23 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
 #include "freertos/portmacro.h"
+#include "esp_timer.h"
 
 #include "driver_i2s.h"
+#include "snd_resample.h"
+#include "snd_dsp.h"
 
 #include "snd_source_wav.h"
 #include "snd_source_mod.h"
 #include "snd_source_mp3.h"
 #include "snd_source_synth.h"
+#include "snd_source_poly.h"
 
 #ifdef CONFIG_DRIVER_SNDMIXER_ENABLE
 
@@ -37,12 +42,23 @@ typedef enum {
   CMD_QUEUE_MP3_STREAM,
   CMD_QUEUE_SYNTH,
   CMD_FREQ,
-  CMD_WAVEFORM
+  CMD_WAVEFORM,
+  CMD_RESAMPLER,
+  CMD_PAN,
+  CMD_EQ,
+  CMD_QUEUE_POLY,
+  CMD_NOTE_ON,
+  CMD_NOTE_OFF,
+  CMD_ENVELOPE,
+  CMD_QUEUE_WAV_STREAM,
+  CMD_RESET_STATS
 } sndmixer_cmd_ins_t;
 
 typedef struct {
   sndmixer_cmd_ins_t cmd;
   int id;
+  int timed;    // apply at sample clock time 'at' instead of right away
+  uint32_t at;
   union {
     struct {
       const void *queue_file_start;
@@ -52,6 +68,17 @@ typedef struct {
     struct {
       int param;
     };
+    struct {
+      int eq_enabled;
+      int32_t eq_coef[5];
+    };
+    struct {
+      int note;
+      int velocity;
+    };
+    struct {
+      int envelope[4];  // attack, decay, sustain, release
+    };
   };
 } sndmixer_cmd_t;
 
@@ -60,11 +87,17 @@ typedef struct {
   const sndmixer_source_t *source;  // or NULL if channel unused
   void *src_ctx;
   int volume;  // 0-256
+  int pan;     // -128 (left) to 128 (right)
+  int32_t gain[2];  // left and right gain applied last, volume << 7
   int flags;
   int16_t *buffer;
   int chunksz;
   uint32_t dds_rate;  // Rate; 16.16 fixed
   uint32_t dds_acc;   // DDS accumulator, 16.16 fixed
+  int resampler;
+  int16_t *sinc_table;  // coefficients for SNDMIXER_RESAMPLE_SINC
+  int underruns;        // last value returned by get_underruns
+  int stats;            // SNDMIXER_STATS_* entry the decoding time is counted in
 } sndmixer_channel_t;
 
 static sndmixer_channel_t *channel;
@@ -73,6 +106,29 @@ static int samplerate;
 static volatile uint32_t curr_id = 0;
 static QueueHandle_t cmd_queue;
 static int use_stereo = 0;
+static volatile uint32_t underruns;
+static volatile uint32_t sample_clock;  // frames mixed since init, at the start of the current block
+static volatile sndmixer_stats_t stats[SNDMIXER_STATS_COUNT];
+
+#ifdef CONFIG_DRIVER_SNDMIXER_MAX_EVENTS
+#define MAX_EVENTS CONFIG_DRIVER_SNDMIXER_MAX_EVENTS
+#else
+#define MAX_EVENTS 32
+#endif
+
+// Timed commands waiting for their time to come, ordered by time
+static sndmixer_cmd_t events[MAX_EVENTS];
+static int no_events;
+
+// Master bus processing
+static int eq_enabled;
+static int32_t eq_coef[5];
+static int32_t eq_state[2][4];
+#ifdef CONFIG_DRIVER_SNDMIXER_LIMITER
+static dsp_limiter_t limiter;
+#endif
+
+#define SAT(x, min, max) ((x > max) ? max : (x < min) ? min : x)
 
 // Grabs a new ID by atomically increasing curr_id and returning its value. This is called outside
 // of the audio playing thread, hence the atomicity.
@@ -93,8 +149,11 @@ static void clean_up_channel(int ch) {
     channel[ch].source = NULL;
   }
   free(channel[ch].buffer);
-  channel[ch].buffer = NULL;
-  channel[ch].flags  = 0;
+  free(channel[ch].sinc_table);
+  channel[ch].buffer     = NULL;
+  channel[ch].sinc_table = NULL;
+  channel[ch].flags      = 0;
+  channel[ch].underruns  = 0;
   printf("Sndmixer: %d: cleaning up done\n", channel[ch].id);
   channel[ch].id = 0;
 }
@@ -114,17 +173,47 @@ static int find_free_channel() {
   return -1;  // nothing found :/
 }
 
+#if defined(CONFIG_DRIVER_SNDMIXER_RESAMPLE_NEAREST)
+#define DEFAULT_RESAMPLER SNDMIXER_RESAMPLE_NEAREST
+#elif defined(CONFIG_DRIVER_SNDMIXER_RESAMPLE_SINC)
+#define DEFAULT_RESAMPLER SNDMIXER_RESAMPLE_SINC
+#else
+#define DEFAULT_RESAMPLER SNDMIXER_RESAMPLE_LINEAR
+#endif
+
+static void set_resampler(int ch, int resampler) {
+  if (resampler == SNDMIXER_RESAMPLE_SINC && !channel[ch].sinc_table) {
+    channel[ch].sinc_table = resample_sinc_table(channel[ch].dds_rate);
+    if (!channel[ch].sinc_table) {
+      printf("Sndmixer: %d: no memory for sinc resampler\n", channel[ch].id);
+      resampler = SNDMIXER_RESAMPLE_LINEAR;
+    }
+  }
+  channel[ch].resampler = resampler;
+}
+
+// Gain the channel should be played at, taking volume and pan into account. Pan is ignored when
+// the mixer runs in mono.
+static void channel_gain(sndmixer_channel_t *chan, int32_t gain[2]) {
+  int pan = use_stereo ? chan->pan : 0;
+  gain[0] = (chan->volume * (pan > 0 ? 256 - pan * 2 : 256)) >> 1;
+  gain[1] = (chan->volume * (pan < 0 ? 256 + pan * 2 : 256)) >> 1;
+}
+
 static int init_source(int ch, const sndmixer_source_t *srcfns, const void *data_start,
                        const void *data_end) {
-  int stereo = 0;
+  int stereo = use_stereo;
   int chunksz =
       srcfns->init_source(data_start, data_end, samplerate, &channel[ch].src_ctx, &stereo);
   if (chunksz <= 0)
     return 0;  // failed
   channel[ch].source = srcfns;
   channel[ch].volume = 128;
-  channel[ch].buffer =
-      malloc(chunksz * sizeof(channel[ch].buffer[0]) * ((stereo && use_stereo) ? 2 : 1));
+  channel[ch].pan    = 0;
+  channel_gain(&channel[ch], channel[ch].gain);
+  // The buffer starts with the last samples of the previous chunk, for the resampler.
+  channel[ch].buffer = calloc((RESAMPLE_HISTORY + chunksz) * ((stereo && use_stereo) ? 2 : 1),
+                              sizeof(channel[ch].buffer[0]));
   if (!channel[ch].buffer) {
     clean_up_channel(ch);
     return 0;
@@ -138,12 +227,31 @@ static int init_source(int ch, const sndmixer_source_t *srcfns, const void *data
     printf("Starting stereo channel\n");
     channel[ch].flags |= CHFL_STEREO;
   }
+  set_resampler(ch, DEFAULT_RESAMPLER);
   return 1;
 }
 
+// Statistics entry of the sounds queued with a command
+static int stats_type(sndmixer_cmd_ins_t cmd) {
+  switch (cmd) {
+    case CMD_QUEUE_MOD:
+      return SNDMIXER_STATS_MOD;
+    case CMD_QUEUE_MP3:
+    case CMD_QUEUE_MP3_STREAM:
+      return SNDMIXER_STATS_MP3;
+    case CMD_QUEUE_SYNTH:
+      return SNDMIXER_STATS_SYNTH;
+    case CMD_QUEUE_POLY:
+      return SNDMIXER_STATS_POLY;
+    default:
+      return SNDMIXER_STATS_WAV;
+  }
+}
+
 static void handle_cmd(sndmixer_cmd_t *cmd) {
   if (cmd->cmd == CMD_QUEUE_WAV || cmd->cmd == CMD_QUEUE_MOD || cmd->cmd == CMD_QUEUE_MP3 ||
-      cmd->cmd == CMD_QUEUE_MP3_STREAM || cmd->cmd == CMD_QUEUE_SYNTH) {
+      cmd->cmd == CMD_QUEUE_MP3_STREAM || cmd->cmd == CMD_QUEUE_SYNTH ||
+      cmd->cmd == CMD_QUEUE_POLY || cmd->cmd == CMD_QUEUE_WAV_STREAM) {
     int ch = find_free_channel();
     if (ch < 0)
       return;  // no free channels
@@ -151,6 +259,8 @@ static void handle_cmd(sndmixer_cmd_t *cmd) {
     printf("Sndmixer: %d: initing source\n", cmd->id);
     if (cmd->cmd == CMD_QUEUE_WAV) {
       r = init_source(ch, &sndmixer_source_wav, cmd->queue_file_start, cmd->queue_file_end);
+    } else if (cmd->cmd == CMD_QUEUE_WAV_STREAM) {
+      r = init_source(ch, &sndmixer_source_wav_stream, cmd->queue_file_start, cmd->queue_file_end);
     } else if (cmd->cmd == CMD_QUEUE_MOD) {
       r = init_source(ch, &sndmixer_source_mod, cmd->queue_file_start, cmd->queue_file_end);
     } else if (cmd->cmd == CMD_QUEUE_MP3) {
@@ -161,12 +271,15 @@ static void handle_cmd(sndmixer_cmd_t *cmd) {
     } else if (cmd->cmd == CMD_QUEUE_SYNTH) {
       printf("CMD==CMD_QUEUE_SYNTH\n");
       r = init_source(ch, &sndmixer_source_synth, 0, 0);
+    } else if (cmd->cmd == CMD_QUEUE_POLY) {
+      r = init_source(ch, &sndmixer_source_poly, 0, 0);
     }
     if (!r) {
       printf("Sndmixer: Failed to start decoder for id %d\n", cmd->id);
       return;  // fail
     }
-    channel[ch].id = cmd->id;  // success; set ID
+    channel[ch].id    = cmd->id;  // success; set ID
+    channel[ch].stats = stats_type(cmd->cmd);
     channel[ch].flags |= cmd->flags;
   } else if (cmd->cmd == CMD_PAUSE_ALL) {
     for (int x = 0; x < no_channels; x++)
@@ -174,6 +287,12 @@ static void handle_cmd(sndmixer_cmd_t *cmd) {
   } else if (cmd->cmd == CMD_RESUME_ALL) {
     for (int x = 0; x < no_channels; x++)
       channel[x].flags &= ~CHFL_PAUSED;
+  } else if (cmd->cmd == CMD_RESET_STATS) {
+    memset((void *)stats, 0, sizeof(stats));
+  } else if (cmd->cmd == CMD_EQ) {
+    eq_enabled = cmd->eq_enabled;
+    memcpy(eq_coef, cmd->eq_coef, sizeof(eq_coef));
+    memset(eq_state, 0, sizeof(eq_state));
   } else {
     // Rest are all commands that act on a certain ID. Look up if we have a channel with that ID
     // first.
@@ -191,8 +310,14 @@ static void handle_cmd(sndmixer_cmd_t *cmd) {
         channel[ch].flags |= CHFL_LOOP;
       else
         channel[ch].flags &= ~CHFL_LOOP;
-    } else if (cmd->cmd == CMD_VOLUME) {
-      channel[ch].volume = cmd->param;
+    } else if (cmd->cmd == CMD_VOLUME || cmd->cmd == CMD_PAN) {
+      if (cmd->cmd == CMD_VOLUME)
+        channel[ch].volume = SAT(cmd->param, 0, 256);
+      else
+        channel[ch].pan = SAT(cmd->param, -128, 128);
+      // Playing channels ramp to the new gain over the next block, paused ones can jump there.
+      if (channel[ch].flags & CHFL_PAUSED)
+        channel_gain(&channel[ch], channel[ch].gain);
     } else if (cmd->cmd == CMD_PLAY) {
       channel[ch].flags &= ~CHFL_PAUSED;
     } else if (cmd->cmd == CMD_PAUSE) {
@@ -206,83 +331,229 @@ static void handle_cmd(sndmixer_cmd_t *cmd) {
       } else {
         printf("Not a synth!\n");
       }
+    } else if (cmd->cmd == CMD_RESAMPLER) {
+      set_resampler(ch, cmd->param);
     } else if (cmd->cmd == CMD_WAVEFORM) {
       if (channel[ch].source->set_waveform) {
         channel[ch].source->set_waveform(channel[ch].src_ctx, cmd->param);
       } else {
         printf("Not a synth!\n");
       }
+    } else if (cmd->cmd == CMD_NOTE_ON || cmd->cmd == CMD_NOTE_OFF || cmd->cmd == CMD_ENVELOPE) {
+      const sndmixer_source_t *source = channel[ch].source;
+      if (!source->note_on) {
+        printf("Not a polyphonic synth!\n");
+      } else if (cmd->cmd == CMD_NOTE_ON) {
+        source->note_on(channel[ch].src_ctx, cmd->note, cmd->velocity);
+      } else if (cmd->cmd == CMD_NOTE_OFF) {
+        source->note_off(channel[ch].src_ctx, cmd->note);
+      } else {
+        source->set_envelope(channel[ch].src_ctx, cmd->envelope[0], cmd->envelope[1],
+                             cmd->envelope[2], cmd->envelope[3]);
+      }
+    }
+  }
+}
+
+// Inserts a timed command into the event list, after any events with the same time so commands
+// keep the order they were sent in.
+static void schedule_cmd(sndmixer_cmd_t *cmd) {
+  int pos = no_events;
+  while (pos > 0 && (int32_t)(events[pos - 1].at - cmd->at) > 0) {
+    events[pos] = events[pos - 1];
+    pos--;
+  }
+  events[pos] = *cmd;
+  no_events++;
+}
+
+// Applies the first event and removes it from the list.
+static void pop_event() {
+  sndmixer_cmd_t cmd = events[0];
+  no_events--;
+  memmove(&events[0], &events[1], no_events * sizeof(events[0]));
+  handle_cmd(&cmd);
+}
+
+// The mix bus holds the sum of all channels for one block, each sample multiplied by the channel
+// volume. It is always kept in stereo when stereo output is used, in mono otherwise.
+static int32_t *mixbus;
+static uint16_t *outbuf;  // one block in the I2S DMA format
+static int32_t *chanbuf;  // one block of a single channel, after resampling
+
+// Gets the next chunk from the source, keeping the end of the current one in front of it.
+static int refill_channel(sndmixer_channel_t *chan) {
+  int frames = (chan->flags & CHFL_STEREO) ? 2 : 1;
+  memmove(chan->buffer, chan->buffer + chan->chunksz * frames,
+          RESAMPLE_HISTORY * frames * sizeof(chan->buffer[0]));
+  int64_t start = esp_timer_get_time();
+  int r = chan->source->fill_buffer(chan->src_ctx, chan->buffer + RESAMPLE_HISTORY * frames,
+                                    use_stereo);
+  stats[chan->stats].frames += r;
+  stats[chan->stats].time_us += esp_timer_get_time() - start;
+  if (r == 0)
+    return 0;
+  chan->dds_acc -= (chan->chunksz << 16);  // we have parsed chunksize samples.
+  chan->chunksz = r;                       // save new chunksize
+  return 1;
+}
+
+// Resamples len frames of a channel and adds them to the mix bus, starting at frame bus. Returns 0
+// when the source ended.
+static int mix_channel(sndmixer_channel_t *chan, int32_t *bus, int len) {
+  int stereo   = (chan->flags & CHFL_STEREO) ? 1 : 0;
+  int32_t *out = chanbuf;
+  int left     = len;
+  while (left > 0) {
+    // The next sample is outside the channels chunk buffer. Refill that first.
+    while (((chan->dds_acc + chan->dds_rate) >> 16) >= chan->chunksz) {
+      if (!refill_channel(chan))
+        return 0;
     }
+
+    // Amount of samples that can be taken from the buffer before it needs refilling again
+    int n = left;
+    if (chan->dds_rate) {
+      uint32_t avail = (((uint32_t)chan->chunksz << 16) - 1 - chan->dds_acc) / chan->dds_rate;
+      if (avail < n)
+        n = avail;
+    }
+
+    const int16_t *buffer = chan->buffer + RESAMPLE_HISTORY * (stereo + 1);
+    if (chan->resampler == SNDMIXER_RESAMPLE_SINC) {
+      resample_sinc(chan->sinc_table, buffer, stereo, &chan->dds_acc, chan->dds_rate, out, n);
+    } else if (chan->resampler == SNDMIXER_RESAMPLE_LINEAR) {
+      resample_linear(buffer, stereo, &chan->dds_acc, chan->dds_rate, out, n);
+    } else {
+      resample_nearest(buffer, stereo, &chan->dds_acc, chan->dds_rate, out, n);
+    }
+    out += n * (stereo + 1);
+    left -= n;
   }
+
+  // Multiply by the gain and add to the mix bus. Changes in volume or pan are spread out over the
+  // frames, to avoid clicks.
+  int32_t target[2];
+  channel_gain(chan, target);
+  int32_t gl = chan->gain[0];
+  int32_t gr = chan->gain[1];
+  int32_t dl = (target[0] - gl) / len;
+  int32_t dr = (target[1] - gr) / len;
+  if (stereo) {
+    for (int i = 0; i < len; i++) {
+      gl += dl;
+      gr += dr;
+      bus[i * 2 + 0] += (chanbuf[i * 2 + 0] * gl) >> 7;
+      bus[i * 2 + 1] += (chanbuf[i * 2 + 1] * gr) >> 7;
+    }
+  } else if (use_stereo) {
+    for (int i = 0; i < len; i++) {
+      gl += dl;
+      gr += dr;
+      bus[i * 2 + 0] += (chanbuf[i] * gl) >> 7;
+      bus[i * 2 + 1] += (chanbuf[i] * gr) >> 7;
+    }
+  } else {
+    for (int i = 0; i < len; i++) {
+      gl += dl;
+      bus[i] += (chanbuf[i] * gl) >> 7;
+    }
+  }
+  chan->gain[0] = target[0];
+  chan->gain[1] = target[1];
+  return 1;
 }
 
-#define CHUNK_SIZE 32
+// Mixes frames start up to end of the current block of every active channel.
+static void mix_channels(int start, int end) {
+  if (start == end)
+    return;
+  int32_t *bus = mixbus + start * (use_stereo ? 2 : 1);
+  for (int ch = 0; ch < no_channels; ch++) {
+    sndmixer_channel_t *chan = &channel[ch];
+    if (chan->source && !(chan->flags & CHFL_PAUSED)) {
+      if (!mix_channel(chan, bus, end - start)) {
+        // Source is done.
+        printf("Sndmixer: %d: cleaning up source because of EOF\n", chan->id);
+        clean_up_channel(ch);
+      } else if (chan->source->get_underruns) {
+        int r = chan->source->get_underruns(chan->src_ctx);
+        underruns += r - chan->underruns;
+        chan->underruns = r;
+      }
+    }
+  }
+}
 
 // Sound mixer main loop.
 static void sndmixer_task(void *arg) {
-  int16_t mixbuf[CHUNK_SIZE * (use_stereo ? 2 : 1)];
+  int bus_len = SNDMIXER_BLOCK_SIZE * (use_stereo ? 2 : 1);
   printf("Sndmixer task up.\n");
   while (1) {
-    // Handle any commands that are sent to us.
+    // Handle any commands that are sent to us. Timed ones wait in the event list. When that is full,
+    // commands are left in the queue until there is room again.
     sndmixer_cmd_t cmd;
-    while (xQueueReceive(cmd_queue, &cmd, 0) == pdTRUE) {
-      handle_cmd(&cmd);
+    while (no_events < MAX_EVENTS && xQueueReceive(cmd_queue, &cmd, 0) == pdTRUE) {
+      if (cmd.timed)
+        schedule_cmd(&cmd);
+      else
+        handle_cmd(&cmd);
     }
 
-    // Assemble CHUNK_SIZE worth of samples and dump it into the I2S subsystem.
-    for (int i = 0; i < CHUNK_SIZE; i++) {
-      // current sample value, multiplied by 256 (because of multiplies by channel volume)
-      int32_t s[2] = {0, 0};
-      for (int ch = 0; ch < no_channels; ch++) {
-        sndmixer_channel_t *chan = &channel[ch];
-        if (chan->source  && !(chan->flags & CHFL_PAUSED)) {
-          // Channel is active.
-          chan->dds_acc += chan->dds_rate;  // select next sample
-          // dds_acc>>16 now gives us which sample to get from the buffer.
-          while ((chan->dds_acc >> 16) >= chan->chunksz && chan->source) {
-            // That value is outside the channels chunk buffer. Refill that first.
-            int r = chan->source->fill_buffer(chan->src_ctx, chan->buffer, use_stereo);
-            if (r == 0) {
-              // Source is done.
-              printf("Sndmixer: %d: cleaning up source because of EOF\n", chan->id);
-              clean_up_channel(ch);
-              continue;
-            }
-            chan->dds_acc -=
-                (chan->chunksz << 16);  // reset dds acc; we have parsed chunksize samples.
-            chan->chunksz = r;          // save new chunksize
-          }
-          if (!chan->source) {
-            continue;
-          }
-          // Multiply by volume, add to cumulative sample. Limit volume to 1/2 maximum.
-          uint32_t acc = chan->dds_acc >> 16;
-          if (chan->flags & CHFL_STEREO) {
-            s[0] += (int32_t)(chan->buffer[acc * 2 + 0]) * chan->volume / 2;
-            s[1] += (int32_t)(chan->buffer[acc * 2 + 1]) * chan->volume / 2;
-          } else {
-            s[0] += (int32_t)(chan->buffer[acc]) * chan->volume / 2;
-            s[1] += (int32_t)(chan->buffer[acc]) * chan->volume / 2;
-          }
-        }
+    // Mix a block of samples of every active channel and dump it into the I2S subsystem. The block
+    // is split at events that are due in it, so they take effect at the exact frame. Events that
+    // are late are applied at the start of the block.
+    int64_t start = esp_timer_get_time();
+    memset(mixbus, 0, bus_len * sizeof(mixbus[0]));
+    uint32_t now = sample_clock;
+    int pos      = 0;
+    while (no_events > 0 && (int32_t)(events[0].at - now) < SNDMIXER_BLOCK_SIZE) {
+      int32_t at = events[0].at - now;
+      if (at > pos) {
+        mix_channels(pos, at);
+        pos = at;
       }
-      // Correct for the number of channels and the multiplication by the volume
-      s[0] /= no_channels * 256;
-      s[1] /= no_channels * 256;
-
-      // Saturate
-#define SAT(x, min, max) ((x > max) ? max : (x < min) ? min : x)
-      s[0] = SAT(s[0], INT16_MIN, INT16_MAX);
-      s[1] = SAT(s[1], INT16_MIN, INT16_MAX);
+      pop_event();
+    }
+    mix_channels(pos, SNDMIXER_BLOCK_SIZE);
+    sample_clock = now + SNDMIXER_BLOCK_SIZE;
+
+    // Correct for the number of channels and the multiplication by the volume, and apply the master
+    // volume. Limit volume to 1/2 maximum.
+    int64_t gain = ((int64_t)driver_i2s_get_volume() << 8) / no_channels;
+    for (int i = 0; i < bus_len; i++) {
+      mixbus[i] = (mixbus[i] * gain) >> 32;
+    }
+    if (eq_enabled) {
+      dsp_biquad(eq_coef, eq_state[0], mixbus, SNDMIXER_BLOCK_SIZE, use_stereo ? 2 : 1);
+      if (use_stereo)
+        dsp_biquad(eq_coef, eq_state[1], mixbus + 1, SNDMIXER_BLOCK_SIZE, 2);
+    }
+    int16_t *out = (int16_t *)outbuf;
+#ifdef CONFIG_DRIVER_SNDMIXER_LIMITER
+    dsp_limiter(&limiter, mixbus, out, SNDMIXER_BLOCK_SIZE, use_stereo);
+#else
+    for (int i = 0; i < bus_len; i++) {
+      out[i] = SAT(mixbus[i], INT16_MIN, INT16_MAX);
+    }
+#endif
 
-      if (use_stereo) {
-        mixbuf[i * 2 + 0] = s[0];
-        mixbuf[i * 2 + 1] = s[1];
-      } else {
-        mixbuf[i] = (s[0] + s[1]) / 2;
+    // The DMA always takes two samples per frame. Expand mono from the end, so that no sample is
+    // overwritten before it has been copied.
+    if (use_stereo) {
+      for (int i = 0; i < SNDMIXER_BLOCK_SIZE * 2; i++) {
+        outbuf[i] += DRIVER_I2S_SAMPLE_OFFSET;
+      }
+    } else {
+      for (int i = SNDMIXER_BLOCK_SIZE - 1; i >= 0; i--) {
+        uint16_t s        = outbuf[i] + DRIVER_I2S_SAMPLE_OFFSET;
+        outbuf[i * 2 + 0] = s;
+        outbuf[i * 2 + 1] = s;
       }
     }
-    driver_i2s_sound_push(mixbuf, CHUNK_SIZE, use_stereo);
+    stats[SNDMIXER_STATS_MIXER].frames += SNDMIXER_BLOCK_SIZE;
+    stats[SNDMIXER_STATS_MIXER].time_us += esp_timer_get_time() - start;
+    driver_i2s_sound_write(outbuf, SNDMIXER_BLOCK_SIZE);
   }
   // ToDo: de-init channels/buffers/... if we ever implement a deinit cmd
   vTaskDelete(NULL);
@@ -290,6 +561,9 @@ static void sndmixer_task(void *arg) {
 
 // Run on core 1 if enabled, core 0 if not.
 #define MY_CORE (portNUM_PROCESSORS - 1)
+// Besides mixing, the task reads streamed sounds through the MicroPython VFS, sets up sinc tables
+// and prints, so it gets the stack size of the other drivers' tasks.
+#define MY_STACK_SIZE 4096
 
 int sndmixer_init(int p_no_channels, int stereo) {
   no_channels = p_no_channels;
@@ -299,14 +573,33 @@ int sndmixer_init(int p_no_channels, int stereo) {
   use_stereo = stereo;
   if (!channel)
     return 0;
+#ifdef CONFIG_DRIVER_SNDMIXER_LIMITER
+  dsp_limiter_init(&limiter);
+#endif
+  mixbus  = malloc(SNDMIXER_BLOCK_SIZE * 2 * sizeof(mixbus[0]));
+  outbuf  = malloc(SNDMIXER_BLOCK_SIZE * 2 * sizeof(outbuf[0]));
+  chanbuf = malloc(SNDMIXER_BLOCK_SIZE * 2 * sizeof(chanbuf[0]));
+  if (!mixbus || !outbuf || !chanbuf) {
+    free(mixbus);
+    free(outbuf);
+    free(chanbuf);
+    free(channel);
+    return 0;
+  }
   curr_id   = 0;
   cmd_queue = xQueueCreate(10, sizeof(sndmixer_cmd_t));
   if (cmd_queue == NULL) {
+    free(mixbus);
+    free(outbuf);
+    free(chanbuf);
     free(channel);
     return 0;
   }
-  int r = xTaskCreatePinnedToCore(&sndmixer_task, "sndmixer", 2048, NULL, 5, NULL, MY_CORE);
+  int r = xTaskCreatePinnedToCore(&sndmixer_task, "sndmixer", MY_STACK_SIZE, NULL, 5, NULL, MY_CORE);
   if (!r) {
+    free(mixbus);
+    free(outbuf);
+    free(chanbuf);
     free(channel);
     vQueueDelete(cmd_queue);
     return 0;
@@ -328,6 +621,17 @@ int sndmixer_queue_wav(const void *wav_start, const void *wav_end, int evictable
   return id;
 }
 
+int sndmixer_queue_wav_stream(stream_read_type read_func, void *stream, int evictable) {
+  int id             = new_id();
+  sndmixer_cmd_t cmd = {.id               = id,
+                        .cmd              = CMD_QUEUE_WAV_STREAM,
+                        .queue_file_start = (void *)read_func,
+                        .queue_file_end   = stream,
+                        .flags            = CHFL_PAUSED | (evictable ? CHFL_EVICTABLE : 0)};
+  xQueueSend(cmd_queue, &cmd, portMAX_DELAY);
+  return id;
+}
+
 int sndmixer_queue_mod(const void *mod_start, const void *mod_end) {
   int id             = new_id();
   sndmixer_cmd_t cmd = {.id               = id,
@@ -404,6 +708,26 @@ void sndmixer_stop(int id) {
   xQueueSend(cmd_queue, &cmd, portMAX_DELAY);
 }
 
+void sndmixer_play_at(int id, uint32_t time) {
+  sndmixer_cmd_t cmd = {.cmd = CMD_PLAY, .id = id, .timed = 1, .at = time};
+  xQueueSend(cmd_queue, &cmd, portMAX_DELAY);
+}
+
+void sndmixer_pause_at(int id, uint32_t time) {
+  sndmixer_cmd_t cmd = {.cmd = CMD_PAUSE, .id = id, .timed = 1, .at = time};
+  xQueueSend(cmd_queue, &cmd, portMAX_DELAY);
+}
+
+void sndmixer_stop_at(int id, uint32_t time) {
+  sndmixer_cmd_t cmd = {.cmd = CMD_STOP, .id = id, .timed = 1, .at = time};
+  xQueueSend(cmd_queue, &cmd, portMAX_DELAY);
+}
+
+void sndmixer_set_volume_at(int id, int volume, uint32_t time) {
+  sndmixer_cmd_t cmd = {.cmd = CMD_VOLUME, .id = id, .param = volume, .timed = 1, .at = time};
+  xQueueSend(cmd_queue, &cmd, portMAX_DELAY);
+}
+
 void sndmixer_pause_all() {
   sndmixer_cmd_t cmd = {
       .cmd = CMD_PAUSE_ALL,
@@ -428,4 +752,64 @@ void sndmixer_waveform(int id, uint8_t waveform) {
   xQueueSend(cmd_queue, &cmd, portMAX_DELAY);
 }
 
+int sndmixer_queue_poly() {
+  int id             = new_id();
+  sndmixer_cmd_t cmd = {.id = id, .cmd = CMD_QUEUE_POLY, .flags = CHFL_PAUSED};
+  xQueueSend(cmd_queue, &cmd, portMAX_DELAY);
+  return id;
+}
+
+void sndmixer_note_on(int id, int note, int velocity) {
+  sndmixer_cmd_t cmd = {.cmd = CMD_NOTE_ON, .id = id, .note = note, .velocity = velocity};
+  xQueueSend(cmd_queue, &cmd, portMAX_DELAY);
+}
+
+void sndmixer_note_off(int id, int note) {
+  sndmixer_cmd_t cmd = {.cmd = CMD_NOTE_OFF, .id = id, .note = note};
+  xQueueSend(cmd_queue, &cmd, portMAX_DELAY);
+}
+
+void sndmixer_set_envelope(int id, int attack, int decay, int sustain, int release) {
+  sndmixer_cmd_t cmd = {
+      .cmd = CMD_ENVELOPE, .id = id, .envelope = {attack, decay, sustain, release}};
+  xQueueSend(cmd_queue, &cmd, portMAX_DELAY);
+}
+
+void sndmixer_set_pan(int id, int pan) {
+  sndmixer_cmd_t cmd = {.cmd = CMD_PAN, .id = id, .param = pan};
+  xQueueSend(cmd_queue, &cmd, portMAX_DELAY);
+}
+
+void sndmixer_set_eq(sndmixer_eq_t type, float frequency, float q, float gain_db) {
+  sndmixer_cmd_t cmd = {.cmd = CMD_EQ};
+  cmd.eq_enabled     = dsp_biquad_design(cmd.eq_coef, type, frequency, q, gain_db, samplerate);
+  xQueueSend(cmd_queue, &cmd, portMAX_DELAY);
+}
+
+uint32_t sndmixer_get_clock() {
+  return sample_clock;
+}
+
+int sndmixer_get_samplerate() {
+  return samplerate;
+}
+
+uint32_t sndmixer_get_underruns() {
+  return underruns;
+}
+
+void sndmixer_get_stats(sndmixer_stats_t *result) {
+  memcpy(result, (void *)stats, sizeof(stats));
+}
+
+void sndmixer_reset_stats() {
+  sndmixer_cmd_t cmd = {.cmd = CMD_RESET_STATS};
+  xQueueSend(cmd_queue, &cmd, portMAX_DELAY);
+}
+
+void sndmixer_set_resampler(int id, sndmixer_resampler_t resampler) {
+  sndmixer_cmd_t cmd = {.cmd = CMD_RESAMPLER, .id = id, .param = resampler};
+  xQueueSend(cmd_queue, &cmd, portMAX_DELAY);
+}
+
 #endif
@@ -1,6 +1,13 @@
 #pragma once
+#include <sdkconfig.h>
 #include <stdint.h>
 
+#ifdef CONFIG_DRIVER_SNDMIXER_BLOCK_SIZE
+#define SNDMIXER_BLOCK_SIZE CONFIG_DRIVER_SNDMIXER_BLOCK_SIZE
+#else
+#define SNDMIXER_BLOCK_SIZE 128
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -9,7 +16,8 @@ extern "C" {
  * @brief Structure describing a sound source
  */
 typedef struct {
-  /*! Initialize the sound source. Returns size of data returned per call of fill_buffer. */
+  /*! Initialize the sound source. Returns size of data returned per call of fill_buffer. On entry
+   * stereo tells whether the mixer plays stereo; the source sets it to whether it produces stereo. */
   int (*init_source)(const void *data_start, const void *data_end, int req_sample_rate, void **ctx,
                      int *stereo);
   /*! Get the actual sample rate at which the source returns data */
@@ -23,8 +31,43 @@ typedef struct {
   void (*set_frequency)(void *ctx, uint16_t frequency);
   /*! Set waveform of synthesizer */
   void (*set_waveform)(void *ctx, uint8_t waveform);
+  /*! Optional: amount of times the source had no data ready and returned silence */
+  int (*get_underruns)(void *ctx);
+  /*! Start a note on a polyphonic synthesizer. Note and velocity as in MIDI. */
+  void (*note_on)(void *ctx, uint8_t note, uint8_t velocity);
+  /*! Release a note on a polyphonic synthesizer */
+  void (*note_off)(void *ctx, uint8_t note);
+  /*! Set the envelope of a polyphonic synthesizer */
+  void (*set_envelope)(void *ctx, int attack, int decay, int sustain, int release);
 } sndmixer_source_t;
 
+/**
+ * @brief Ways of converting the sample rate of a sound to the output sample rate
+ */
+typedef enum {
+  /*! Take the nearest sample. Cheapest, but adds audible aliasing. */
+  SNDMIXER_RESAMPLE_NEAREST = 0,
+  /*! Interpolate linearly between two samples */
+  SNDMIXER_RESAMPLE_LINEAR,
+  /*! Windowed sinc filter. Best quality, takes the most processing time. */
+  SNDMIXER_RESAMPLE_SINC
+} sndmixer_resampler_t;
+
+/**
+ * @brief Filter types for the master equalizer
+ */
+typedef enum {
+  SNDMIXER_EQ_OFF = 0,
+  SNDMIXER_EQ_LOWPASS,
+  SNDMIXER_EQ_HIGHPASS,
+  /*! Boost or cut around a frequency */
+  SNDMIXER_EQ_PEAK,
+  /*! Boost or cut below a frequency */
+  SNDMIXER_EQ_LOWSHELF,
+  /*! Boost or cut above a frequency */
+  SNDMIXER_EQ_HIGHSHELF
+} sndmixer_eq_t;
+
 /**
  * @brief Initialize the sound mixer
  *
@@ -75,6 +118,21 @@ int sndmixer_queue_mp3(const void *mp3_start, const void *mp3_end);
 typedef ssize_t (*stream_read_type)(void *, void *, size_t);
 int sndmixer_queue_mp3_stream(stream_read_type read_func, void *stream);
 
+/**
+ * @brief Queue a .wav file to be played while it is read from a stream
+ *
+ * Like sndmixer_queue_wav, but the file is read in pieces of about half of
+ * CONFIG_DRIVER_SNDMIXER_WAV_STREAM_BUFFER bytes while it plays, instead of being kept in memory
+ * as a whole. Supports 8- and 16-bit PCM and IMA ADPCM, which takes a quarter of the space of
+ * 16-bit PCM. The stream must stay open until the sound is stopped or has ended.
+ *
+ * @param read_func Function that reads from the stream, returns the amount of bytes read
+ * @param stream Passed to read_func
+ * @param evictable If true, this sound can be stopped to make room for a new sound.
+ * @return The ID of the queued sound, for use with the other functions.
+ */
+int sndmixer_queue_wav_stream(stream_read_type read_func, void *stream, int evictable);
+
 /**
  * @brief Set or unset a sound to looping mode
  *
@@ -88,14 +146,50 @@ void sndmixer_set_loop(int id, int loop);
 /**
  * @brief Set volume of a sound
  *
- * A queued sound will always start off with a volume setting of 255 (max volume). This call can be
- * used to adjust the volume of the sound at any time afterwards.
+ * A queued sound will always start off with a volume setting of 128 (half volume). This call can be
+ * used to adjust the volume of the sound at any time afterwards. Changes of a playing sound take
+ * effect gradually over one mixer block, to avoid clicks.
  *
  * @param id ID of the sound, obtained when queueing it
- * @param volume New volume, between 0 (muted) and 255 (full sound).
+ * @param volume New volume, between 0 (muted) and 256 (full sound).
  */
 void sndmixer_set_volume(int id, int volume);
 
+/**
+ * @brief Set the stereo position of a sound
+ *
+ * Like volume changes, this takes effect gradually over one mixer block. Has no effect when the
+ * mixer was started in mono.
+ *
+ * @param id ID of the sound, obtained when queueing it
+ * @param pan Between -128 (left only) and 128 (right only), 0 is centered.
+ */
+void sndmixer_set_pan(int id, int pan);
+
+/**
+ * @brief Set the equalizer on the master output
+ *
+ * A single biquad filter on the mixed output, e.g. a highpass around 200 Hz to keep small speakers
+ * from distorting on bass they can not reproduce anyway.
+ *
+ * @param type Filter type, SNDMIXER_EQ_OFF to disable the equalizer
+ * @param frequency Corner or center frequency in Hz
+ * @param q Quality factor; 0.707 for a flat lowpass or highpass
+ * @param gain_db Boost (positive) or cut (negative) for the peak and shelf filters
+ */
+void sndmixer_set_eq(sndmixer_eq_t type, float frequency, float q, float gain_db);
+
+/**
+ * @brief Set the resampler of a sound
+ *
+ * Sounds start off with the resampler selected in the configuration. This can be changed at any
+ * time, e.g. to use a cheaper resampler for sound effects than for music.
+ *
+ * @param id ID of the sound, obtained when queueing it
+ * @param resampler The resampler to use
+ */
+void sndmixer_set_resampler(int id, sndmixer_resampler_t resampler);
+
 /**
  * @brief Play a sound
  *
@@ -124,6 +218,48 @@ void sndmixer_pause(int id);
  */
 void sndmixer_stop(int id);
 
+/**
+ * @brief Get the mixer sample clock
+ *
+ * The clock counts the frames the mixer has produced since sndmixer_init, and wraps around after
+ * 2^32 frames. It runs ahead of what is audible by the amount of audio buffered in the I2S driver.
+ *
+ * @return Current sample clock time, at the start of the block the mixer is working on
+ */
+uint32_t sndmixer_get_clock();
+
+/**
+ * @brief Get the output sample rate
+ *
+ * @return Frames per second, i.e. the rate the sample clock runs at
+ */
+int sndmixer_get_samplerate();
+
+/**
+ * @brief Play, pause or stop a sound at a given time
+ *
+ * Like sndmixer_play, sndmixer_pause and sndmixer_stop, but the command takes effect exactly at
+ * the given frame of the sample clock. Times that have already passed are applied right away.
+ * Commands with the same time are applied in the order they were sent.
+ *
+ * @param id ID of the sound, obtained when queueing it
+ * @param time Sample clock time, see sndmixer_get_clock
+ */
+void sndmixer_play_at(int id, uint32_t time);
+void sndmixer_pause_at(int id, uint32_t time);
+void sndmixer_stop_at(int id, uint32_t time);
+
+/**
+ * @brief Set the volume of a sound at a given time
+ *
+ * Like sndmixer_set_volume, but the change starts at the given frame of the sample clock.
+ *
+ * @param id ID of the sound, obtained when queueing it
+ * @param volume New volume, between 0 (muted) and 256 (full sound).
+ * @param time Sample clock time, see sndmixer_get_clock
+ */
+void sndmixer_set_volume_at(int id, int volume, uint32_t time);
+
 /**
  * @brief Pause all playing sounds
  *
@@ -139,11 +275,98 @@ void sndmixer_pause_all();
  */
 void sndmixer_resume_all();
 
+/**
+ * @brief Get the amount of buffer underruns
+ *
+ * Sources that decode ahead in a separate task return silence when the decoder does not keep up,
+ * instead of holding up the mixer. This returns how often that happened since sndmixer_init.
+ */
+uint32_t sndmixer_get_underruns();
+
+/**
+ * @brief Kinds of work the mixer keeps processing time statistics for
+ */
+typedef enum {
+  SNDMIXER_STATS_WAV = 0,
+  SNDMIXER_STATS_MOD,
+  /*! With CONFIG_DRIVER_SNDMIXER_MP3_DECODE_AHEAD, this only counts taking decoded frames */
+  SNDMIXER_STATS_MP3,
+  SNDMIXER_STATS_SYNTH,
+  SNDMIXER_STATS_POLY,
+  /*! Everything the mixer task does per block, decoding included, apart from waiting for I2S */
+  SNDMIXER_STATS_MIXER,
+  SNDMIXER_STATS_COUNT
+} sndmixer_stats_type_t;
+
+typedef struct {
+  uint32_t frames;   // frames produced
+  uint32_t time_us;  // time it took, wraps around after 71 minutes
+} sndmixer_stats_t;
+
+/**
+ * @brief Get processing time statistics
+ *
+ * Frames and time are counted for all sounds of a kind together, since sndmixer_init or the last
+ * sndmixer_reset_stats. Frames per second of processing time, compared to the sample rate of the
+ * sounds, shows how much faster than real time they are decoded. For the mixer entry, time
+ * divided by frames and multiplied by the output sample rate gives the CPU load.
+ *
+ * @param stats Receives SNDMIXER_STATS_COUNT entries, indexed by sndmixer_stats_type_t
+ */
+void sndmixer_get_stats(sndmixer_stats_t *stats);
+
+/**
+ * @brief Restart counting the processing time statistics
+ */
+void sndmixer_reset_stats();
+
 // Basic synthesizer
 int sndmixer_queue_synth();
 void sndmixer_freq(int id, uint16_t frequency);
 void sndmixer_waveform(int id, uint8_t waveform);
 
+/**
+ * @brief Queue a polyphonic synthesizer
+ *
+ * The synthesizer plays up to CONFIG_DRIVER_SNDMIXER_SYNTH_VOICES notes at the same time on one
+ * mixer channel. It is silent until notes are started with sndmixer_note_on. The waveform is set
+ * with sndmixer_waveform and uses the same numbers as the basic synthesizer.
+ *
+ * @return The ID of the queued sound, for use with the other functions.
+ */
+int sndmixer_queue_poly();
+
+/**
+ * @brief Start a note on a polyphonic synthesizer
+ *
+ * When all voices are in use, a voice is taken over: the quietest voice that is releasing, or if
+ * there is none, the voice that was started first. A note that is already playing is restarted.
+ *
+ * @param id ID of the synthesizer, obtained when queueing it
+ * @param note MIDI note number, 0-127; 69 is A4 at 440 Hz
+ * @param velocity 1-127; 0 releases the note, as in MIDI
+ */
+void sndmixer_note_on(int id, int note, int velocity);
+
+/**
+ * @brief Release a note on a polyphonic synthesizer
+ *
+ * @param id ID of the synthesizer, obtained when queueing it
+ * @param note MIDI note number, 0-127
+ */
+void sndmixer_note_off(int id, int note);
+
+/**
+ * @brief Set the envelope of new and releasing notes of a polyphonic synthesizer
+ *
+ * @param id ID of the synthesizer, obtained when queueing it
+ * @param attack Time to full volume in ms
+ * @param decay Time from full volume to the sustain level in ms
+ * @param sustain Level while the note is held, 0-127
+ * @param release Time from full volume to silence after the note is released, in ms
+ */
+void sndmixer_set_envelope(int id, int attack, int decay, int sustain, int release);
+
 #ifdef __cplusplus
 }
 #endif
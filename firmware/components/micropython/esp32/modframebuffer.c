@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
+#include <sys/stat.h>
 
 #include "py/mperrno.h"
 #include "py/mphal.h"
@@ -12,6 +13,7 @@
 #include <driver_framebuffer.h>
 #include <driver_framebuffer_compositor.h>
 #include <driver_framebuffer_devices.h>
+#include <crc32.h>
 
 #ifdef CONFIG_DRIVER_FRAMEBUFFER_ENABLE
 
@@ -584,13 +586,15 @@ static mp_obj_t framebuffer_draw_png(mp_uint_t n_args, const mp_obj_t *args)
 	if (is_bytes) {
 		mp_uint_t len;
 		uint8_t *data = (uint8_t *)mp_obj_str_get_data(args[paramOffset], &len);
+		uint32_t stamp = lib_crc32(data, len, LIB_CRC32_INIT); //Data is identified by its contents
+		if (driver_framebuffer_png_cache_draw(window, x, y, NULL, len, stamp)) return mp_const_none;
 		struct lib_mem_reader *mr = lib_mem_new(data, len);
 		if (mr == NULL) {
 			mp_raise_ValueError("Out of memory");
 			return mp_const_none;
 		}
 		reader = (lib_reader_read_t) &lib_mem_read;
-		renderRes = driver_framebuffer_png(NULL, x, y, reader, mr);
+		renderRes = driver_framebuffer_png_cache_load(window, x, y, NULL, len, stamp, reader, mr);
 		lib_mem_destroy(mr);
 	} else {
 		const char* filename = mp_obj_str_get_str(args[paramOffset]);
@@ -600,13 +604,20 @@ static mp_obj_t framebuffer_draw_png(mp_uint_t n_args, const mp_obj_t *args)
 			mp_raise_ValueError("File not found");
 			return mp_const_none;
 		}
+		struct stat sb;
+		bool haveStat = (stat(fullname, &sb) == 0); //Files are identified by path, size and modification time
+		if (haveStat && driver_framebuffer_png_cache_draw(window, x, y, fullname, sb.st_size, sb.st_mtime)) return mp_const_none;
 		struct lib_file_reader *fr = lib_file_new(fullname, 1024);
 		if (fr == NULL) {
 			nlr_raise(mp_obj_new_exception_msg_varg(&mp_type_ValueError, "Could not open file '%s'!",filename));
 			return mp_const_none;
 		}
 		reader = (lib_reader_read_t) &lib_file_read;
-		renderRes = driver_framebuffer_png(window, x, y, reader, fr);
+		if (haveStat) {
+			renderRes = driver_framebuffer_png_cache_load(window, x, y, fullname, sb.st_size, sb.st_mtime, reader, fr);
+		} else {
+			renderRes = driver_framebuffer_png(window, x, y, reader, fr);
+		}
 		lib_file_destroy(fr);
 	}
 	
@@ -617,6 +628,25 @@ static mp_obj_t framebuffer_draw_png(mp_uint_t n_args, const mp_obj_t *args)
 	return mp_const_none;
 }
 
+static mp_obj_t framebuffer_png_cache_stats(mp_uint_t n_args, const mp_obj_t *args)
+{
+	PngCacheStats stats;
+	driver_framebuffer_png_cache_stats(&stats);
+	mp_obj_t tuple[5];
+	tuple[0] = mp_obj_new_int(stats.hits);
+	tuple[1] = mp_obj_new_int(stats.misses);
+	tuple[2] = mp_obj_new_int(stats.entries);
+	tuple[3] = mp_obj_new_int(stats.used);
+	tuple[4] = mp_obj_new_int(stats.size);
+	return mp_obj_new_tuple(5, tuple);
+}
+
+static mp_obj_t framebuffer_png_cache_clear(mp_uint_t n_args, const mp_obj_t *args)
+{
+	driver_framebuffer_png_cache_clear();
+	return mp_const_none;
+}
+
 static mp_obj_t framebuffer_backlight(mp_uint_t n_args, const mp_obj_t *args)
 {
 	if (n_args > 0) {
@@ -712,6 +742,12 @@ static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(framebuffer_png_info_obj,
 static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(framebuffer_draw_png_obj,              3, 4, framebuffer_draw_png);
 /* Draw a PNG image. Arguments: x, y, buffer with PNG data or filename of PNG image */
 
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(framebuffer_png_cache_stats_obj,       0, 0, framebuffer_png_cache_stats);
+/* Get the usage of the decoded PNG image cache as (hits, misses, images, bytes used, bytes available) */
+
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(framebuffer_png_cache_clear_obj,       0, 0, framebuffer_png_cache_clear);
+/* Remove all images from the decoded PNG image cache */
+
 static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(framebuffer_backlight_obj,             0, 1, framebuffer_backlight);
 /* Set or get the backlight brightness level. Arguments: level (0-255) (optional) */
 
@@ -735,6 +771,8 @@ static const mp_rom_map_elem_t framebuffer_module_globals_table[] = {
 	{MP_ROM_QSTR( MP_QSTR_height                        ), MP_ROM_PTR( &framebuffer_height_obj               )}, //Get the height of the framebuffer or a window
 	{MP_ROM_QSTR( MP_QSTR_orientation                   ), MP_ROM_PTR( &framebuffer_orientation_obj          )}, //Get or set the orientation
 	{MP_ROM_QSTR( MP_QSTR_pngInfo                       ), MP_ROM_PTR( &framebuffer_png_info_obj             )}, //Get information about a PNG image
+	{MP_ROM_QSTR( MP_QSTR_pngCacheStats                 ), MP_ROM_PTR( &framebuffer_png_cache_stats_obj      )}, //Get the usage of the decoded PNG image cache
+	{MP_ROM_QSTR( MP_QSTR_pngCacheClear                 ), MP_ROM_PTR( &framebuffer_png_cache_clear_obj      )}, //Empty the decoded PNG image cache
 	{MP_ROM_QSTR( MP_QSTR_getTextWidth                  ), MP_ROM_PTR( &framebuffer_get_text_width_obj       )}, //Get the width a string would take
 	{MP_ROM_QSTR( MP_QSTR_getTextHeight                 ), MP_ROM_PTR( &framebuffer_get_text_height_obj      )}, //Get the height a string would take
 	{MP_ROM_QSTR( MP_QSTR_backlight                     ), MP_ROM_PTR( &framebuffer_backlight_obj            )}, //Get or set the backlight brightness level
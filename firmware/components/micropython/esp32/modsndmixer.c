@@ -32,33 +32,42 @@ static mp_obj_t modsndmixer_begin(mp_uint_t n_args, const mp_obj_t *args) {
   return mp_obj_new_int(sndmixer_channels);
 }
 
-static mp_obj_t modsndmixer_play(mp_obj_t _id) {
+static mp_obj_t modsndmixer_play(mp_uint_t n_args, const mp_obj_t *args) {
   if (!sndmixer_started) {
     mp_raise_ValueError(msg_error_not_started);
     return mp_const_none;
   }
-  int id = mp_obj_get_int(_id);
-  sndmixer_play(id);
+  int id = mp_obj_get_int(args[0]);
+  if (n_args > 1)
+    sndmixer_play_at(id, mp_obj_get_int_truncated(args[1]));
+  else
+    sndmixer_play(id);
   return mp_const_none;
 }
 
-static mp_obj_t modsndmixer_pause(mp_obj_t _id) {
+static mp_obj_t modsndmixer_pause(mp_uint_t n_args, const mp_obj_t *args) {
   if (!sndmixer_started) {
     mp_raise_ValueError(msg_error_not_started);
     return mp_const_none;
   }
-  int id = mp_obj_get_int(_id);
-  sndmixer_pause(id);
+  int id = mp_obj_get_int(args[0]);
+  if (n_args > 1)
+    sndmixer_pause_at(id, mp_obj_get_int_truncated(args[1]));
+  else
+    sndmixer_pause(id);
   return mp_const_none;
 }
 
-static mp_obj_t modsndmixer_stop(mp_obj_t _id) {
+static mp_obj_t modsndmixer_stop(mp_uint_t n_args, const mp_obj_t *args) {
   if (!sndmixer_started) {
     mp_raise_ValueError(msg_error_not_started);
     return mp_const_none;
   }
-  int id = mp_obj_get_int(_id);
-  sndmixer_stop(id);
+  int id = mp_obj_get_int(args[0]);
+  if (n_args > 1)
+    sndmixer_stop_at(id, mp_obj_get_int_truncated(args[1]));
+  else
+    sndmixer_stop(id);
   return mp_const_none;
 }
 
@@ -91,14 +100,17 @@ static mp_obj_t modsndmixer_loop(mp_obj_t _id, mp_obj_t _loop) {
   return mp_const_none;
 }
 
-static mp_obj_t modsndmixer_volume(mp_obj_t _id, mp_obj_t _volume) {
+static mp_obj_t modsndmixer_volume(mp_uint_t n_args, const mp_obj_t *args) {
   if (!sndmixer_started) {
     mp_raise_ValueError(msg_error_not_started);
     return mp_const_none;
   }
-  int id     = mp_obj_get_int(_id);
-  int volume = mp_obj_get_int(_volume);
-  sndmixer_set_volume(id, volume);
+  int id     = mp_obj_get_int(args[0]);
+  int volume = mp_obj_get_int(args[1]);
+  if (n_args > 2)
+    sndmixer_set_volume_at(id, volume, mp_obj_get_int_truncated(args[2]));
+  else
+    sndmixer_set_volume(id, volume);
   return mp_const_none;
 }
 
@@ -121,6 +133,16 @@ static mp_obj_t modsndmixer_wav(mp_obj_t _data) {
   return mp_obj_new_int(id);
 }
 
+static mp_obj_t modsndmixer_wav_stream(mp_obj_t _stream) {
+  if (!sndmixer_started) {
+    mp_raise_ValueError(msg_error_not_started);
+    return mp_const_none;
+  }
+  int id = sndmixer_queue_wav_stream(mp_stream_posix_read, (void *)_stream, 1);
+  sndmixer_play(id);
+  return mp_obj_new_int(id);
+}
+
 static mp_obj_t modsndmixer_mod(mp_obj_t _data) {
   if (!sndmixer_started) {
     mp_raise_ValueError(msg_error_not_started);
@@ -197,22 +219,182 @@ static mp_obj_t modsndmixer_waveform(mp_obj_t _id, mp_obj_t _waveform) {
   return mp_const_none;
 }
 
+static mp_obj_t modsndmixer_poly() {
+  if (!sndmixer_started) {
+    mp_raise_ValueError(msg_error_not_started);
+    return mp_const_none;
+  }
+  int id = sndmixer_queue_poly();
+  sndmixer_play(id);
+  return mp_obj_new_int(id);
+}
+
+static mp_obj_t modsndmixer_note_on(mp_uint_t n_args, const mp_obj_t *args) {
+  if (!sndmixer_started) {
+    mp_raise_ValueError(msg_error_not_started);
+    return mp_const_none;
+  }
+  int id       = mp_obj_get_int(args[0]);
+  int note     = mp_obj_get_int(args[1]);
+  int velocity = (n_args > 2) ? mp_obj_get_int(args[2]) : 127;
+  if (note < 0 || note > 127 || velocity < 0 || velocity > 127) {
+    mp_raise_ValueError("note and velocity must be 0-127");
+    return mp_const_none;
+  }
+  sndmixer_note_on(id, note, velocity);
+  return mp_const_none;
+}
+
+static mp_obj_t modsndmixer_note_off(mp_obj_t _id, mp_obj_t _note) {
+  if (!sndmixer_started) {
+    mp_raise_ValueError(msg_error_not_started);
+    return mp_const_none;
+  }
+  int id   = mp_obj_get_int(_id);
+  int note = mp_obj_get_int(_note);
+  sndmixer_note_off(id, note);
+  return mp_const_none;
+}
+
+static mp_obj_t modsndmixer_envelope(mp_uint_t n_args, const mp_obj_t *args) {
+  if (!sndmixer_started) {
+    mp_raise_ValueError(msg_error_not_started);
+    return mp_const_none;
+  }
+  int id      = mp_obj_get_int(args[0]);
+  int attack  = mp_obj_get_int(args[1]);
+  int decay   = mp_obj_get_int(args[2]);
+  int sustain = mp_obj_get_int(args[3]);
+  int release = mp_obj_get_int(args[4]);
+  sndmixer_set_envelope(id, attack, decay, sustain, release);
+  return mp_const_none;
+}
+
+static mp_obj_t modsndmixer_resampler(mp_obj_t _id, mp_obj_t _resampler) {
+  if (!sndmixer_started) {
+    mp_raise_ValueError(msg_error_not_started);
+    return mp_const_none;
+  }
+  int id        = mp_obj_get_int(_id);
+  int resampler = mp_obj_get_int(_resampler);
+  if (resampler < SNDMIXER_RESAMPLE_NEAREST || resampler > SNDMIXER_RESAMPLE_SINC) {
+    mp_raise_ValueError("invalid resampler");
+    return mp_const_none;
+  }
+  sndmixer_set_resampler(id, resampler);
+  return mp_const_none;
+}
+
+static mp_obj_t modsndmixer_pan(mp_obj_t _id, mp_obj_t _pan) {
+  if (!sndmixer_started) {
+    mp_raise_ValueError(msg_error_not_started);
+    return mp_const_none;
+  }
+  int id  = mp_obj_get_int(_id);
+  int pan = mp_obj_get_int(_pan);
+  sndmixer_set_pan(id, pan);
+  return mp_const_none;
+}
+
+static mp_obj_t modsndmixer_eq(mp_uint_t n_args, const mp_obj_t *args) {
+  if (!sndmixer_started) {
+    mp_raise_ValueError(msg_error_not_started);
+    return mp_const_none;
+  }
+  int type        = mp_obj_get_int(args[0]);
+  float frequency = (n_args > 1) ? mp_obj_get_float(args[1]) : 0;
+  float q         = (n_args > 2) ? mp_obj_get_float(args[2]) : 0.707;
+  float gain_db   = (n_args > 3) ? mp_obj_get_float(args[3]) : 0;
+  if (type < SNDMIXER_EQ_OFF || type > SNDMIXER_EQ_HIGHSHELF) {
+    mp_raise_ValueError("invalid filter type");
+    return mp_const_none;
+  }
+  sndmixer_set_eq(type, frequency, q, gain_db);
+  return mp_const_none;
+}
+
+static mp_obj_t modsndmixer_underruns() {
+  if (!sndmixer_started) {
+    mp_raise_ValueError(msg_error_not_started);
+    return mp_const_none;
+  }
+  return mp_obj_new_int_from_uint(sndmixer_get_underruns());
+}
+
+// Processing time per kind of sound and of the whole mixer, as a dict of (frames, microseconds)
+static mp_obj_t modsndmixer_stats() {
+  if (!sndmixer_started) {
+    mp_raise_ValueError(msg_error_not_started);
+    return mp_const_none;
+  }
+  static const qstr names[SNDMIXER_STATS_COUNT] = {MP_QSTR_wav,   MP_QSTR_mod,  MP_QSTR_mp3,
+                                                   MP_QSTR_synth, MP_QSTR_poly, MP_QSTR_mixer};
+  sndmixer_stats_t stats[SNDMIXER_STATS_COUNT];
+  sndmixer_get_stats(stats);
+  mp_obj_t dict = mp_obj_new_dict(SNDMIXER_STATS_COUNT);
+  for (int i = 0; i < SNDMIXER_STATS_COUNT; i++) {
+    mp_obj_t entry[2] = {mp_obj_new_int_from_uint(stats[i].frames),
+                         mp_obj_new_int_from_uint(stats[i].time_us)};
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(names[i]), mp_obj_new_tuple(2, entry));
+  }
+  return dict;
+}
+
+static mp_obj_t modsndmixer_reset_stats() {
+  if (!sndmixer_started) {
+    mp_raise_ValueError(msg_error_not_started);
+    return mp_const_none;
+  }
+  sndmixer_reset_stats();
+  return mp_const_none;
+}
+
+// Sample clock, for use as the time argument of play, pause, stop and volume
+static mp_obj_t modsndmixer_clock() {
+  if (!sndmixer_started) {
+    mp_raise_ValueError(msg_error_not_started);
+    return mp_const_none;
+  }
+  return mp_obj_new_int_from_uint(sndmixer_get_clock());
+}
+
+static mp_obj_t modsndmixer_samplerate() {
+  if (!sndmixer_started) {
+    mp_raise_ValueError(msg_error_not_started);
+    return mp_const_none;
+  }
+  return mp_obj_new_int(sndmixer_get_samplerate());
+}
+
 /* --- */
 static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(modsndmixer_begin_obj, 0, 2, modsndmixer_begin);
-static MP_DEFINE_CONST_FUN_OBJ_1(modsndmixer_play_obj, modsndmixer_play);
-static MP_DEFINE_CONST_FUN_OBJ_1(modsndmixer_pause_obj, modsndmixer_pause);
-static MP_DEFINE_CONST_FUN_OBJ_1(modsndmixer_stop_obj, modsndmixer_stop);
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(modsndmixer_play_obj, 1, 2, modsndmixer_play);
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(modsndmixer_pause_obj, 1, 2, modsndmixer_pause);
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(modsndmixer_stop_obj, 1, 2, modsndmixer_stop);
 static MP_DEFINE_CONST_FUN_OBJ_0(modsndmixer_pause_all_obj, modsndmixer_pause_all);
 static MP_DEFINE_CONST_FUN_OBJ_0(modsndmixer_resume_all_obj, modsndmixer_resume_all);
 static MP_DEFINE_CONST_FUN_OBJ_2(modsndmixer_loop_obj, modsndmixer_loop);
-static MP_DEFINE_CONST_FUN_OBJ_2(modsndmixer_volume_obj, modsndmixer_volume);
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(modsndmixer_volume_obj, 2, 3, modsndmixer_volume);
 static MP_DEFINE_CONST_FUN_OBJ_1(modsndmixer_wav_obj, modsndmixer_wav);
+static MP_DEFINE_CONST_FUN_OBJ_1(modsndmixer_wav_stream_obj, modsndmixer_wav_stream);
 static MP_DEFINE_CONST_FUN_OBJ_1(modsndmixer_mod_obj, modsndmixer_mod);
 static MP_DEFINE_CONST_FUN_OBJ_1(modsndmixer_mp3_obj, modsndmixer_mp3);
 static MP_DEFINE_CONST_FUN_OBJ_1(modsndmixer_mp3_stream_obj, modsndmixer_mp3_stream);
 static MP_DEFINE_CONST_FUN_OBJ_0(modsndmixer_synth_obj, modsndmixer_synth);
 static MP_DEFINE_CONST_FUN_OBJ_2(modsndmixer_freq_obj, modsndmixer_freq);
 static MP_DEFINE_CONST_FUN_OBJ_2(modsndmixer_waveform_obj, modsndmixer_waveform);
+static MP_DEFINE_CONST_FUN_OBJ_0(modsndmixer_poly_obj, modsndmixer_poly);
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(modsndmixer_note_on_obj, 2, 3, modsndmixer_note_on);
+static MP_DEFINE_CONST_FUN_OBJ_2(modsndmixer_note_off_obj, modsndmixer_note_off);
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(modsndmixer_envelope_obj, 5, 5, modsndmixer_envelope);
+static MP_DEFINE_CONST_FUN_OBJ_2(modsndmixer_resampler_obj, modsndmixer_resampler);
+static MP_DEFINE_CONST_FUN_OBJ_0(modsndmixer_underruns_obj, modsndmixer_underruns);
+static MP_DEFINE_CONST_FUN_OBJ_2(modsndmixer_pan_obj, modsndmixer_pan);
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(modsndmixer_eq_obj, 1, 4, modsndmixer_eq);
+static MP_DEFINE_CONST_FUN_OBJ_0(modsndmixer_stats_obj, modsndmixer_stats);
+static MP_DEFINE_CONST_FUN_OBJ_0(modsndmixer_reset_stats_obj, modsndmixer_reset_stats);
+static MP_DEFINE_CONST_FUN_OBJ_0(modsndmixer_clock_obj, modsndmixer_clock);
+static MP_DEFINE_CONST_FUN_OBJ_0(modsndmixer_samplerate_obj, modsndmixer_samplerate);
 
 static const mp_rom_map_elem_t sndmixer_module_globals_table[] = {
     {MP_ROM_QSTR(MP_QSTR_begin), MP_ROM_PTR(&modsndmixer_begin_obj)},
@@ -224,12 +406,34 @@ static const mp_rom_map_elem_t sndmixer_module_globals_table[] = {
     {MP_ROM_QSTR(MP_QSTR_loop), MP_ROM_PTR(&modsndmixer_loop_obj)},
     {MP_ROM_QSTR(MP_QSTR_volume), MP_ROM_PTR(&modsndmixer_volume_obj)},
     {MP_ROM_QSTR(MP_QSTR_wav), MP_ROM_PTR(&modsndmixer_wav_obj)},
+    {MP_ROM_QSTR(MP_QSTR_wav_stream), MP_ROM_PTR(&modsndmixer_wav_stream_obj)},
     {MP_ROM_QSTR(MP_QSTR_mod), MP_ROM_PTR(&modsndmixer_mod_obj)},
     {MP_ROM_QSTR(MP_QSTR_mp3), MP_ROM_PTR(&modsndmixer_mp3_obj)},
     {MP_ROM_QSTR(MP_QSTR_mp3_stream), MP_ROM_PTR(&modsndmixer_mp3_stream_obj)},
     {MP_ROM_QSTR(MP_QSTR_synth), MP_ROM_PTR(&modsndmixer_synth_obj)},
     {MP_ROM_QSTR(MP_QSTR_freq), MP_ROM_PTR(&modsndmixer_freq_obj)},
     {MP_ROM_QSTR(MP_QSTR_waveform), MP_ROM_PTR(&modsndmixer_waveform_obj)},
+    {MP_ROM_QSTR(MP_QSTR_poly), MP_ROM_PTR(&modsndmixer_poly_obj)},
+    {MP_ROM_QSTR(MP_QSTR_note_on), MP_ROM_PTR(&modsndmixer_note_on_obj)},
+    {MP_ROM_QSTR(MP_QSTR_note_off), MP_ROM_PTR(&modsndmixer_note_off_obj)},
+    {MP_ROM_QSTR(MP_QSTR_envelope), MP_ROM_PTR(&modsndmixer_envelope_obj)},
+    {MP_ROM_QSTR(MP_QSTR_resampler), MP_ROM_PTR(&modsndmixer_resampler_obj)},
+    {MP_ROM_QSTR(MP_QSTR_underruns), MP_ROM_PTR(&modsndmixer_underruns_obj)},
+    {MP_ROM_QSTR(MP_QSTR_pan), MP_ROM_PTR(&modsndmixer_pan_obj)},
+    {MP_ROM_QSTR(MP_QSTR_eq), MP_ROM_PTR(&modsndmixer_eq_obj)},
+    {MP_ROM_QSTR(MP_QSTR_stats), MP_ROM_PTR(&modsndmixer_stats_obj)},
+    {MP_ROM_QSTR(MP_QSTR_reset_stats), MP_ROM_PTR(&modsndmixer_reset_stats_obj)},
+    {MP_ROM_QSTR(MP_QSTR_clock), MP_ROM_PTR(&modsndmixer_clock_obj)},
+    {MP_ROM_QSTR(MP_QSTR_samplerate), MP_ROM_PTR(&modsndmixer_samplerate_obj)},
+    {MP_ROM_QSTR(MP_QSTR_EQ_OFF), MP_ROM_INT(SNDMIXER_EQ_OFF)},
+    {MP_ROM_QSTR(MP_QSTR_EQ_LOWPASS), MP_ROM_INT(SNDMIXER_EQ_LOWPASS)},
+    {MP_ROM_QSTR(MP_QSTR_EQ_HIGHPASS), MP_ROM_INT(SNDMIXER_EQ_HIGHPASS)},
+    {MP_ROM_QSTR(MP_QSTR_EQ_PEAK), MP_ROM_INT(SNDMIXER_EQ_PEAK)},
+    {MP_ROM_QSTR(MP_QSTR_EQ_LOWSHELF), MP_ROM_INT(SNDMIXER_EQ_LOWSHELF)},
+    {MP_ROM_QSTR(MP_QSTR_EQ_HIGHSHELF), MP_ROM_INT(SNDMIXER_EQ_HIGHSHELF)},
+    {MP_ROM_QSTR(MP_QSTR_RESAMPLE_NEAREST), MP_ROM_INT(SNDMIXER_RESAMPLE_NEAREST)},
+    {MP_ROM_QSTR(MP_QSTR_RESAMPLE_LINEAR), MP_ROM_INT(SNDMIXER_RESAMPLE_LINEAR)},
+    {MP_ROM_QSTR(MP_QSTR_RESAMPLE_SINC), MP_ROM_INT(SNDMIXER_RESAMPLE_SINC)},
 };
 
 static MP_DEFINE_CONST_DICT(sndmixer_module_globals, sndmixer_module_globals_table);
@@ -56,7 +56,7 @@ esp_err_t unpack_first_boot_zip()
 	
 	printf("Partition OTA1 is at 0x%08X\n", part_ota1->address);
 	
-	struct lib_deflate_reader *dr = (struct lib_deflate_reader *) malloc(sizeof(struct lib_deflate_reader));
+	struct lib_deflate_reader *dr = lib_deflate_new(NULL, NULL);
 	if (dr == NULL) {
 		ESP_LOGE(TAG, "failed to init deflate object");
 		return ESP_ERR_NO_MEM;
@@ -211,7 +211,7 @@ esp_err_t unpack_first_boot_zip()
 		}
 		first_chunk = false;
 	}
-	free(dr);
+	lib_deflate_destroy(dr);
 
 	// clear first page to avoid double unpacking
 	int res = spi_flash_erase_sector((part_ota1->address + 4096) / SPI_FLASH_SEC_SIZE);